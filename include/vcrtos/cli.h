@@ -27,14 +27,23 @@
 extern "C" {
 #endif
 
+#define CLI_COMMAND_FLAG_ASYNC (0x1)
+
 typedef struct cli_command
 {
     const char *name;
     void (*command_handler_func)(int argc, char *argv[]);
+    uint8_t flags;
 } cli_command_t;
 
 void vccli_uart_init();
-void vccli_set_user_commands(const cli_command_t *user_commands, uint8_t length);
+/* replaces the table of the previous call, tables added with
+ * vccli_add_commands() are kept */
+void vccli_set_user_commands(const cli_command_t *user_commands, uint16_t length);
+
+/* returns the number of commands added, names already registered are
+ * skipped, -1 when VCRTOS_CONFIG_CLI_MAX_COMMANDS is reached */
+int vccli_add_commands(const cli_command_t *commands, uint16_t length);
 void vccli_output_bytes(const uint8_t *bytes, uint8_t length);
 void vccli_output_format(const char *fmt, ...);
 void vccli_output(const char *string, uint16_t length);
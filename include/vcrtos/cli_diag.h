@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_CLI_DIAG_H
+#define VCRTOS_CLI_DIAG_H
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/cli.h>
+#include <vcrtos/mutex.h>
+
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+#include <vcrtos/event.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Registers the kernel diagnostics commands: ps, top, heap, mutex, evq and,
+ * when built in, trace and irqprof.
+ */
+int vccli_add_diag_commands();
+
+/* objects shown by the mutex and evq commands, @p name must stay valid */
+int vccli_diag_register_mutex(const char *name, mutex_t *mutex);
+
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+int vccli_diag_register_event_queue(const char *name, event_queue_t *queue);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_CLI_DIAG_H */
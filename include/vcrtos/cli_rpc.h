@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_CLI_RPC_H
+#define VCRTOS_CLI_RPC_H
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/cli.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Frame layout on the wire, multi-byte fields are little endian:
+ *
+ *   | sync (0xa5) | length (2) | payload (length) | crc16 (2) |
+ *
+ * crc16 is CRC-16/CCITT-FALSE computed over the length field and the payload.
+ *
+ * Request payload:  | CLI_RPC_FRAME_REQUEST | seq | command id (2) | args... |
+ * Text payload:     | CLI_RPC_FRAME_TEXT | seq | command line... |
+ * Response payload: | CLI_RPC_FRAME_RESPONSE | seq | status | data... |
+ * Log payload:      | CLI_RPC_FRAME_LOG | seq | text... |
+ *
+ * Each request argument is encoded as | type | length (2) | value (length) |.
+ */
+
+#define CLI_RPC_FRAME_SYNC 0xa5
+
+#define CLI_RPC_FRAME_REQUEST 0x01
+#define CLI_RPC_FRAME_TEXT 0x02
+#define CLI_RPC_FRAME_RESPONSE 0x81
+#define CLI_RPC_FRAME_LOG 0x82
+
+#define CLI_RPC_ARG_UINT 0x01
+#define CLI_RPC_ARG_INT 0x02
+#define CLI_RPC_ARG_BYTES 0x03
+#define CLI_RPC_ARG_STRING 0x04
+
+#define CLI_RPC_STATUS_OK 0
+#define CLI_RPC_STATUS_UNKNOWN_COMMAND 1
+#define CLI_RPC_STATUS_INVALID_ARGS 2
+#define CLI_RPC_STATUS_NO_BUFFER 3
+#define CLI_RPC_STATUS_FAILED 4
+
+typedef struct cli_rpc_arg
+{
+    uint8_t type;
+    uint16_t length;
+    union
+    {
+        uint32_t u32;
+        int32_t i32;
+        const uint8_t *bytes;
+        const char *string; /* null terminated */
+    } value;
+} cli_rpc_arg_t;
+
+/**
+ * Handler writes its result into @p response and returns the number of bytes
+ * written, or a negated CLI_RPC_STATUS_* code on failure.
+ */
+typedef int (*cli_rpc_handler_func_t)(const cli_rpc_arg_t *args, uint8_t argc, uint8_t *response, uint16_t size);
+
+typedef struct cli_rpc_command
+{
+    uint16_t id;
+    cli_rpc_handler_func_t handler;
+} cli_rpc_command_t;
+
+void vccli_rpc_init();
+
+/* @p commands must be sorted by id and stay valid while the server runs */
+void vccli_rpc_set_commands(const cli_rpc_command_t *commands, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_CLI_RPC_H */
@@ -26,7 +26,7 @@
 extern "C" {
 #endif
 
-/* This marker is used to identify the stacks beginning */
+/* Unused thread stack is painted with this pattern */
 #define STACK_MARKER (0x77777777)
 
 /* Initial program status register value for a newly created thread */
@@ -54,8 +54,72 @@ void cpu_jump_to_image(uint32_t image_addr);
 uint32_t cpu_get_image_base_addr();
 void *cpu_get_msp();
 
+/* free running counter used for thread runtime accounting, EDF deadlines,
+ * CPU budgets and message timeouts, only called when
+ * VCRTOS_CONFIG_THREAD_RUNTIME_STATS_ENABLE, VCRTOS_CONFIG_EDF_ENABLE,
+ * VCRTOS_CONFIG_CPU_BUDGET_ENABLE or VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE is set */
+uint32_t cpu_get_timestamp();
+
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+/* one shot timer of the executing core, starting it again re-arms it. When
+ * it fires the port calls thread_scheduler_time_slice_expired() and
+ * cpu_end_of_isr() from the isr */
+void cpu_time_slice_start(uint32_t ticks);
+void cpu_time_slice_stop();
+#endif
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+/* second one shot timer of the executing core, in cpu_get_timestamp() ticks.
+ * When it fires the port calls thread_scheduler_budget_expired() and
+ * cpu_end_of_isr() from the isr */
+void cpu_budget_timer_start(uint32_t ticks);
+void cpu_budget_timer_stop();
+#endif
+
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+/* one shot timer in cpu_get_timestamp() ticks, starting it again re-arms
+ * it. When it fires the port calls thread_scheduler_msg_timeout_expired()
+ * and cpu_end_of_isr() from the isr */
+void cpu_msg_timer_start(uint32_t ticks);
+void cpu_msg_timer_stop();
+#endif
+
+#if VCRTOS_CONFIG_STACK_CHECK_ENABLE
+/* called from the scheduler with interrupts disabled when the canary at the
+ * bottom of the stack of @p thread (a thread_t) was overwritten */
+void cpu_stack_overflow(void *thread);
+#endif
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+/* index of the executing core, 0 .. VCRTOS_CONFIG_SMP_NUMOF_CORES - 1 */
+unsigned cpu_core_id();
+
+/* interrupt another core, its handler only requests a context switch like
+ * cpu_end_of_isr() does */
+void cpu_send_ipi(unsigned core);
+
+/* kernel lock: masks local interrupts and takes the kernel spinlock, nested
+ * calls on the same core only count */
+unsigned smp_irq_disable();
+void smp_irq_restore(unsigned state);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
 
+#if VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
+#include <vcrtos/irq_profile.h>
+
+/* Every critical section is timed and keyed by its call site. Ports define
+ * and call the real functions with the name in parentheses, e.g.
+ * unsigned (cpu_irq_disable)(void), which is not expanded by these macros. */
+#define cpu_irq_disable() irq_profile_disable(__FILE__, __LINE__)
+#define cpu_irq_restore(state) irq_profile_restore(state)
+#elif VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+/* interrupt masking alone does not exclude the other cores */
+#define cpu_irq_disable() smp_irq_disable()
+#define cpu_irq_restore(state) smp_irq_restore(state)
+#endif
+
 #endif /* VCRTOS_CPU_H */
@@ -26,10 +26,125 @@
 #define VCRTOS_CONFIG_PACKAGE_VERSION "0.0.1"
 #endif
 
+/* thread_spawn() takes its stacks from three preallocated size classes */
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+#define VCRTOS_CONFIG_THREAD_SPAWN_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE
+#define VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE 512
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF
+#define VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF 4
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_STACKSIZE
+#define VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_STACKSIZE 1024
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF
+#define VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF 2
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_LARGE_STACKSIZE
+#define VCRTOS_CONFIG_THREAD_SPAWN_LARGE_STACKSIZE 2048
+#endif
+
+#ifndef VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF
+#define VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF 1
+#endif
+
+/* the scheduler checks the stack canary of both threads on every context
+ * switch and calls cpu_stack_overflow() when one was overwritten */
+#ifndef VCRTOS_CONFIG_STACK_CHECK_ENABLE
+#define VCRTOS_CONFIG_STACK_CHECK_ENABLE 0
+#endif
+
+/* per thread peak stack usage, recorded by thread_stack_monitor_sample() */
+#ifndef VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+#define VCRTOS_CONFIG_STACK_MONITOR_ENABLE 0
+#endif
+
+/* number of thread slots, up to 32766 */
+#ifndef VCRTOS_CONFIG_MAXTHREADS
+#define VCRTOS_CONFIG_MAXTHREADS 32
+#endif
+
+/* up to 256, more than 32 levels use a two level ready bitmap */
 #ifndef VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS
 #define VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS 16
 #endif
 
+#ifndef VCRTOS_CONFIG_SMP_NUMOF_CORES
+#define VCRTOS_CONFIG_SMP_NUMOF_CORES 1
+#endif
+
+/* round robin between threads of the same priority, needs the one shot
+ * cpu_time_slice_start() / cpu_time_slice_stop() timer of the port */
+#ifndef VCRTOS_CONFIG_TIME_SLICE_ENABLE
+#define VCRTOS_CONFIG_TIME_SLICE_ENABLE 0
+#endif
+
+/* quantum of every priority level in timer ticks, changed per level with
+ * thread_scheduler_set_time_slice(), 0 disables slicing for a level */
+#ifndef VCRTOS_CONFIG_TIME_SLICE_TICKS
+#define VCRTOS_CONFIG_TIME_SLICE_TICKS 1000
+#endif
+
+/* earliest deadline first scheduling for the threads of one priority level,
+ * the other levels stay fixed priority. Deadlines are cpu_get_timestamp()
+ * ticks. */
+#ifndef VCRTOS_CONFIG_EDF_ENABLE
+#define VCRTOS_CONFIG_EDF_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_EDF_PRIORITY
+#define VCRTOS_CONFIG_EDF_PRIORITY 1
+#endif
+
+/* CPU budget groups: the threads of a group share a budget of
+ * cpu_get_timestamp() ticks per replenishment period, once it is used up
+ * they drop to the background priority of the group until the next period */
+#ifndef VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+#define VCRTOS_CONFIG_CPU_BUDGET_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS
+#define VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS 2
+#endif
+
+/* a thread blocked in msg_send_receive() or queued in msg_send() lends its
+ * priority to the receiving thread until it is received or replied to */
+#ifndef VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+#define VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE 0
+#endif
+
+/* timeouts other than 0 and MSG_TIMEOUT_FOREVER for msg_receive_type(),
+ * they run on the cpu_msg_timer_start() / cpu_msg_timer_stop() timer of the
+ * port */
+#ifndef VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+#define VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE 0
+#endif
+
+/* pool of reference counted message payloads passed by pointer, see
+ * msgbuf_alloc() */
+#ifndef VCRTOS_CONFIG_MSGBUF_ENABLE
+#define VCRTOS_CONFIG_MSGBUF_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_MSGBUF_SIZE
+#define VCRTOS_CONFIG_MSGBUF_SIZE 1024
+#endif
+
+#ifndef VCRTOS_CONFIG_MSGBUF_NUMOF
+#define VCRTOS_CONFIG_MSGBUF_NUMOF 4
+#endif
+
+#ifndef VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+#define VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE 0
+#endif
+
 #ifndef VCRTOS_CONFIG_THREAD_FLAGS_ENABLE
 #define VCRTOS_CONFIG_THREAD_FLAGS_ENABLE 0
 #endif
@@ -38,10 +153,42 @@
 #define VCRTOS_CONFIG_THREAD_EVENT_ENABLE 0
 #endif
 
+#ifndef VCRTOS_CONFIG_THREAD_RUNTIME_STATS_ENABLE
+#define VCRTOS_CONFIG_THREAD_RUNTIME_STATS_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_TRACE_ENABLE
+#define VCRTOS_CONFIG_TRACE_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_TRACE_BUFFER_SIZE
+#define VCRTOS_CONFIG_TRACE_BUFFER_SIZE 256
+#endif
+
+#ifndef VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
+#define VCRTOS_CONFIG_IRQ_PROFILE_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_IRQ_PROFILE_SITES
+#define VCRTOS_CONFIG_IRQ_PROFILE_SITES 32
+#endif
+
+#ifndef VCRTOS_CONFIG_IRQ_PROFILE_HISTOGRAM_SIZE
+#define VCRTOS_CONFIG_IRQ_PROFILE_HISTOGRAM_SIZE 12
+#endif
+
 #ifndef VCRTOS_CONFIG_UTILS_UART_TSRB_ISRPIPE_SIZE
 #define VCRTOS_CONFIG_UTILS_UART_TSRB_ISRPIPE_SIZE 128
 #endif
 
+#ifndef VCRTOS_CONFIG_VCSTDIO_HOST
+#define VCRTOS_CONFIG_VCSTDIO_HOST 0
+#endif
+
+#ifndef VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE
+#define VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE 256
+#endif
+
 #ifndef VCRTOS_CONFIG_CLI_UART_RX_BUFFER_SIZE
 #define VCRTOS_CONFIG_CLI_UART_RX_BUFFER_SIZE 128
 #endif
@@ -50,10 +197,19 @@
 #define VCRTOS_CONFIG_CLI_UART_TX_BUFFER_SIZE 128
 #endif
 
+#ifndef VCRTOS_CONFIG_CLI_UART_READ_CHUNK_SIZE
+#define VCRTOS_CONFIG_CLI_UART_READ_CHUNK_SIZE 32
+#endif
+
 #ifndef VCRTOS_CONFIG_CLI_MAX_LINE_LENGTH
 #define VCRTOS_CONFIG_CLI_MAX_LINE_LENGTH 128
 #endif
 
+/* commands of all tables together, the single user table used to hold 255 */
+#ifndef VCRTOS_CONFIG_CLI_MAX_COMMANDS
+#define VCRTOS_CONFIG_CLI_MAX_COMMANDS 256
+#endif
+
 #ifndef VCRTOS_CONFIG_CLI_UART_THREAD_STACK_SIZE
 #define VCRTOS_CONFIG_CLI_UART_THREAD_STACK_SIZE 1024
 #endif
@@ -62,6 +218,42 @@
 #define VCRTOS_CONFIG_CLI_UART_THREAD_PRIORITY KERNEL_THREAD_PRIORITY_MAIN
 #endif
 
+#ifndef VCRTOS_CONFIG_CLI_DIAG_MAX_OBJECTS
+#define VCRTOS_CONFIG_CLI_DIAG_MAX_OBJECTS 8
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+#define VCRTOS_CONFIG_CLI_ASYNC_ENABLE 0
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_ASYNC_WORKERS
+#define VCRTOS_CONFIG_CLI_ASYNC_WORKERS 2
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_ASYNC_THREAD_STACK_SIZE
+#define VCRTOS_CONFIG_CLI_ASYNC_THREAD_STACK_SIZE 1024
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_ASYNC_THREAD_PRIORITY
+#define VCRTOS_CONFIG_CLI_ASYNC_THREAD_PRIORITY (KERNEL_THREAD_PRIORITY_MAIN + 1)
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE
+#define VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE 512
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_RPC_MAX_ARGS
+#define VCRTOS_CONFIG_CLI_RPC_MAX_ARGS 8
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_RPC_THREAD_STACK_SIZE
+#define VCRTOS_CONFIG_CLI_RPC_THREAD_STACK_SIZE 1024
+#endif
+
+#ifndef VCRTOS_CONFIG_CLI_RPC_THREAD_PRIORITY
+#define VCRTOS_CONFIG_CLI_RPC_THREAD_PRIORITY KERNEL_THREAD_PRIORITY_MAIN
+#endif
+
 #ifndef VCRTOS_CONFIG_THREAD_EVENT_STACK_SIZE_DEFAULT
 #define VCRTOS_CONFIG_THREAD_EVENT_STACK_SIZE_DEFAULT 1024
 #endif
@@ -27,6 +27,7 @@ extern "C" {
 #endif
 
 void *heap_init();
+int heap_is_initialized();
 size_t heap_get_free_size();
 size_t heap_get_capacity();
 bool heap_is_clean();
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_INSTANCE_H
+#define VCRTOS_INSTANCE_H
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+
+/**
+ * Kernel state of one vcrtos instance.
+ *
+ * With VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE the scheduler and the
+ * sched_active_* variables live in an instance instead of globals, and the
+ * kernel always works on the current instance of the calling host thread.
+ * A host thread may switch between instances, e.g. to step many simulated
+ * nodes, but an instance must only be used by one host thread at a time.
+ *
+ * Before any instance is selected, the calling host thread uses a default
+ * instance, so single instance code keeps working unchanged. This is a host
+ * feature, targets keep the globals their context switch code depends on.
+ */
+typedef struct kernel_instance
+{
+    void *active_thread;
+    int16_t active_pid;
+    int is_initialized;
+    void *scheduler; /* ThreadScheduler storage */
+} kernel_instance_t;
+
+kernel_instance_t *kernel_instance_create(void);
+
+void kernel_instance_destroy(kernel_instance_t *instance);
+
+/* select the instance the calling host thread works on, NULL selects the
+ * default instance */
+void kernel_instance_set_current(kernel_instance_t *instance);
+
+kernel_instance_t *kernel_instance_get_current(void);
+
+#endif // #if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_INSTANCE_H */
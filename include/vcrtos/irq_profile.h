@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_IRQ_PROFILE_H
+#define VCRTOS_IRQ_PROFILE_H
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct irq_profile_site
+{
+    const char *file;
+    uint32_t line;
+    uint32_t count;
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    /* bucket n counts sections of [2^n, 2^(n+1)) ticks, the last bucket
+     * takes everything longer */
+    uint32_t histogram[VCRTOS_CONFIG_IRQ_PROFILE_HISTOGRAM_SIZE];
+} irq_profile_site_t;
+
+/* used through the cpu_irq_disable() / cpu_irq_restore() redirection in
+ * vcrtos/cpu.h when VCRTOS_CONFIG_IRQ_PROFILE_ENABLE is set */
+unsigned irq_profile_disable(const char *file, uint32_t line);
+void irq_profile_restore(unsigned state);
+
+void irq_profile_reset();
+
+/* copies up to @p size recorded sites, longest worst case first */
+int irq_profile_get_worst(irq_profile_site_t *sites, int size);
+
+/* sections that were not recorded because the site table was full */
+uint32_t irq_profile_get_overflow();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_IRQ_PROFILE_H */
@@ -27,7 +27,11 @@
 extern "C" {
 #endif
 
-#define KERNEL_MAXTHREADS (32)
+#define KERNEL_MAXTHREADS VCRTOS_CONFIG_MAXTHREADS
+
+#if KERNEL_MAXTHREADS > 32766
+#error "pids are 16 bit signed and need room for KERNEL_PID_UNDEF"
+#endif
 
 #define KERNEL_PID_UNDEF (0)
 #define KERNEL_PID_FIRST (KERNEL_PID_UNDEF + 1)
@@ -36,6 +40,11 @@ extern "C" {
 #define KERNEL_PID_ISR (KERNEL_PID_LAST - 1)
 
 #define KERNEL_THREAD_PRIORITY_LEVELS VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS
+
+#if KERNEL_THREAD_PRIORITY_LEVELS > 256
+#error "thread priorities are stored in 8 bits"
+#endif
+
 #define KERNEL_THREAD_PRIORITY_MIN (KERNEL_THREAD_PRIORITY_LEVELS - 1)
 #define KERNEL_THREAD_PRIORITY_IDLE KERNEL_THREAD_PRIORITY_MIN
 #define KERNEL_THREAD_PRIORITY_MAIN (KERNEL_THREAD_PRIORITY_MIN - (KERNEL_THREAD_PRIORITY_LEVELS / 2))
@@ -18,6 +18,7 @@
 #ifndef VCRTOS_MSG_H
 #define VCRTOS_MSG_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <vcrtos/config.h>
@@ -47,7 +48,45 @@ int msg_try_send(msg_t *msg, kernel_pid_t pid);
 int msg_send_receive(msg_t *msg, msg_t *reply, kernel_pid_t pid);
 int msg_send_to_self_queue(msg_t *msg);
 int msg_reply(msg_t *msg, msg_t *reply);
+/* replies to msg->sender_pid and waits for the next message in msg */
+int msg_reply_and_receive(msg_t *msg, msg_t *reply);
 int msg_reply_in_isr(msg_t *msg, msg_t *reply);
+/* takes up to max messages in one critical section, queued ones first, then
+ * those of blocked senders. Returns the number taken, 0 when non-blocking and
+ * nothing is there, -1 without a message queue. When blocking on an empty
+ * queue the first message to arrive is returned alone. */
+int msg_receive_batch(msg_t *msgs, unsigned max, int blocking);
+
+#define MSG_TIMEOUT_FOREVER (UINT32_MAX)
+
+/* takes the oldest message whose type matches msg->type in the bits of
+ * type_mask, the others stay where they are. There is no index by type, the
+ * queue and then the blocked senders are scanned in order, so a call costs
+ * up to the queue length plus the number of waiting senders. The timeout is in
+ * cpu_get_timestamp() ticks, 0 does not block and MSG_TIMEOUT_FOREVER waits
+ * for good, other values need VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE. Returns 1,
+ * 0 when nothing matched in time, -1 without a message queue or for another
+ * timeout when VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE is off. */
+int msg_receive_type(msg_t *msg, uint16_t type_mask, uint32_t timeout);
+/* queues up to count messages at pid and wakes it once, works from an isr as
+ * well. Returns the number sent, the rest did not fit, or -1 */
+int msg_send_batch(msg_t *msgs, unsigned count, kernel_pid_t pid);
+
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+/* Buffers of VCRTOS_CONFIG_MSGBUF_SIZE bytes from a fixed pool, passed by
+ * pointer in msg->content.ptr. The last thread a buffer was sent to owns it
+ * and releases it when done, which also ends its ownership; if that thread
+ * exits first its reference is dropped and counted by msgbuf_get_leaks(). */
+void *msgbuf_alloc(size_t size);
+void msgbuf_retain(void *buf);
+void msgbuf_release(void *buf);
+/* msg_send() with ownership of buf moving to pid, it stays with the caller
+ * when the message is not delivered */
+int msgbuf_send(msg_t *msg, void *buf, kernel_pid_t pid);
+kernel_pid_t msgbuf_get_owner(void *buf);
+unsigned msgbuf_get_numof_free(void);
+unsigned msgbuf_get_leaks(void);
+#endif
 
 #ifdef __cplusplus
 }
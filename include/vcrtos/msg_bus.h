@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_MSG_BUS_H
+#define VCRTOS_MSG_BUS_H
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/kernel.h>
+#include <vcrtos/list.h>
+#include <vcrtos/msg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Threads attach to a bus with an entry and subscribe to event types, a
+ * post queues one message at every subscriber of its type without blocking.
+ * The message type holds the bus id in the upper bits and the event type in
+ * the lower five, content.ptr the argument of the post. */
+#define MSG_BUS_NUMOF_TYPES (32)
+#define MSG_BUS_ID_MAX (0x7ff)
+
+typedef struct msg_bus
+{
+    list_node_t subs;
+    uint16_t id;
+} msg_bus_t;
+
+typedef struct msg_bus_entry
+{
+    list_node_t next;
+    uint32_t event_mask;
+    kernel_pid_t pid;
+    uint32_t drops; /* posts lost because the queue of the thread was full */
+} msg_bus_entry_t;
+
+void msg_bus_init(msg_bus_t *bus, uint16_t id);
+/* attaches the calling thread, it has no subscriptions yet */
+void msg_bus_attach(msg_bus_t *bus, msg_bus_entry_t *entry);
+void msg_bus_detach(msg_bus_t *bus, msg_bus_entry_t *entry);
+void msg_bus_subscribe(msg_bus_entry_t *entry, uint8_t type);
+void msg_bus_unsubscribe(msg_bus_entry_t *entry, uint8_t type);
+/* delivers to all subscribers of type in one pass, from threads and isrs.
+ * Returns the number of threads reached, the others count a drop. */
+int msg_bus_post(msg_bus_t *bus, uint8_t type, void *arg);
+
+static inline int msg_is_from_bus(const msg_bus_t *bus, const msg_t *msg)
+{
+    return (msg->type >> 5) == bus->id;
+}
+
+static inline uint8_t msg_bus_get_type(const msg_t *msg)
+{
+    return msg->type & (MSG_BUS_NUMOF_TYPES - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_MSG_BUS_H */
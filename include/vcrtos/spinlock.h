@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_SPINLOCK_H
+#define VCRTOS_SPINLOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* busy waiting lock between cores, it does not mask interrupts, so users
+ * mask them first when the lock is shared with an isr */
+typedef struct
+{
+    volatile uint8_t locked;
+} spinlock_t;
+
+#define SPINLOCK_INIT { 0 }
+
+static inline void spinlock_init(spinlock_t *lock)
+{
+    __atomic_clear(&lock->locked, __ATOMIC_RELAXED);
+}
+
+static inline int spinlock_trylock(spinlock_t *lock)
+{
+    return !__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE);
+}
+
+static inline void spinlock_lock(spinlock_t *lock)
+{
+    while (__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE))
+    {
+        /* spin on a plain load to keep the cache line shared */
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED))
+        {
+        }
+    }
+}
+
+static inline void spinlock_unlock(spinlock_t *lock)
+{
+    __atomic_clear(&lock->locked, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_SPINLOCK_H */
@@ -21,17 +21,35 @@
 #include <stdlib.h>
 
 #include <vcrtos/config.h>
+#include <vcrtos/cpu.h>
 #include <vcrtos/kernel.h>
 #include <vcrtos/cib.h>
 #include <vcrtos/clist.h>
 #include <vcrtos/msg.h>
+#include <vcrtos/instance.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE && VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+#error "VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE and SMP can not be combined"
+#endif
+
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+#define sched_active_thread (kernel_instance_get_current()->active_thread)
+#define sched_active_pid (kernel_instance_get_current()->active_pid)
+#elif VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+/* one active thread per core, indexed by cpu_core_id() */
+extern void *sched_active_threads[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+extern int16_t sched_active_pids[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+
+#define sched_active_thread (sched_active_threads[cpu_core_id()])
+#define sched_active_pid (sched_active_pids[cpu_core_id()])
+#else
 extern void *sched_active_thread;
 extern int16_t sched_active_pid;
+#endif
 
 typedef void *(*thread_handler_func_t)(void *arg);
 
@@ -47,6 +65,7 @@ typedef enum
     THREAD_STATUS_FLAG_BLOCKED_ALL,
     THREAD_STATUS_MBOX_BLOCKED,
     THREAD_STATUS_COND_BLOCKED,
+    THREAD_STATUS_JOIN_BLOCKED,
     THREAD_STATUS_RUNNING,
     THREAD_STATUS_PENDING,
     THREAD_STATUS_NUMOF
@@ -58,6 +77,23 @@ typedef enum
 typedef uint16_t thread_flags_t;
 #endif
 
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+/* cores a thread may run on, bit n stands for core n */
+typedef uint32_t thread_affinity_t;
+
+#define THREAD_AFFINITY_ALL ((thread_affinity_t)((1ull << VCRTOS_CONFIG_SMP_NUMOF_CORES) - 1))
+#endif
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+#define THREAD_BUDGET_GROUP_NONE (0xff)
+#endif
+
+/* a pid together with the generation of its slot, it goes stale once the
+ * thread exits and the pid is handed to another thread */
+typedef uint32_t thread_handle_t;
+
+#define THREAD_HANDLE_INVALID ((thread_handle_t)0)
+
 typedef struct thread
 {
     char *stack_pointer;
@@ -68,7 +104,30 @@ typedef struct thread
     thread_flags_t flags;
     thread_flags_t waited_flags;
 #endif
+    uint16_t msg_type_mask; /* type bits a receive blocked thread filters on */
     list_node_t runqueue_entry;
+#if VCRTOS_CONFIG_EDF_ENABLE
+    uint32_t deadline;      /* absolute, only used at VCRTOS_CONFIG_EDF_PRIORITY */
+    int16_t deadline_slot;  /* index in the ready heap, -1 when not ready */
+    uint16_t deadline_misses;
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    uint8_t budget_group;  /* THREAD_BUDGET_GROUP_NONE when not limited */
+    kernel_pid_t budget_next; /* next member of the same group */
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    uint8_t base_priority; /* own priority, without throttling or inheritance */
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    kernel_pid_t ipc_server; /* thread it waits on in IPC, KERNEL_PID_UNDEF if none */
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    void *spawn_slot; /* pool slot of a spawned thread, NULL otherwise */
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    uint8_t core; /* core whose runqueue holds the thread */
+    thread_affinity_t affinity;
+#endif
     void *wait_data;
     list_node_t msg_waiters;
     cib_t msg_queue;
@@ -78,15 +137,44 @@ typedef struct thread
     int stack_size;
 } thread_t;
 
+typedef struct thread_snapshot
+{
+    kernel_pid_t pid;
+    const char *name;
+    thread_status_t status;
+    uint8_t priority;
+    char *stack_start;
+    int stack_size;
+    /* measured right after the copy, 0 if the thread exited in between */
+    int stack_free;
+    int msg_queue_depth;
+    uint32_t schedules;
+    uint64_t runtime_ticks;
+} thread_snapshot_t;
+
 #define THREAD_FLAGS_CREATE_SLEEPING (0x1)
 #define THREAD_FLAGS_CREATE_WOUT_YIELD (0x2)
 #define THREAD_FLAGS_CREATE_STACKMARKER (0x4)
+/* SMP: the thread only runs on the core that created it */
+#define THREAD_FLAGS_CREATE_PINNED (0x8)
+/* thread_spawn(): nobody joins, the stack goes back to its pool on exit */
+#define THREAD_FLAGS_CREATE_DETACHED (0x10)
+
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+typedef enum
+{
+    THREAD_STACK_SMALL,
+    THREAD_STACK_MEDIUM,
+    THREAD_STACK_LARGE,
+    THREAD_STACK_NUMOF
+} thread_stack_class_t;
+#endif
 
 kernel_pid_t thread_create(char *stack,
                            int size,
                            thread_handler_func_t func,
                            const char *name,
-                           char priority,
+                           uint8_t priority,
                            void *arg,
                            int flags);
 
@@ -108,9 +196,48 @@ kernel_pid_t thread_current_pid();
 thread_t *thread_get_from_scheduler(kernel_pid_t pid);
 uint64_t thread_get_runtime_ticks(kernel_pid_t pid);
 const char *thread_status_to_string(thread_status_t status);
+/* looks up the thread owning @p stack for its size, 0 for any other stack */
 uintptr_t thread_measure_stack_free(char *stack);
+/* for callers that know the size, no lookup and never past @p size bytes */
+uintptr_t thread_measure_stack_free_bounded(char *stack, size_t size);
 uint32_t thread_get_schedules_stat(kernel_pid_t pid);
 void thread_add_to_list(list_node_t *list, thread_t *thread);
+int thread_get_snapshot(thread_snapshot_t *snapshot, int size);
+thread_handle_t thread_get_handle(kernel_pid_t pid);
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+kernel_pid_t thread_spawn(thread_handler_func_t func, void *arg, thread_stack_class_t stack_class, uint8_t priority,
+                          int flags);
+int thread_join(kernel_pid_t pid, void **result);
+int thread_detach(kernel_pid_t pid);
+#endif
+kernel_pid_t thread_handle_get_pid(thread_handle_t handle);
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+void thread_stack_monitor_sample();
+kernel_pid_t thread_stack_monitor_start(char *stack, int size, uint8_t priority);
+int thread_get_stack_peak(kernel_pid_t pid);
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+int thread_edf_set_deadline(kernel_pid_t pid, uint32_t deadline);
+int thread_edf_renew_deadline(uint32_t relative_deadline);
+uint32_t thread_edf_get_deadline_misses(kernel_pid_t pid);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+int thread_budget_group_init(uint8_t group, uint32_t budget, uint32_t period, uint8_t background_priority);
+int thread_budget_group_join(kernel_pid_t pid, uint8_t group);
+uint32_t thread_budget_group_get_throttles(uint8_t group);
+void thread_scheduler_budget_expired();
+#endif
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+void thread_scheduler_set_time_slice(uint8_t priority, uint32_t ticks);
+void thread_scheduler_time_slice_expired();
+#endif
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+void thread_scheduler_msg_timeout_expired();
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+int thread_set_affinity(kernel_pid_t pid, thread_affinity_t affinity);
+thread_affinity_t thread_get_affinity(kernel_pid_t pid);
+#endif
 
 char *thread_arch_stack_init(thread_handler_func_t func, void *arg, void *stack_start, int size);
 void thread_arch_stack_print();
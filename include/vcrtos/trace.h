@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_TRACE_H
+#define VCRTOS_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    TRACE_EVENT_SWITCH = 1,      /* pid: thread switched in, arg: thread switched out */
+    TRACE_EVENT_WAKE,            /* pid: woken thread, arg: status it was blocked in */
+    TRACE_EVENT_BLOCK,           /* pid: blocked thread, arg: new status */
+    TRACE_EVENT_MSG_SEND,        /* pid: sender, arg: target pid */
+    TRACE_EVENT_MSG_RECV,        /* pid: receiver, arg: sender pid */
+    TRACE_EVENT_MUTEX_CONTENDED, /* pid: waiting thread, arg: mutex address */
+    TRACE_EVENT_ISR_ENTER,       /* pid: interrupted thread, arg: irq number */
+    TRACE_EVENT_ISR_EXIT,        /* pid: interrupted thread, arg: 0 */
+    TRACE_EVENT_HEAP_ALLOC,      /* pid: caller, arg: block address */
+    TRACE_EVENT_HEAP_FREE,       /* pid: caller, arg: block address */
+    TRACE_EVENT_DEADLINE_MISS,   /* pid: late EDF thread, arg: misses so far */
+    TRACE_EVENT_STACK_OVERFLOW,  /* pid: thread with overwritten canary, arg: 0 */
+    TRACE_EVENT_USER = 0x80,     /* first application defined event */
+} trace_event_type_t;
+
+/* fixed size record, stored and dumped little endian as is */
+typedef struct trace_event
+{
+    uint32_t timestamp;
+    uint8_t type;
+    uint8_t core; /* core the event was recorded on */
+    int16_t pid;
+    uint32_t arg;
+} trace_event_t;
+
+#if VCRTOS_CONFIG_TRACE_ENABLE
+#define VCRTOS_TRACE(type, pid, arg) trace_record((type), (pid), (uint32_t)(uintptr_t)(arg))
+#else
+#define VCRTOS_TRACE(type, pid, arg) \
+    do                               \
+    {                                \
+    } while (0)
+#endif
+
+void trace_record(uint8_t type, kernel_pid_t pid, uint32_t arg);
+
+/* the functions below are only built with VCRTOS_CONFIG_TRACE_ENABLE */
+
+/* recording is on from boot, stop it before reading a consistent dump */
+void trace_start();
+void trace_stop();
+void trace_clear();
+
+/* copies up to @p count retained events starting @p offset events after the
+ * oldest one, the events of each core follow those of the previous core */
+size_t trace_read(size_t offset, trace_event_t *events, size_t count);
+
+/* number of events overwritten since the last trace_clear(), all cores */
+uint32_t trace_get_dropped();
+
+/* called by the port from its interrupt entry and exit code */
+void trace_isr_enter(unsigned irq);
+void trace_isr_exit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_TRACE_H */
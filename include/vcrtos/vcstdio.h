@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_VCSTDIO_H
+#define VCRTOS_VCSTDIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <vcrtos/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void vcstdio_init();
+ssize_t vcstdio_read(void *buffer, size_t count);
+ssize_t vcstdio_write(const void *buffer, size_t len);
+
+#if VCRTOS_CONFIG_VCSTDIO_HOST
+int vcstdio_host_set_fd(int rx_fd, int tx_fd);
+int vcstdio_host_open_pty(char *name, size_t size);
+#else
+/* called by the uart driver from its rx/tx interrupt handlers */
+int vcstdio_isr_rx(const char *data, size_t len);
+int vcstdio_isr_tx(char *buffer, size_t size);
+
+/* implemented by the uart driver */
+void vcstdio_arch_init();
+void vcstdio_arch_tx_start();
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCRTOS_VCSTDIO_H */
@@ -15,31 +15,133 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <vcrtos/assert.h>
+
 #include "core/code_utils.h"
+#include "core/new.hpp"
 
 #include "cli/cli.hpp"
+#include "cli/cli_async.hpp"
 #include "cli/cli_server.hpp"
 
 namespace vc {
 namespace cli {
 
+static const char _hex_digits[] = "0123456789abcdef";
+
+Interpreter *Interpreter::_cli_interpreter;
+
+static DEFINE_ALIGNED_VAR(cli_interpreter_raw, sizeof(Interpreter), uint64_t);
+
+extern "C" void vccli_set_user_commands(const cli_command_t *user_commands, uint16_t length)
+{
+    Interpreter::init().set_user_commands(user_commands, length);
+}
+
+extern "C" int vccli_add_commands(const cli_command_t *commands, uint16_t length)
+{
+    return Interpreter::init().add_commands(commands, length);
+}
+
+extern "C" void vccli_output_bytes(const uint8_t *bytes, uint8_t length)
+{
+    Interpreter::init().output_bytes(bytes, length);
+}
+
+extern "C" void vccli_output_format(const char *fmt, ...)
+{
+    Server *server = Interpreter::init().get_output_server();
+
+    VERIFY_OR_EXIT(server != NULL);
+
+    va_list ap;
+    va_start(ap, fmt);
+    server->output_vformat(fmt, ap);
+    va_end(ap);
+
+exit:
+    return;
+}
+
+extern "C" void vccli_output(const char *string, uint16_t length)
+{
+    Server *server = Interpreter::init().get_output_server();
+
+    if (server != NULL)
+    {
+        server->output(string, length);
+    }
+}
+
 Interpreter::Interpreter()
     : _user_commands(NULL)
     , _user_commands_length(0)
+    , _commands_length(0)
     , _server(NULL)
 {
 }
 
+Server *Interpreter::get_output_server() const
+{
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+    /* handlers running on a worker write to the channel of their job */
+    if (Async::get() != NULL)
+    {
+        Server *channel = Async::get()->get_channel(sched_active_pid);
+
+        if (channel != NULL)
+        {
+            return channel;
+        }
+    }
+#endif
+
+    return _server;
+}
+
+Interpreter &Interpreter::init()
+{
+    /* one command table is shared by every cli server */
+    if (_cli_interpreter == NULL)
+    {
+        _cli_interpreter = new (&cli_interpreter_raw) Interpreter();
+    }
+
+    return *_cli_interpreter;
+}
+
 void Interpreter::output_bytes(const uint8_t *bytes, uint8_t length) const
 {
+    Server *server = get_output_server();
+    char buf[64];
+    uint16_t buf_length = 0;
+
+    VERIFY_OR_EXIT(server != NULL);
+
     for (int i = 0; i < length; i++)
     {
-        _server->output_format("%02x", bytes[i]);
+        buf[buf_length++] = _hex_digits[bytes[i] >> 4];
+        buf[buf_length++] = _hex_digits[bytes[i] & 0x0f];
+
+        if (buf_length == sizeof(buf))
+        {
+            server->output(buf, buf_length);
+            buf_length = 0;
+        }
     }
+
+    if (buf_length > 0)
+    {
+        server->output(buf, buf_length);
+    }
+
+exit:
+    return;
 }
 
 int Interpreter::parse_long(char *string, long &result)
@@ -60,7 +162,8 @@ void Interpreter::process_line(char *buf, uint16_t length, Server &server)
 {
     char *argv[MAX_ARGS];
     char *cmd;
-    uint8_t argc = 0, i = 0;
+    const cli_command_t *command;
+    uint8_t argc = 0;
 
     _server = &server;
 
@@ -85,23 +188,30 @@ void Interpreter::process_line(char *buf, uint16_t length, Server &server)
 
     cmd = buf;
 
-    VERIFY_OR_EXIT(_user_commands != NULL && _user_commands_length != 0);
+    command = find_command(cmd);
 
-    for (i = 0; i < _user_commands_length; i++)
+    if (command == NULL)
     {
-        if (strcmp(cmd, _user_commands[i].name) == 0)
-        {
-            _user_commands[i].command_handler_func(argc, argv);
-            break;
-        }
+        _server->output_format("Unknown command: %s\r\n", cmd);
     }
-
-    if (i == _user_commands_length)
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+    else if ((command->flags & CLI_COMMAND_FLAG_ASYNC) && Async::get() != NULL)
     {
-        _server->output_format("Unknown command: %s\r\n", cmd);
+        int tag = Async::get()->dispatch(command, argc, argv, *_server);
+
+        if (tag < 0)
+        {
+            _server->output_format("Busy\r\n");
+        }
+        else
+        {
+            _server->output_format("Pending %d\r\n", tag);
+        }
     }
+#endif
     else
     {
+        command->command_handler_func(argc, argv);
         _server->output_format("Done\r\n");
     }
 
@@ -109,10 +219,117 @@ exit:
     return;
 }
 
-void Interpreter::set_user_commands(const cli_command_t *commands, uint8_t length)
+void Interpreter::set_user_commands(const cli_command_t *commands, uint16_t length)
 {
+    /* replaces the table of the previous call, tables of add_commands() stay */
+    for (uint16_t i = 0; i < _user_commands_length; i++)
+    {
+        const cli_command_t *command = &_user_commands[i];
+
+        if (command->name == NULL)
+            continue;
+
+        uint16_t index = lower_bound(command->name);
+
+        if (index < _commands_length && _commands[index] == command)
+        {
+            _commands_length--;
+            memmove(&_commands[index], &_commands[index + 1], (_commands_length - index) * sizeof(_commands[0]));
+        }
+    }
+
     _user_commands = commands;
     _user_commands_length = length;
+
+    int added = add_commands(commands, length);
+
+    /* raise VCRTOS_CONFIG_CLI_MAX_COMMANDS */
+    vcassert(added >= 0);
+    (void)added;
+}
+
+int Interpreter::add_commands(const cli_command_t *commands, uint16_t length)
+{
+    int added = 0;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        const cli_command_t *command = &commands[i];
+
+        if (command->name == NULL || command->command_handler_func == NULL)
+            continue;
+
+        uint16_t index = lower_bound(command->name);
+
+        if (index < _commands_length && strcmp(_commands[index]->name, command->name) == 0)
+        {
+            /* first registration of a name wins */
+            continue;
+        }
+
+        if (_commands_length == MAX_COMMANDS)
+        {
+            /* the commands that fit stay registered */
+            return -1;
+        }
+
+        memmove(&_commands[index + 1], &_commands[index], (_commands_length - index) * sizeof(_commands[0]));
+        _commands[index] = command;
+        _commands_length++;
+        added++;
+    }
+
+    return added;
+}
+
+uint16_t Interpreter::lower_bound(const char *name) const
+{
+    uint16_t low = 0;
+    uint16_t high = _commands_length;
+
+    while (low < high)
+    {
+        uint16_t mid = low + (high - low) / 2;
+
+        if (strcmp(_commands[mid]->name, name) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+const cli_command_t *Interpreter::find_command(const char *name) const
+{
+    uint16_t index = lower_bound(name);
+
+    if (index < _commands_length && strcmp(_commands[index]->name, name) == 0)
+    {
+        return _commands[index];
+    }
+
+    return NULL;
+}
+
+uint16_t Interpreter::find_commands_by_prefix(const char *prefix, uint16_t &first) const
+{
+    size_t length = strlen(prefix);
+    uint16_t index = lower_bound(prefix);
+
+    first = index;
+
+    /* all names sharing the prefix are adjacent in the sorted index */
+    while (index < _commands_length && strncmp(_commands[index]->name, prefix, length) == 0)
+    {
+        index++;
+    }
+
+    return index - first;
 }
 
 } // namespace cli
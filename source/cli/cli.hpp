@@ -33,20 +33,35 @@ class Interpreter
 {
 public:
     Interpreter();
-    void set_user_commands(const cli_command_t *commands, uint8_t length);
+    static Interpreter &init();
+    void set_server(Server &server) { _server = &server; }
+    Server *get_server() const { return _server; }
+    Server *get_output_server() const;
+    void set_user_commands(const cli_command_t *commands, uint16_t length);
+    int add_commands(const cli_command_t *commands, uint16_t length);
+    const cli_command_t *find_command(const char *name) const;
+    uint16_t find_commands_by_prefix(const char *prefix, uint16_t &first) const;
+    const cli_command_t *get_command(uint16_t index) const { return _commands[index]; }
+    uint16_t get_numof_commands() const { return _commands_length; }
     void process_line(char *buf, uint16_t length, Server &server);
     static int parse_long(char *string, long &result);
     static int parse_unsigned_long(char *string, unsigned long &result);
     void output_bytes(const uint8_t *bytes, uint8_t length) const;
+    static Interpreter *_cli_interpreter;
 
 private:
     enum
     {
         MAX_ARGS = 32,
+        MAX_COMMANDS = VCRTOS_CONFIG_CLI_MAX_COMMANDS,
     };
 
+    uint16_t lower_bound(const char *name) const;
+
     const cli_command_t *_user_commands;
-    uint8_t _user_commands_length;
+    uint16_t _user_commands_length;
+    const cli_command_t *_commands[MAX_COMMANDS];
+    uint16_t _commands_length;
     Server *_server;
 };
 
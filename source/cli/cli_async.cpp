@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli/cli_async.hpp"
+
+#include "core/code_utils.h"
+#include "core/new.hpp"
+#include "core/thread.hpp"
+
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+
+namespace vc {
+namespace cli {
+
+Async *Async::_cli_async;
+
+static DEFINE_ALIGNED_VAR(cli_async_raw, sizeof(Async), uint64_t);
+
+char _cli_async_stacks[VCRTOS_CONFIG_CLI_ASYNC_WORKERS][VCRTOS_CONFIG_CLI_ASYNC_THREAD_STACK_SIZE];
+
+extern "C" void *thread_cli_async_handler(void *arg)
+{
+    AsyncWorker *worker = static_cast<AsyncWorker *>(arg);
+
+#ifdef UNITTEST
+    worker->get_mutex().lock();
+    worker->run();
+#else
+    while (1)
+    {
+        /* wait for the dispatcher to hand over a job */
+        worker->get_mutex().lock();
+        worker->run();
+    }
+#endif
+
+    return NULL;
+}
+
+AsyncChannel::AsyncChannel()
+    : _server(NULL)
+    , _request_seq(0)
+    , _prefix_length(0)
+    , _length(0)
+{
+}
+
+void AsyncChannel::open(Server &server, uint8_t tag)
+{
+    _server = &server;
+    _request_seq = server.get_request_seq();
+    _prefix_length = static_cast<uint16_t>(snprintf(_line, sizeof(_line), "[%u] ", tag));
+    _length = _prefix_length;
+}
+
+void AsyncChannel::close()
+{
+    flush();
+    _server = NULL;
+}
+
+void AsyncChannel::flush()
+{
+    if (_length > _prefix_length)
+    {
+        /* whole tagged line goes out in one call so output from different
+         * workers interleaves line by line */
+        _server->output_request(_line, _length, _request_seq);
+    }
+
+    _length = _prefix_length;
+}
+
+int AsyncChannel::output(const char *buf, uint16_t buf_length)
+{
+    VERIFY_OR_EXIT(_server != NULL, buf_length = 0);
+
+    for (uint16_t i = 0; i < buf_length; i++)
+    {
+        _line[_length++] = buf[i];
+
+        if (buf[i] == '\n' || _length == MAX_LINE_LENGTH)
+        {
+            flush();
+        }
+    }
+
+exit:
+    return buf_length;
+}
+
+int AsyncChannel::output_format(const char *fmt, ...)
+{
+    int res;
+
+    va_list ap;
+    va_start(ap, fmt);
+    res = output_vformat(fmt, ap);
+    va_end(ap);
+
+    return res;
+}
+
+int AsyncChannel::output_vformat(const char *fmt, va_list ap)
+{
+    char buf[MAX_LINE_LENGTH];
+
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+
+    return output(buf, static_cast<uint16_t>(strlen(buf)));
+}
+
+AsyncWorker::AsyncWorker()
+    : _mutex()
+    , _busy(false)
+    , _pid(KERNEL_PID_UNDEF)
+    , _command(NULL)
+    , _argc(0)
+    , _channel()
+{
+}
+
+int AsyncWorker::assign(const cli_command_t *command, int argc, char *argv[], Server &server, uint8_t tag)
+{
+    uint16_t offset = 0;
+
+    VERIFY_OR_EXIT(argc <= MAX_ARGS, argc = -1);
+
+    /* arguments point into the receive buffer of the server, which is reused
+     * for the next line while the job runs */
+    for (int i = 0; i < argc; i++)
+    {
+        size_t length = strlen(argv[i]) + 1;
+
+        VERIFY_OR_EXIT(offset + length <= sizeof(_args), argc = -1);
+
+        memcpy(&_args[offset], argv[i], length);
+        _argv[i] = &_args[offset];
+        offset += length;
+    }
+
+    _command = command;
+    _argc = argc;
+    _channel.open(server, tag);
+    _busy = true;
+
+    _mutex.unlock();
+
+exit:
+    return (argc < 0) ? -1 : 0;
+}
+
+void AsyncWorker::run()
+{
+    VERIFY_OR_EXIT(_command != NULL);
+
+    _command->command_handler_func(_argc, _argv);
+
+    _channel.output("Done\r\n", 6);
+    _channel.close();
+
+    _command = NULL;
+    _busy = false;
+
+exit:
+    return;
+}
+
+Async::Async()
+    : _next_tag(1)
+{
+}
+
+Async &Async::init()
+{
+    if (_cli_async == NULL)
+    {
+        _cli_async = new (&cli_async_raw) Async();
+
+        for (uint8_t i = 0; i < NUMOF_WORKERS; i++)
+        {
+            AsyncWorker &worker = _cli_async->_workers[i];
+
+            worker.set_pid(thread_create(_cli_async_stacks[i], sizeof(_cli_async_stacks[i]),
+                                         thread_cli_async_handler, "cli-async",
+                                         VCRTOS_CONFIG_CLI_ASYNC_THREAD_PRIORITY,
+                                         static_cast<void *>(&worker),
+                                         THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_STACKMARKER));
+        }
+    }
+
+    return *_cli_async;
+}
+
+int Async::dispatch(const cli_command_t *command, int argc, char *argv[], Server &server)
+{
+    for (uint8_t i = 0; i < NUMOF_WORKERS; i++)
+    {
+        AsyncWorker &worker = _workers[i];
+
+        if (worker.is_busy())
+            continue;
+
+        uint8_t tag = _next_tag;
+
+        if (worker.assign(command, argc, argv, server, tag) != 0)
+            return -1;
+
+        _next_tag = (_next_tag % 99) + 1;
+
+        return tag;
+    }
+
+    return -1;
+}
+
+Server *Async::get_channel(kernel_pid_t pid)
+{
+    for (uint8_t i = 0; i < NUMOF_WORKERS; i++)
+    {
+        if (_workers[i].is_busy() && _workers[i].get_pid() == pid)
+        {
+            return &_workers[i].get_channel();
+        }
+    }
+
+    return NULL;
+}
+
+} // namespace cli
+} // namespace vc
+
+#endif // #if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CLI_ASYNC_HPP
+#define CLI_ASYNC_HPP
+
+#include <stdint.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/cli.h>
+#include <vcrtos/kernel.h>
+
+#include "cli/cli.hpp"
+#include "cli/cli_server.hpp"
+
+#include "core/mutex.hpp"
+
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+
+namespace vc {
+namespace cli {
+
+class AsyncChannel : public Server
+{
+public:
+    AsyncChannel();
+    void open(Server &server, uint8_t tag);
+    void close();
+    virtual int output(const char *buf, uint16_t buf_length);
+    virtual int output_format(const char *fmt, ...);
+    virtual int output_vformat(const char *fmt, va_list ap);
+
+private:
+    enum
+    {
+        MAX_LINE_LENGTH = VCRTOS_CONFIG_CLI_MAX_LINE_LENGTH,
+    };
+
+    void flush();
+
+    Server *_server;
+    uint8_t _request_seq;
+    uint16_t _prefix_length;
+    uint16_t _length;
+    char _line[MAX_LINE_LENGTH];
+};
+
+class AsyncWorker
+{
+public:
+    AsyncWorker();
+    int assign(const cli_command_t *command, int argc, char *argv[], Server &server, uint8_t tag);
+    void run();
+    bool is_busy() const { return _busy; }
+    kernel_pid_t get_pid() const { return _pid; }
+    void set_pid(kernel_pid_t pid) { _pid = pid; }
+    AsyncChannel &get_channel() { return _channel; }
+    Mutex &get_mutex() { return _mutex; }
+
+private:
+    enum
+    {
+        MAX_ARGS = 32,
+        MAX_LINE_LENGTH = VCRTOS_CONFIG_CLI_MAX_LINE_LENGTH,
+    };
+
+    /* unlocked by the dispatcher when a job is assigned */
+    Mutex _mutex;
+    volatile bool _busy;
+    kernel_pid_t _pid;
+    const cli_command_t *_command;
+    int _argc;
+    char *_argv[MAX_ARGS];
+    char _args[MAX_LINE_LENGTH];
+    AsyncChannel _channel;
+};
+
+class Async
+{
+public:
+    Async();
+    static Async &init();
+    static Async *get() { return _cli_async; }
+    int dispatch(const cli_command_t *command, int argc, char *argv[], Server &server);
+    Server *get_channel(kernel_pid_t pid);
+    AsyncWorker &get_worker(uint8_t index) { return _workers[index]; }
+
+private:
+    enum
+    {
+        NUMOF_WORKERS = VCRTOS_CONFIG_CLI_ASYNC_WORKERS,
+    };
+
+    AsyncWorker _workers[NUMOF_WORKERS];
+    uint8_t _next_tag;
+
+    static Async *_cli_async;
+};
+
+} // namespace cli
+} // namespace vc
+
+#endif // #if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+
+#endif /* CLI_ASYNC_HPP */
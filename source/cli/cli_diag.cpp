@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include <vcrtos/cli_diag.h>
+#include <vcrtos/cpu.h>
+#include <vcrtos/heap.h>
+#include <vcrtos/irq_profile.h>
+#include <vcrtos/thread.h>
+#include <vcrtos/trace.h>
+
+#include "core/code_utils.h"
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+using namespace vc;
+
+typedef struct
+{
+    const char *name;
+    void *object;
+} diag_object_t;
+
+enum
+{
+    DIAG_MAX_OBJECTS = VCRTOS_CONFIG_CLI_DIAG_MAX_OBJECTS,
+    DIAG_MAX_WAITERS = 4,
+};
+
+/* commands run one at a time on the cli thread, keep the large buffers off
+ * its stack */
+static thread_snapshot_t diag_snapshot[KERNEL_MAXTHREADS];
+
+static uint64_t diag_top_runtime[KERNEL_PID_LAST + 1];
+static uint32_t diag_top_schedules[KERNEL_PID_LAST + 1];
+
+static diag_object_t diag_mutexes[DIAG_MAX_OBJECTS];
+static uint8_t diag_mutexes_length;
+
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+static diag_object_t diag_event_queues[DIAG_MAX_OBJECTS];
+static uint8_t diag_event_queues_length;
+#endif
+
+static unsigned diag_permille(uint64_t part, uint64_t total)
+{
+    return (total > 0) ? static_cast<unsigned>((part * 1000) / total) : 0;
+}
+
+static void diag_ps(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    int count = thread_get_snapshot(diag_snapshot, KERNEL_MAXTHREADS);
+    uint64_t total = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        total += diag_snapshot[i].runtime_ticks;
+    }
+
+    vccli_output_format("pid name             state     prio stack used/size msgq  schedules   cpu\r\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        thread_snapshot_t *entry = &diag_snapshot[i];
+
+        unsigned used = entry->stack_size - entry->stack_free;
+        unsigned cpu = diag_permille(entry->runtime_ticks, total);
+
+        vccli_output_format("%3d %-16s %-9s %4u %5u/%-5u %4d %10lu %3u.%u%%\r\n", entry->pid,
+                            (entry->name != NULL) ? entry->name : "-", thread_status_to_string(entry->status),
+                            entry->priority, used, static_cast<unsigned>(entry->stack_size),
+                            entry->msg_queue_depth, static_cast<unsigned long>(entry->schedules), cpu / 10,
+                            cpu % 10);
+    }
+}
+
+static void diag_top(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    int count = thread_get_snapshot(diag_snapshot, KERNEL_MAXTHREADS);
+    uint64_t total = 0;
+
+    /* usage since the previous invocation */
+    for (int i = 0; i < count; i++)
+    {
+        total += diag_snapshot[i].runtime_ticks - diag_top_runtime[diag_snapshot[i].pid];
+    }
+
+    vccli_output_format("pid name             state      switches   cpu\r\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        thread_snapshot_t *entry = &diag_snapshot[i];
+        uint64_t runtime = entry->runtime_ticks - diag_top_runtime[entry->pid];
+        uint32_t schedules = entry->schedules - diag_top_schedules[entry->pid];
+        unsigned cpu = diag_permille(runtime, total);
+
+        diag_top_runtime[entry->pid] = entry->runtime_ticks;
+        diag_top_schedules[entry->pid] = entry->schedules;
+
+        vccli_output_format("%3d %-16s %-9s %10lu %3u.%u%%\r\n", entry->pid, (entry->name != NULL) ? entry->name : "-",
+                            thread_status_to_string(entry->status), static_cast<unsigned long>(schedules), cpu / 10,
+                            cpu % 10);
+    }
+}
+
+static void diag_heap(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    if (!heap_is_initialized())
+    {
+        vccli_output_format("heap not initialized\r\n");
+        return;
+    }
+
+    size_t capacity = heap_get_capacity();
+    size_t free_size = heap_get_free_size();
+
+    vccli_output_format("capacity %lu used %lu free %lu%s\r\n", static_cast<unsigned long>(capacity),
+                        static_cast<unsigned long>(capacity - free_size), static_cast<unsigned long>(free_size),
+                        heap_is_clean() ? " clean" : "");
+}
+
+static void diag_mutex(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (uint8_t i = 0; i < diag_mutexes_length; i++)
+    {
+        Mutex *mutex = static_cast<Mutex *>(diag_mutexes[i].object);
+        kernel_pid_t waiters[DIAG_MAX_WAITERS];
+        uint8_t numof_waiters = 0;
+        bool locked;
+
+        unsigned irqmask = cpu_irq_disable();
+
+        locked = (mutex->queue.next != nullptr);
+
+        if (locked && mutex->queue.next != MUTEX_LOCKED)
+        {
+            for (list_node_t *node = mutex->queue.next; node != nullptr && numof_waiters < DIAG_MAX_WAITERS;
+                 node = node->next)
+            {
+                waiters[numof_waiters++] = Thread::get_thread_pointer_from_list_member(static_cast<List *>(node))->pid;
+            }
+        }
+
+        cpu_irq_restore(irqmask);
+
+        vccli_output_format("%-16s %s", diag_mutexes[i].name, locked ? "locked" : "unlocked");
+
+        for (uint8_t j = 0; j < numof_waiters; j++)
+        {
+            vccli_output_format(" %d", waiters[j]);
+        }
+
+        vccli_output_format("\r\n");
+    }
+}
+
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+static void diag_evq(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (uint8_t i = 0; i < diag_event_queues_length; i++)
+    {
+        event_queue_t *queue = static_cast<event_queue_t *>(diag_event_queues[i].object);
+
+        unsigned irqmask = cpu_irq_disable();
+        size_t pending = static_cast<Clist *>(&queue->event_list)->count();
+        cpu_irq_restore(irqmask);
+
+        vccli_output_format("%-16s pending %lu\r\n", diag_event_queues[i].name, static_cast<unsigned long>(pending));
+    }
+}
+#endif
+
+#if VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
+static void diag_irqprof(int argc, char *argv[])
+{
+    if (argc > 0 && strcmp(argv[0], "reset") == 0)
+    {
+        irq_profile_reset();
+        return;
+    }
+
+    irq_profile_site_t sites[8];
+    int count = irq_profile_get_worst(sites, ARRAY_LENGTH(sites));
+
+    vccli_output_format("      max       avg      count site\r\n");
+
+    for (int i = 0; i < count && i < static_cast<int>(ARRAY_LENGTH(sites)); i++)
+    {
+        const char *file = strrchr(sites[i].file, '/');
+
+        vccli_output_format("%9lu %9lu %10lu %s:%lu\r\n", static_cast<unsigned long>(sites[i].max_ticks),
+                            static_cast<unsigned long>(sites[i].total_ticks / sites[i].count),
+                            static_cast<unsigned long>(sites[i].count), (file != NULL) ? file + 1 : sites[i].file,
+                            static_cast<unsigned long>(sites[i].line));
+    }
+
+    if (irq_profile_get_overflow() > 0)
+    {
+        vccli_output_format("untracked %lu\r\n", static_cast<unsigned long>(irq_profile_get_overflow()));
+    }
+}
+#endif
+
+#if VCRTOS_CONFIG_TRACE_ENABLE
+static void diag_trace(int argc, char *argv[])
+{
+    if (argc > 0)
+    {
+        if (strcmp(argv[0], "start") == 0)
+        {
+            trace_start();
+        }
+        else if (strcmp(argv[0], "stop") == 0)
+        {
+            trace_stop();
+        }
+        else if (strcmp(argv[0], "clear") == 0)
+        {
+            trace_clear();
+        }
+        else
+        {
+            vccli_output_format("usage: trace [start|stop|clear]\r\n");
+        }
+
+        return;
+    }
+
+    /* events are dumped as hex records, one per line, for the host side
+     * converter in tools/trace2perfetto.py */
+    trace_event_t events[8];
+    size_t offset = 0;
+    size_t count;
+
+    trace_stop();
+
+    vccli_output_format("trace dropped %lu\r\n", static_cast<unsigned long>(trace_get_dropped()));
+
+    while ((count = trace_read(offset, events, ARRAY_LENGTH(events))) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            vccli_output_bytes(reinterpret_cast<const uint8_t *>(&events[i]), sizeof(trace_event_t));
+            vccli_output_format("\r\n");
+        }
+
+        offset += count;
+    }
+
+    trace_start();
+}
+#endif
+
+static const cli_command_t diag_commands[] = {
+    {"ps", diag_ps, 0},
+    {"top", diag_top, 0},
+    {"heap", diag_heap, 0},
+    {"mutex", diag_mutex, 0},
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+    {"evq", diag_evq, 0},
+#endif
+#if VCRTOS_CONFIG_TRACE_ENABLE
+    {"trace", diag_trace, 0},
+#endif
+#if VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
+    {"irqprof", diag_irqprof, 0},
+#endif
+};
+
+extern "C" int vccli_add_diag_commands()
+{
+    return vccli_add_commands(diag_commands, ARRAY_LENGTH(diag_commands));
+}
+
+extern "C" int vccli_diag_register_mutex(const char *name, mutex_t *mutex)
+{
+    VERIFY_OR_EXIT(diag_mutexes_length < DIAG_MAX_OBJECTS);
+
+    diag_mutexes[diag_mutexes_length].name = name;
+    diag_mutexes[diag_mutexes_length].object = mutex;
+    diag_mutexes_length++;
+
+    return 0;
+
+exit:
+    return -1;
+}
+
+#if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
+extern "C" int vccli_diag_register_event_queue(const char *name, event_queue_t *queue)
+{
+    VERIFY_OR_EXIT(diag_event_queues_length < DIAG_MAX_OBJECTS);
+
+    diag_event_queues[diag_event_queues_length].name = name;
+    diag_event_queues[diag_event_queues_length].object = queue;
+    diag_event_queues_length++;
+
+    return 0;
+
+exit:
+    return -1;
+}
+#endif
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vcrtos/vcstdio.h>
+
+#include "cli/cli_async.hpp"
+#include "cli/cli_rpc.hpp"
+
+#include "core/code_utils.h"
+#include "core/new.hpp"
+#include "core/thread.hpp"
+
+namespace vc {
+namespace cli {
+
+static const uint16_t _crc16_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+Rpc *Rpc::_rpc_server;
+
+static DEFINE_ALIGNED_VAR(cli_rpc_raw, sizeof(Rpc), uint64_t);
+
+extern "C" void *thread_cli_rpc_handler(void *arg)
+{
+    Rpc *rpc = static_cast<Rpc *>(arg);
+
+    uint8_t buf[VCRTOS_CONFIG_CLI_UART_READ_CHUNK_SIZE];
+
+    while (1)
+    {
+        ssize_t length = vcstdio_read(static_cast<void *>(buf), sizeof(buf));
+
+        if (length > 0)
+        {
+            rpc->receive_task(buf, static_cast<uint16_t>(length));
+        }
+    }
+
+    /* should not reach here */
+
+    return NULL;
+}
+
+char _cli_rpc_stack[VCRTOS_CONFIG_CLI_RPC_THREAD_STACK_SIZE];
+
+extern "C" void vccli_rpc_init()
+{
+    Rpc::_rpc_server = new (&cli_rpc_raw) Rpc();
+    Rpc::_rpc_server->get_interpreter().set_server(*Rpc::_rpc_server);
+
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+    (void) Async::init();
+#endif
+
+    (void) thread_create(_cli_rpc_stack, sizeof(_cli_rpc_stack), thread_cli_rpc_handler, "rpc-cli",
+                         VCRTOS_CONFIG_CLI_RPC_THREAD_PRIORITY,
+                         static_cast<void *>(Rpc::_rpc_server),
+                         THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_STACKMARKER);
+}
+
+extern "C" void vccli_rpc_set_commands(const cli_rpc_command_t *commands, uint16_t length)
+{
+    Rpc::_rpc_server->set_commands(commands, length);
+}
+
+static inline uint16_t read_uint16(const uint8_t *buf)
+{
+    return static_cast<uint16_t>(buf[0] | (buf[1] << 8));
+}
+
+static inline void write_uint16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = static_cast<uint8_t>(value);
+    buf[1] = static_cast<uint8_t>(value >> 8);
+}
+
+Rpc::Rpc()
+    : _state(STATE_SYNC)
+    , _rx_length(0)
+    , _rx_expected(0)
+    , _rx_crc(0)
+    , _rx_errors(0)
+    , _seq(0)
+    , _output_mutex(MUTEX_INIT_UNLOCKED)
+    , _commands(NULL)
+    , _commands_length(0)
+    , _interpreter(Interpreter::init())
+{
+}
+
+uint16_t Rpc::crc16(uint16_t crc, const uint8_t *buf, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc = static_cast<uint16_t>((crc << 4) ^ _crc16_table[(crc >> 12) ^ (buf[i] >> 4)]);
+        crc = static_cast<uint16_t>((crc << 4) ^ _crc16_table[(crc >> 12) ^ (buf[i] & 0x0f)]);
+    }
+
+    return crc;
+}
+
+void Rpc::set_commands(const cli_rpc_command_t *commands, uint16_t length)
+{
+    _commands = commands;
+    _commands_length = length;
+}
+
+void Rpc::receive_task(const uint8_t *buf, uint16_t buf_length)
+{
+    const uint8_t *end = buf + buf_length;
+
+    for (; buf < end; buf++)
+    {
+        switch (_state)
+        {
+        case STATE_SYNC:
+            if (*buf == CLI_RPC_FRAME_SYNC)
+            {
+                _state = STATE_LENGTH_LOW;
+            }
+            break;
+
+        case STATE_LENGTH_LOW:
+            _rx_expected = *buf;
+            _state = STATE_LENGTH_HIGH;
+            break;
+
+        case STATE_LENGTH_HIGH:
+            _rx_expected |= static_cast<uint16_t>(*buf << 8);
+
+            if (_rx_expected == 0 || _rx_expected > MAX_PAYLOAD_SIZE)
+            {
+                _rx_errors++;
+                _state = STATE_SYNC;
+                break;
+            }
+
+            _rx_length = 0;
+            _state = STATE_PAYLOAD;
+            break;
+
+        case STATE_PAYLOAD:
+        {
+            /* copy as much of the payload as this chunk holds at once */
+            uint16_t length = _rx_expected - _rx_length;
+
+            if (length > end - buf)
+            {
+                length = static_cast<uint16_t>(end - buf);
+            }
+
+            memcpy(&_rx_payload[_rx_length], buf, length);
+            _rx_length += length;
+            buf += length - 1;
+
+            if (_rx_length == _rx_expected)
+            {
+                _state = STATE_CRC_LOW;
+            }
+            break;
+        }
+
+        case STATE_CRC_LOW:
+            _rx_crc = *buf;
+            _state = STATE_CRC_HIGH;
+            break;
+
+        case STATE_CRC_HIGH:
+        {
+            uint8_t length[2];
+            uint16_t crc;
+
+            _rx_crc |= static_cast<uint16_t>(*buf << 8);
+            _state = STATE_SYNC;
+
+            write_uint16(length, _rx_expected);
+            crc = crc16(0xffff, length, sizeof(length));
+            crc = crc16(crc, _rx_payload, _rx_length);
+
+            if (crc != _rx_crc)
+            {
+                _rx_errors++;
+                break;
+            }
+
+            process_frame();
+            break;
+        }
+        }
+    }
+}
+
+void Rpc::process_frame()
+{
+    VERIFY_OR_EXIT(_rx_length >= 2);
+
+    _seq = _rx_payload[1];
+
+    switch (_rx_payload[0])
+    {
+    case CLI_RPC_FRAME_REQUEST:
+        process_request();
+        break;
+
+    case CLI_RPC_FRAME_TEXT:
+        process_text();
+        break;
+
+    default:
+        _rx_errors++;
+        break;
+    }
+
+exit:
+    return;
+}
+
+void Rpc::process_request()
+{
+    cli_rpc_arg_t args[MAX_ARGS];
+    uint8_t argc = 0;
+    const cli_rpc_command_t *command;
+    int res;
+
+    if (_rx_length < REQUEST_HEADER_SIZE)
+    {
+        send_response(CLI_RPC_STATUS_INVALID_ARGS, 0);
+        return;
+    }
+
+    command = find_command(read_uint16(&_rx_payload[2]));
+
+    if (command == NULL)
+    {
+        send_response(CLI_RPC_STATUS_UNKNOWN_COMMAND, 0);
+        return;
+    }
+
+    if (parse_args(&_rx_payload[REQUEST_HEADER_SIZE], _rx_length - REQUEST_HEADER_SIZE, args, argc) != 0)
+    {
+        send_response(CLI_RPC_STATUS_INVALID_ARGS, 0);
+        return;
+    }
+
+    /* handler writes its result straight into the outgoing frame */
+    res = command->handler(args, argc, &_tx_frame[FRAME_HEADER_SIZE + RESPONSE_HEADER_SIZE],
+                           MAX_PAYLOAD_SIZE - RESPONSE_HEADER_SIZE);
+
+    if (res < 0)
+    {
+        send_response(static_cast<uint8_t>(-res), 0);
+    }
+    else if (res > MAX_PAYLOAD_SIZE - RESPONSE_HEADER_SIZE)
+    {
+        send_response(CLI_RPC_STATUS_NO_BUFFER, 0);
+    }
+    else
+    {
+        send_response(CLI_RPC_STATUS_OK, static_cast<uint16_t>(res));
+    }
+}
+
+void Rpc::process_text()
+{
+    char *line = reinterpret_cast<char *>(&_rx_payload[2]);
+    uint16_t length = _rx_length - 2;
+
+    if (length > 0)
+    {
+        line[length] = '\0';
+        _interpreter.process_line(line, length, *this);
+    }
+
+    send_response(CLI_RPC_STATUS_OK, 0);
+}
+
+int Rpc::parse_args(uint8_t *buf, uint16_t length, cli_rpc_arg_t *args, uint8_t &argc)
+{
+    uint16_t offset = 0;
+    cli_rpc_arg_t *string = NULL;
+
+    argc = 0;
+
+    while (offset < length)
+    {
+        cli_rpc_arg_t *arg = &args[argc];
+
+        if (argc == MAX_ARGS || length - offset < ARG_HEADER_SIZE)
+            return -1;
+
+        arg->type = buf[offset];
+        arg->length = read_uint16(&buf[offset + 1]);
+
+        /* the header of this argument has been read, so the previous string
+         * can now be terminated in place of it */
+        if (string != NULL)
+        {
+            buf[offset] = '\0';
+            string = NULL;
+        }
+
+        offset += ARG_HEADER_SIZE;
+
+        if (arg->length > length - offset)
+            return -1;
+
+        const uint8_t *value = &buf[offset];
+
+        switch (arg->type)
+        {
+        case CLI_RPC_ARG_UINT:
+        case CLI_RPC_ARG_INT:
+        {
+            uint32_t u32 = 0;
+
+            if (arg->length != 1 && arg->length != 2 && arg->length != 4)
+                return -1;
+
+            for (uint16_t i = arg->length; i > 0; i--)
+            {
+                u32 = (u32 << 8) | value[i - 1];
+            }
+
+            if (arg->type == CLI_RPC_ARG_INT && arg->length < 4 && (value[arg->length - 1] & 0x80))
+            {
+                /* sign extend */
+                u32 |= 0xffffffffUL << (arg->length * 8);
+            }
+
+            arg->value.u32 = u32;
+            break;
+        }
+
+        case CLI_RPC_ARG_BYTES:
+            arg->value.bytes = value;
+            break;
+
+        case CLI_RPC_ARG_STRING:
+            arg->value.string = reinterpret_cast<const char *>(value);
+            string = arg;
+            break;
+
+        default:
+            return -1;
+        }
+
+        offset += arg->length;
+        argc++;
+    }
+
+    if (string != NULL)
+    {
+        /* payload buffer has a spare byte past the end */
+        buf[offset] = '\0';
+    }
+
+    return 0;
+}
+
+const cli_rpc_command_t *Rpc::find_command(uint16_t id) const
+{
+    uint16_t low = 0;
+    uint16_t high = _commands_length;
+
+    while (low < high)
+    {
+        uint16_t mid = low + (high - low) / 2;
+
+        if (_commands[mid].id == id)
+        {
+            return &_commands[mid];
+        }
+        else if (_commands[mid].id < id)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+void Rpc::send_response(uint8_t status, uint16_t length)
+{
+    uint8_t *payload = &_tx_frame[FRAME_HEADER_SIZE];
+
+    payload[0] = CLI_RPC_FRAME_RESPONSE;
+    payload[1] = _seq;
+    payload[2] = status;
+
+    _output_mutex.lock();
+    send_frame(_tx_frame, RESPONSE_HEADER_SIZE + length);
+    _output_mutex.unlock();
+}
+
+void Rpc::send_frame(uint8_t *frame, uint16_t length)
+{
+    uint16_t crc;
+
+    frame[0] = CLI_RPC_FRAME_SYNC;
+    write_uint16(&frame[1], length);
+
+    crc = crc16(0xffff, &frame[1], length + 2);
+    write_uint16(&frame[FRAME_HEADER_SIZE + length], crc);
+
+    vcstdio_write(frame, FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE);
+}
+
+int Rpc::output(const char *buf, uint16_t buf_length)
+{
+    return output_request(buf, buf_length, _seq);
+}
+
+int Rpc::output_request(const char *buf, uint16_t buf_length, uint8_t seq)
+{
+    uint8_t *payload = &_log_frame[FRAME_HEADER_SIZE];
+    uint16_t remaining = buf_length;
+
+    _output_mutex.lock();
+
+    payload[0] = CLI_RPC_FRAME_LOG;
+    payload[1] = seq;
+
+    while (remaining > 0)
+    {
+        uint16_t length = remaining;
+
+        if (length > MAX_LINE_LENGTH)
+        {
+            length = MAX_LINE_LENGTH;
+        }
+
+        memcpy(&payload[LOG_HEADER_SIZE], buf, length);
+        send_frame(_log_frame, LOG_HEADER_SIZE + length);
+
+        buf += length;
+        remaining -= length;
+    }
+
+    _output_mutex.unlock();
+
+    return buf_length;
+}
+
+int Rpc::output_format(const char *fmt, ...)
+{
+    int res;
+
+    va_list ap;
+    va_start(ap, fmt);
+    res = output_vformat(fmt, ap);
+    va_end(ap);
+
+    return res;
+}
+
+int Rpc::output_vformat(const char *fmt, va_list ap)
+{
+    char buf[MAX_LINE_LENGTH];
+
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+
+    return output(buf, static_cast<uint16_t>(strlen(buf)));
+}
+
+} // namespace cli
+} // namespace vc
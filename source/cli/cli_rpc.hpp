@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CLI_RPC_HPP
+#define CLI_RPC_HPP
+
+#include <vcrtos/config.h>
+#include <vcrtos/cli_rpc.h>
+
+#include "cli/cli.hpp"
+#include "cli/cli_server.hpp"
+
+#include "core/mutex.hpp"
+
+namespace vc {
+
+namespace cli {
+
+class Rpc : public Server
+{
+public:
+    Rpc();
+    virtual int output(const char *buf, uint16_t buf_length);
+    virtual int output_format(const char *fmt, ...);
+    virtual int output_vformat(const char *fmt, va_list ap);
+    virtual uint8_t get_request_seq() const { return _seq; }
+    virtual int output_request(const char *buf, uint16_t buf_length, uint8_t seq);
+    Interpreter &get_interpreter() { return _interpreter; }
+    void set_commands(const cli_rpc_command_t *commands, uint16_t length);
+    void receive_task(const uint8_t *buf, uint16_t buf_length);
+    uint32_t get_rx_errors() const { return _rx_errors; }
+    static uint16_t crc16(uint16_t crc, const uint8_t *buf, uint16_t length);
+    static Rpc *_rpc_server;
+
+private:
+    enum
+    {
+        MAX_PAYLOAD_SIZE = VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE,
+        MAX_ARGS = VCRTOS_CONFIG_CLI_RPC_MAX_ARGS,
+        MAX_LINE_LENGTH = VCRTOS_CONFIG_CLI_MAX_LINE_LENGTH,
+        FRAME_HEADER_SIZE = 3,
+        FRAME_CRC_SIZE = 2,
+        REQUEST_HEADER_SIZE = 4,
+        RESPONSE_HEADER_SIZE = 3,
+        LOG_HEADER_SIZE = 2,
+        ARG_HEADER_SIZE = 3,
+    };
+
+    enum State
+    {
+        STATE_SYNC,
+        STATE_LENGTH_LOW,
+        STATE_LENGTH_HIGH,
+        STATE_PAYLOAD,
+        STATE_CRC_LOW,
+        STATE_CRC_HIGH,
+    };
+
+    void process_frame();
+    void process_request();
+    void process_text();
+    int parse_args(uint8_t *buf, uint16_t length, cli_rpc_arg_t *args, uint8_t &argc);
+    const cli_rpc_command_t *find_command(uint16_t id) const;
+    void send_response(uint8_t status, uint16_t length);
+    void send_frame(uint8_t *frame, uint16_t length);
+
+    State _state;
+    uint16_t _rx_length;
+    uint16_t _rx_expected;
+    uint16_t _rx_crc;
+    uint32_t _rx_errors;
+
+    /* one spare byte to terminate text lines and string arguments */
+    uint8_t _rx_payload[MAX_PAYLOAD_SIZE + 1];
+
+    uint8_t _tx_frame[FRAME_HEADER_SIZE + MAX_PAYLOAD_SIZE + FRAME_CRC_SIZE];
+
+    /* text output is framed separately so handlers can log while they build
+     * their binary response */
+    uint8_t _log_frame[FRAME_HEADER_SIZE + LOG_HEADER_SIZE + MAX_LINE_LENGTH + FRAME_CRC_SIZE];
+
+    uint8_t _seq;
+
+    /* keeps frames from the rpc thread and async workers whole on the wire */
+    Mutex _output_mutex;
+
+    const cli_rpc_command_t *_commands;
+    uint16_t _commands_length;
+
+    Interpreter &_interpreter;
+};
+
+} // namespace cli
+} // namespace vc
+
+#endif /* CLI_RPC_HPP */
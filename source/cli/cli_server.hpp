@@ -18,15 +18,33 @@
 #ifndef CLI_SERVER_HPP
 #define CLI_SERVER_HPP
 
+#include <stdarg.h>
+#include <stdint.h>
+
 namespace vc {
 namespace cli {
 
 class Server
 {
 public:
+    virtual ~Server() {}
+
     virtual int output(const char *buf, uint16_t length) = 0;
 
     virtual int output_format(const char *fmt, ...) = 0;
+
+    virtual int output_vformat(const char *fmt, va_list ap) = 0;
+
+    /* sequence number of the request being processed, async jobs keep the
+     * one they were dispatched for */
+    virtual uint8_t get_request_seq() const { return 0; }
+
+    /* output on behalf of request @p seq, servers without requests ignore it */
+    virtual int output_request(const char *buf, uint16_t length, uint8_t seq)
+    {
+        (void)seq;
+        return output(buf, length);
+    }
 };
 
 } // namespace cli
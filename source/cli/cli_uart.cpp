@@ -20,6 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <vcrtos/vcstdio.h>
+
+#include "cli/cli_async.hpp"
 #include "cli/cli_uart.hpp"
 
 #include "core/code_utils.h"
@@ -35,8 +38,6 @@ static const char _command_prompt[] = {'>', ' '};
 static const char _erase_string[]   = {'\b', ' ', '\b'};
 static const char _newline[]           = {'\r', '\n'};
 
-extern "C" ssize_t vcstdio_read(void *buffer, size_t count);
-
 Uart *Uart::_uart_server;
 
 static DEFINE_ALIGNED_VAR(cli_uart_raw, sizeof(Uart), uint64_t);
@@ -47,13 +48,15 @@ extern "C" void *thread_cli_uart_handler(void *arg)
 
     uart->output(_command_prompt, sizeof(_command_prompt));
 
-    char c;
+    char buf[VCRTOS_CONFIG_CLI_UART_READ_CHUNK_SIZE];
 
     while (1)
     {
-        if (vcstdio_read(static_cast<void *>(&c), 1))
+        ssize_t length = vcstdio_read(static_cast<void *>(buf), sizeof(buf));
+
+        if (length > 0)
         {
-            uart->receive_task(reinterpret_cast<const uint8_t *>(&c), 1);
+            uart->receive_task(reinterpret_cast<const uint8_t *>(buf), static_cast<uint16_t>(length));
         }
     }
 
@@ -67,6 +70,11 @@ char _cli_uart_stack[VCRTOS_CONFIG_CLI_UART_THREAD_STACK_SIZE];
 extern "C" void vccli_uart_init()
 {
     Uart::_uart_server = new (&cli_uart_raw) Uart();
+    Uart::_uart_server->get_interpreter().set_server(*Uart::_uart_server);
+
+#if VCRTOS_CONFIG_CLI_ASYNC_ENABLE
+    (void) Async::init();
+#endif
 
     (void) thread_create(_cli_uart_stack, sizeof(_cli_uart_stack), thread_cli_uart_handler, "uart-cli",
                          VCRTOS_CONFIG_CLI_UART_THREAD_PRIORITY,
@@ -74,35 +82,13 @@ extern "C" void vccli_uart_init()
                          THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_STACKMARKER);
 }
 
-extern "C" void vccli_set_user_commands(const cli_command_t *user_commands, uint8_t length)
-{
-    Uart::_uart_server->get_interpreter().set_user_commands(user_commands, length);
-}
-
-extern "C" void vccli_output_bytes(const uint8_t *bytes, uint8_t length)
-{
-    Uart::_uart_server->get_interpreter().output_bytes(bytes, length);
-}
-
-extern "C" void vccli_output_format(const char *fmt, ...)
-{
-    va_list ap;
-    va_start(ap, fmt);
-    Uart::_uart_server->output_format(fmt, ap);
-    va_end(ap);
-}
-
-extern "C" void vccli_output(const char *string, uint16_t length)
-{
-    Uart::_uart_server->output(string, length);
-}
-
 Uart::Uart()
     : _rx_length(0)
     , _tx_head(0)
     , _tx_length(0)
     , _send_length(0)
-    , _interpreter()
+    , _output_mutex(MUTEX_INIT_UNLOCKED)
+    , _interpreter(Interpreter::init())
 {
 }
 
@@ -112,41 +98,58 @@ void Uart::receive_task(const uint8_t *buf, uint16_t buf_length)
 
     end = buf + buf_length;
 
+    _output_mutex.lock();
+
     for (; buf < end; buf++)
     {
         switch (*buf)
         {
         case '\r':
         case '\n':
-            output(_newline, sizeof(_newline));
+            append(_newline, sizeof(_newline));
 
             if (_rx_length > 0)
             {
                 _rx_buffer[_rx_length] = '\0';
+
+                /* command output takes the lock on its own */
+                send();
+                _output_mutex.unlock();
                 process_command();
+                _output_mutex.lock();
             }
 
-            output(_command_prompt, sizeof(_command_prompt));
+            append(_command_prompt, sizeof(_command_prompt));
+            break;
+
+        case '\t':
+            complete_command();
             break;
 
         case '\b':
         case 127:
             if (_rx_length > 0)
             {
-                output(_erase_string, sizeof(_erase_string));
+                append(_erase_string, sizeof(_erase_string));
                 _rx_buffer[--_rx_length] = '\0';
             }
             break;
 
         default:
-            if (_rx_length < RX_BUFFER_SIZE)
+            /* keep room for the terminating null character */
+            if (_rx_length < RX_BUFFER_SIZE - 1)
             {
-                output(reinterpret_cast<const char *>(buf), 1);
+                append(reinterpret_cast<const char *>(buf), 1);
                 _rx_buffer[_rx_length++] = static_cast<char>(*buf);
             }
             break;
         }
     }
+
+    /* echo of the whole received chunk goes out in one write */
+    send();
+
+    _output_mutex.unlock();
 }
 
 int Uart::process_command()
@@ -168,37 +171,122 @@ int Uart::process_command()
     return 0;
 }
 
-int Uart::output(const char *buf, uint16_t buf_length)
+void Uart::complete_command()
 {
-    uint16_t remaining = TX_BUFFER_SIZE - _tx_length;
-    uint16_t tail;
+    uint16_t first;
+    uint16_t count;
 
-    if (buf_length > remaining)
+    _rx_buffer[_rx_length] = '\0';
+
+    /* only the command name is completed */
+    if (memchr(_rx_buffer, ' ', _rx_length) != NULL)
+        return;
+
+    count = _interpreter.find_commands_by_prefix(_rx_buffer, first);
+
+    if (count == 0)
+        return;
+
+    /* matches are sorted, so the prefix common to all of them is the one
+     * shared by the first and the last match */
+    const char *first_name = _interpreter.get_command(first)->name;
+    const char *last_name = _interpreter.get_command(first + count - 1)->name;
+    uint16_t common = _rx_length;
+
+    while (first_name[common] != '\0' && first_name[common] == last_name[common])
     {
-        buf_length = remaining;
+        common++;
     }
 
-    for (int i = 0; i < buf_length; i++)
+    if (count == 1 && first_name[common] == '\0' && common + 1 < RX_BUFFER_SIZE)
     {
-        tail = (_tx_head + _tx_length) % TX_BUFFER_SIZE;
-        _tx_buffer[tail] = *buf++;
-        _tx_length++;
+        /* unique match, complete the name and start the first argument */
+        append(&first_name[_rx_length], common - _rx_length);
+        memcpy(&_rx_buffer[_rx_length], &first_name[_rx_length], common - _rx_length);
+        _rx_length = common;
+        _rx_buffer[_rx_length++] = ' ';
+        append(" ", 1);
     }
+    else if (common > _rx_length && common < RX_BUFFER_SIZE)
+    {
+        append(&first_name[_rx_length], common - _rx_length);
+        memcpy(&_rx_buffer[_rx_length], &first_name[_rx_length], common - _rx_length);
+        _rx_length = common;
+    }
+    else
+    {
+        append(_newline, sizeof(_newline));
 
-    send();
+        for (uint16_t i = first; i < first + count; i++)
+        {
+            const char *name = _interpreter.get_command(i)->name;
+            append(name, static_cast<uint16_t>(strlen(name)));
+            append(" ", 1);
+        }
+
+        append(_newline, sizeof(_newline));
+        append(_command_prompt, sizeof(_command_prompt));
+        append(_rx_buffer, _rx_length);
+    }
+}
 
+int Uart::output(const char *buf, uint16_t buf_length)
+{
+    _output_mutex.lock();
+    append(buf, buf_length);
+    send();
+    _output_mutex.unlock();
     return buf_length;
 }
 
+void Uart::append(const char *buf, uint16_t buf_length)
+{
+    while (buf_length > 0)
+    {
+        if (_tx_length == TX_BUFFER_SIZE)
+        {
+            send();
+        }
+
+        uint16_t tail = (_tx_head + _tx_length) % TX_BUFFER_SIZE;
+        uint16_t length = TX_BUFFER_SIZE - _tx_length;
+
+        if (length > TX_BUFFER_SIZE - tail)
+        {
+            length = TX_BUFFER_SIZE - tail;
+        }
+
+        if (length > buf_length)
+        {
+            length = buf_length;
+        }
+
+        memcpy(&_tx_buffer[tail], buf, length);
+
+        _tx_length += length;
+        buf += length;
+        buf_length -= length;
+    }
+}
+
 int Uart::output_format(const char *fmt, ...)
 {
-    char buf[MAX_LINE_LENGTH];
+    int res;
 
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, ap);
+    res = output_vformat(fmt, ap);
     va_end(ap);
 
+    return res;
+}
+
+int Uart::output_vformat(const char *fmt, va_list ap)
+{
+    char buf[MAX_LINE_LENGTH];
+
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+
     return output(buf, static_cast<uint16_t>(strlen(buf)));
 }
 
@@ -217,11 +305,7 @@ void Uart::send()
 
         if (_send_length > 0)
         {
-            for (uint16_t i = 0; i < _send_length; i++)
-            {
-                putchar(_tx_buffer[_tx_head + i]);
-                fflush(stdout);
-            }
+            vcstdio_write(&_tx_buffer[_tx_head], _send_length);
         }
 
         _tx_head = (_tx_head + _send_length) % TX_BUFFER_SIZE;
@@ -23,6 +23,8 @@
 #include "cli/cli.hpp"
 #include "cli/cli_server.hpp"
 
+#include "core/mutex.hpp"
+
 namespace vc {
 
 namespace cli {
@@ -33,6 +35,7 @@ public:
     Uart();
     virtual int output(const char *buf, uint16_t buf_length);
     virtual int output_format(const char *fmt, ...);
+    virtual int output_vformat(const char *fmt, va_list ap);
     Interpreter &get_interpreter() { return _interpreter; }
     void receive_task(const uint8_t *buf, uint16_t buf_length);
     static Uart *_uart_server;
@@ -46,6 +49,8 @@ private:
     };
 
     int process_command();
+    void complete_command();
+    void append(const char *buf, uint16_t buf_length);
     void send();
 
     char _rx_buffer[RX_BUFFER_SIZE];
@@ -57,7 +62,10 @@ private:
 
     uint16_t _send_length;
 
-    Interpreter _interpreter;
+    /* serializes the tx ring between the cli thread and async workers */
+    Mutex _output_mutex;
+
+    Interpreter &_interpreter;
 
     friend class Interpreter;
 };
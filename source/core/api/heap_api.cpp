@@ -18,6 +18,8 @@
 #include <vcrtos/config.h>
 #include <vcrtos/heap.h>
 #include <vcrtos/assert.h>
+#include <vcrtos/thread.h>
+#include <vcrtos/trace.h>
 
 #include "core/code_utils.h"
 #include "core/new.hpp"
@@ -38,6 +40,11 @@ void *heap_init()
     return heap;
 }
 
+int heap_is_initialized()
+{
+    return heap != NULL;
+}
+
 size_t heap_get_free_size()
 {
     vcassert(heap != NULL);
@@ -59,6 +66,7 @@ bool heap_is_clean()
 void heap_free(void *ptr)
 {
     vcassert(heap != NULL);
+    VCRTOS_TRACE(TRACE_EVENT_HEAP_FREE, sched_active_pid, ptr);
     heap->free(ptr);
 }
 
@@ -70,5 +78,7 @@ void *heap_malloc(size_t size)
 void *heap_calloc(size_t count, size_t size)
 {
     vcassert(heap != NULL);
-    return heap->calloc(count, size);
+    void *ptr = heap->calloc(count, size);
+    VCRTOS_TRACE(TRACE_EVENT_HEAP_ALLOC, sched_active_pid, ptr);
+    return ptr;
 }
@@ -19,6 +19,7 @@
 
 #include "core/msg.hpp"
 #include "core/new.hpp"
+#include "core/thread.hpp"
 
 using namespace vc;
 
@@ -62,7 +63,69 @@ int msg_reply(msg_t *msg, msg_t *reply)
     return (*static_cast<Msg *>(msg)).reply(static_cast<Msg *>(reply));
 }
 
+int msg_reply_and_receive(msg_t *msg, msg_t *reply)
+{
+    return (*static_cast<Msg *>(msg)).reply_and_receive(static_cast<Msg *>(reply));
+}
+
 int msg_reply_in_isr(msg_t *msg, msg_t *reply)
 {
     return (*static_cast<Msg *>(msg)).reply_in_isr(static_cast<Msg *>(reply));
 }
+
+int msg_receive_type(msg_t *msg, uint16_t type_mask, uint32_t timeout)
+{
+    return (*static_cast<Msg *>(msg)).receive_type(type_mask, timeout);
+}
+
+int msg_receive_batch(msg_t *msgs, unsigned max, int blocking)
+{
+    return Msg::receive_batch(static_cast<Msg *>(msgs), max, blocking);
+}
+
+int msg_send_batch(msg_t *msgs, unsigned count, kernel_pid_t pid)
+{
+    return Msg::send_batch(static_cast<Msg *>(msgs), count, pid);
+}
+
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+void *msgbuf_alloc(size_t size)
+{
+    /* one allocated in an isr belongs to nobody until it is sent */
+    kernel_pid_t owner = cpu_is_in_isr() ? KERNEL_PID_UNDEF : sched_active_pid;
+
+    return ThreadScheduler::get().get_msgbuf_pool().alloc(size, owner);
+}
+
+void msgbuf_retain(void *buf)
+{
+    ThreadScheduler::get().get_msgbuf_pool().retain(buf);
+}
+
+void msgbuf_release(void *buf)
+{
+    kernel_pid_t caller = cpu_is_in_isr() ? KERNEL_PID_UNDEF : sched_active_pid;
+
+    ThreadScheduler::get().get_msgbuf_pool().release(buf, caller);
+}
+
+int msgbuf_send(msg_t *msg, void *buf, kernel_pid_t pid)
+{
+    return (*static_cast<Msg *>(msg)).send_buf(buf, pid);
+}
+
+kernel_pid_t msgbuf_get_owner(void *buf)
+{
+    return ThreadScheduler::get().get_msgbuf_pool().get_owner(buf);
+}
+
+unsigned msgbuf_get_numof_free(void)
+{
+    return ThreadScheduler::get().get_msgbuf_pool().get_numof_free();
+}
+
+unsigned msgbuf_get_leaks(void)
+{
+    return ThreadScheduler::get().get_msgbuf_pool().get_leaks();
+}
+#endif
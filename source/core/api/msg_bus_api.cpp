@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <vcrtos/msg_bus.h>
+
+#include "core/msg_bus.hpp"
+#include "core/new.hpp"
+#include "core/thread.hpp"
+
+using namespace vc;
+
+void msg_bus_init(msg_bus_t *bus, uint16_t id)
+{
+    bus = new (bus) MsgBus(id);
+}
+
+void msg_bus_attach(msg_bus_t *bus, msg_bus_entry_t *entry)
+{
+    (*static_cast<MsgBus *>(bus)).attach(static_cast<MsgBusEntry *>(entry), sched_active_pid);
+}
+
+void msg_bus_detach(msg_bus_t *bus, msg_bus_entry_t *entry)
+{
+    (*static_cast<MsgBus *>(bus)).detach(static_cast<MsgBusEntry *>(entry));
+}
+
+void msg_bus_subscribe(msg_bus_entry_t *entry, uint8_t type)
+{
+    (*static_cast<MsgBusEntry *>(entry)).subscribe(type);
+}
+
+void msg_bus_unsubscribe(msg_bus_entry_t *entry, uint8_t type)
+{
+    (*static_cast<MsgBusEntry *>(entry)).unsubscribe(type);
+}
+
+int msg_bus_post(msg_bus_t *bus, uint8_t type, void *arg)
+{
+    return (*static_cast<MsgBus *>(bus)).post(type, arg);
+}
@@ -26,7 +26,7 @@ kernel_pid_t thread_create(char *stack,
                            int size,
                            thread_handler_func_t func,
                            const char *name,
-                           char priority,
+                           uint8_t priority,
                            void *arg,
                            int flags)
 {
@@ -74,6 +74,107 @@ void thread_scheduler_switch(uint8_t priority)
     scheduler->context_switch(priority);
 }
 
+thread_handle_t thread_get_handle(kernel_pid_t pid)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_handle(pid);
+}
+
+kernel_pid_t thread_handle_get_pid(thread_handle_t handle)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_pid_from_handle(handle);
+}
+
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+kernel_pid_t thread_spawn(thread_handler_func_t func, void *arg, thread_stack_class_t stack_class, uint8_t priority,
+                          int flags)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->spawn(func, arg, stack_class, priority, flags);
+}
+
+int thread_join(kernel_pid_t pid, void **result)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->join(pid, result);
+}
+
+int thread_detach(kernel_pid_t pid)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->detach(pid);
+}
+#endif
+
+#if VCRTOS_CONFIG_EDF_ENABLE
+int thread_edf_set_deadline(kernel_pid_t pid, uint32_t deadline)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->set_deadline(pid, deadline);
+}
+
+int thread_edf_renew_deadline(uint32_t relative_deadline)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->renew_deadline(relative_deadline);
+}
+
+uint32_t thread_edf_get_deadline_misses(kernel_pid_t pid)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_deadline_misses(pid);
+}
+#endif
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+int thread_budget_group_init(uint8_t group, uint32_t budget, uint32_t period, uint8_t background_priority)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->budget_group_init(group, budget, period, background_priority);
+}
+
+int thread_budget_group_join(kernel_pid_t pid, uint8_t group)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->budget_group_join(pid, group);
+}
+
+uint32_t thread_budget_group_get_throttles(uint8_t group)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->budget_group_get_throttles(group);
+}
+
+void thread_scheduler_budget_expired()
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    scheduler->budget_expired();
+}
+#endif
+
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+void thread_scheduler_set_time_slice(uint8_t priority, uint32_t ticks)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    scheduler->set_time_slice(priority, ticks);
+}
+
+void thread_scheduler_time_slice_expired()
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    scheduler->time_slice_expired();
+}
+#endif
+
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+void thread_scheduler_msg_timeout_expired()
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    scheduler->msg_timeout_expired();
+}
+#endif
+
 void thread_exit()
 {
     ThreadScheduler *scheduler = &ThreadScheduler::get();
@@ -138,16 +239,49 @@ const char *thread_status_to_string(thread_status_t status)
 
 uintptr_t thread_measure_stack_free(char *stack)
 {
-    uintptr_t *stackp = (uintptr_t *)stack;
-    /* assume that the comparison fails before or after end of stack */
-    /* assume that the stack grows "downwards" */
-    while (*stackp == (uintptr_t)stackp)
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->measure_stack_free(stack);
+}
+
+uintptr_t thread_measure_stack_free_bounded(char *stack, size_t size)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->measure_stack_free(stack, size);
+}
+
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+void thread_stack_monitor_sample()
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    scheduler->stack_monitor_sample();
+}
+
+static void *stack_monitor_handler(void *arg)
+{
+    (void)arg;
+
+    /* one pass per thread_wakeup(), e.g. from a periodic timer */
+    for (;;)
     {
-        stackp++;
+        thread_stack_monitor_sample();
+        thread_sleep();
     }
-    uintptr_t space_free = (uintptr_t)stackp - (uintptr_t)stack;
-    return space_free;
+
+    return nullptr;
+}
+
+kernel_pid_t thread_stack_monitor_start(char *stack, int size, uint8_t priority)
+{
+    return thread_create(stack, size, stack_monitor_handler, "stackmon", priority, nullptr,
+                         THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_STACKMARKER);
+}
+
+int thread_get_stack_peak(kernel_pid_t pid)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_stack_peak(pid);
 }
+#endif
 
 uint32_t thread_get_schedules_stat(kernel_pid_t pid)
 {
@@ -155,6 +289,26 @@ uint32_t thread_get_schedules_stat(kernel_pid_t pid)
     return scheduler->get_thread_schedules_stat(pid);
 }
 
+int thread_get_snapshot(thread_snapshot_t *snapshot, int size)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_snapshot(snapshot, size);
+}
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+int thread_set_affinity(kernel_pid_t pid, thread_affinity_t affinity)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->set_thread_affinity(pid, affinity);
+}
+
+thread_affinity_t thread_get_affinity(kernel_pid_t pid)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    return scheduler->get_thread_affinity(pid);
+}
+#endif
+
 void thread_add_to_list(list_node_t *list, thread_t *thread)
 {
     uint16_t my_prio = thread->priority;
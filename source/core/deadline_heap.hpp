@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CORE_DEADLINE_HEAP_HPP
+#define CORE_DEADLINE_HEAP_HPP
+
+#include <stdint.h>
+
+#include <vcrtos/assert.h>
+#include <vcrtos/kernel.h>
+
+namespace vc {
+
+/* binary min heap ordered by absolute deadline, every entry keeps its own
+ * slot so removal needs no search. T has a uint32_t deadline and an int16_t
+ * deadline_slot (-1 when not in the heap), at most one per thread: the ready
+ * EDF threads, or the timed msg_receive_type() waits */
+template <typename T>
+class DeadlineHeap
+{
+public:
+    DeadlineHeap() : size(0) {}
+
+    T *top() { return (size != 0) ? heap[0] : nullptr; }
+    unsigned get_size() { return size; }
+
+    void insert(T *entry)
+    {
+        vcassert(size < KERNEL_MAXTHREADS);
+        place(size++, entry);
+        sift_up(entry->deadline_slot);
+    }
+
+    void remove(T *entry)
+    {
+        unsigned index = entry->deadline_slot;
+
+        vcassert(index < size && heap[index] == entry);
+        entry->deadline_slot = -1;
+
+        if (index == --size)
+            return;
+
+        /* the last one fills the hole and moves to wherever it belongs */
+        place(index, heap[size]);
+        sift_up(index);
+        sift_down(heap[index]->deadline_slot);
+    }
+
+    /* deadlines are compared as distances so the tick counter may wrap */
+    static bool earlier(T *a, T *b) { return (int32_t)(a->deadline - b->deadline) < 0; }
+
+private:
+    void place(unsigned index, T *entry)
+    {
+        heap[index] = entry;
+        entry->deadline_slot = (int16_t)index;
+    }
+
+    void sift_up(unsigned index)
+    {
+        while (index > 0)
+        {
+            unsigned parent = (index - 1) / 2;
+
+            if (!earlier(heap[index], heap[parent]))
+                break;
+
+            T *tmp = heap[parent];
+            place(parent, heap[index]);
+            place(index, tmp);
+            index = parent;
+        }
+    }
+
+    void sift_down(unsigned index)
+    {
+        for (;;)
+        {
+            unsigned child = 2 * index + 1;
+
+            if (child >= size)
+                break;
+
+            if (child + 1 < size && earlier(heap[child + 1], heap[child]))
+                child++;
+
+            if (!earlier(heap[child], heap[index]))
+                break;
+
+            T *tmp = heap[child];
+            place(child, heap[index]);
+            place(index, tmp);
+            index = child;
+        }
+    }
+
+    T *heap[KERNEL_MAXTHREADS];
+    unsigned size;
+};
+
+} // namespace vc
+
+#endif /* CORE_DEADLINE_HEAP_HPP */
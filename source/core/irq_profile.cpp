@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include <vcrtos/config.h>
+#include <vcrtos/cpu.h>
+#include <vcrtos/irq_profile.h>
+
+#if VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
+
+enum
+{
+    IRQ_PROFILE_SITES = VCRTOS_CONFIG_IRQ_PROFILE_SITES,
+    IRQ_PROFILE_HISTOGRAM_SIZE = VCRTOS_CONFIG_IRQ_PROFILE_HISTOGRAM_SIZE,
+};
+
+static irq_profile_site_t irq_profile_sites[IRQ_PROFILE_SITES];
+static uint32_t irq_profile_overflow;
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+/* the kernel lock also serializes the site table between cores */
+#define IRQ_PROFILE_LOCK() smp_irq_disable()
+#define IRQ_PROFILE_UNLOCK(state) smp_irq_restore(state)
+#define IRQ_PROFILE_CPU (irq_profile_cpus[cpu_core_id()])
+#else
+#define IRQ_PROFILE_LOCK() (cpu_irq_disable)()
+#define IRQ_PROFILE_UNLOCK(state) (cpu_irq_restore)(state)
+#define IRQ_PROFILE_CPU (irq_profile_cpus[0])
+#endif
+
+/* the masking state belongs to the cpu, which is the host thread when
+ * several kernel instances run in one process */
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+#define IRQ_PROFILE_CPU_LOCAL thread_local
+#else
+#define IRQ_PROFILE_CPU_LOCAL
+#endif
+
+/* only the outermost section of a nested disable/restore is timed, the time
+ * is charged to the call site that masked interrupts first */
+typedef struct
+{
+    unsigned depth;
+    uint32_t start;
+    const char *file;
+    uint32_t line;
+} irq_profile_cpu_t;
+
+static IRQ_PROFILE_CPU_LOCAL irq_profile_cpu_t irq_profile_cpus[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+
+static irq_profile_site_t *irq_profile_find_site(const char *file, uint32_t line)
+{
+    /* open addressing on the call site, probed with interrupts masked so the
+     * table stays small and the probe sequence short */
+    uint32_t hash = (static_cast<uint32_t>(reinterpret_cast<uintptr_t>(file)) >> 2) ^ (line * 2654435761u);
+
+    for (unsigned i = 0; i < IRQ_PROFILE_SITES; i++)
+    {
+        irq_profile_site_t *site = &irq_profile_sites[(hash + i) % IRQ_PROFILE_SITES];
+
+        if (site->file == file && site->line == line)
+            return site;
+
+        if (site->file == NULL)
+        {
+            site->file = file;
+            site->line = line;
+            return site;
+        }
+    }
+
+    return NULL;
+}
+
+static unsigned irq_profile_bucket(uint32_t ticks)
+{
+    unsigned bucket = 0;
+
+    while (ticks > 1 && bucket < IRQ_PROFILE_HISTOGRAM_SIZE - 1)
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+unsigned irq_profile_disable(const char *file, uint32_t line)
+{
+    unsigned state = IRQ_PROFILE_LOCK();
+    irq_profile_cpu_t *cpu = &IRQ_PROFILE_CPU;
+
+    if (cpu->depth++ == 0)
+    {
+        cpu->file = file;
+        cpu->line = line;
+        cpu->start = cpu_get_timestamp();
+    }
+
+    return state;
+}
+
+void irq_profile_restore(unsigned state)
+{
+    irq_profile_cpu_t *cpu = &IRQ_PROFILE_CPU;
+
+    if (cpu->depth > 0 && --cpu->depth == 0)
+    {
+        uint32_t ticks = cpu_get_timestamp() - cpu->start;
+        irq_profile_site_t *site = irq_profile_find_site(cpu->file, cpu->line);
+
+        if (site != NULL)
+        {
+            site->count++;
+            site->total_ticks += ticks;
+            site->histogram[irq_profile_bucket(ticks)]++;
+
+            if (ticks > site->max_ticks)
+            {
+                site->max_ticks = ticks;
+            }
+        }
+        else
+        {
+            irq_profile_overflow++;
+        }
+    }
+
+    IRQ_PROFILE_UNLOCK(state);
+}
+
+void irq_profile_reset()
+{
+    unsigned state = IRQ_PROFILE_LOCK();
+
+    memset(irq_profile_sites, 0, sizeof(irq_profile_sites));
+    irq_profile_overflow = 0;
+
+    IRQ_PROFILE_UNLOCK(state);
+}
+
+int irq_profile_get_worst(irq_profile_site_t *sites, int size)
+{
+    int count = 0;
+
+    for (unsigned i = 0; i < IRQ_PROFILE_SITES; i++)
+    {
+        irq_profile_site_t site;
+
+        /* copy one site at a time to keep interrupts masked only briefly */
+        unsigned state = IRQ_PROFILE_LOCK();
+        site = irq_profile_sites[i];
+        IRQ_PROFILE_UNLOCK(state);
+
+        if (site.file == NULL)
+            continue;
+
+        int j = (count < size) ? count++ : size;
+
+        /* insertion sort on the worst case duration */
+        while (j > 0 && sites[j - 1].max_ticks < site.max_ticks)
+        {
+            if (j < size)
+            {
+                sites[j] = sites[j - 1];
+            }
+            j--;
+        }
+
+        if (j < size)
+        {
+            sites[j] = site;
+        }
+    }
+
+    return count;
+}
+
+uint32_t irq_profile_get_overflow()
+{
+    return irq_profile_overflow;
+}
+
+#endif // #if VCRTOS_CONFIG_IRQ_PROFILE_ENABLE
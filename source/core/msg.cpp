@@ -15,6 +15,8 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <vcrtos/trace.h>
+
 #include "core/thread.hpp"
 #include "core/msg.hpp"
 
@@ -31,11 +33,21 @@ int Msg::send(kernel_pid_t target_pid, int blocking, unsigned irqmask)
         return -1;
     }
 
+    VCRTOS_TRACE(TRACE_EVENT_MSG_SEND, sender_pid, target_pid);
+
     Thread *current_thread = (Thread *)sched_active_thread;
-    if (target_thread->status != THREAD_STATUS_RECEIVE_BLOCKED)
+    if (!target_thread->is_receiving(this))
     {
         if (target_thread->queued_msg(this))
         {
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+            /* the reply comes from the target, it runs on our behalf */
+            if (current_thread->status == THREAD_STATUS_REPLY_BLOCKED)
+            {
+                scheduler->inherit_priority(current_thread, target_thread);
+                scheduler->add_ipc_client(current_thread);
+            }
+#endif
             cpu_irq_restore(irqmask);
             if (current_thread->status == THREAD_STATUS_REPLY_BLOCKED)
                 ThreadScheduler::yield_higher_priority_thread();
@@ -59,6 +71,9 @@ int Msg::send(kernel_pid_t target_pid, int blocking, unsigned irqmask)
         }
         scheduler->set_thread_status(current_thread, new_status);
         current_thread->add_to_list(static_cast<List *>(&target_thread->msg_waiters));
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        scheduler->inherit_priority(current_thread, target_thread);
+#endif
         cpu_irq_restore(irqmask);
         ThreadScheduler::yield_higher_priority_thread();
     }
@@ -66,13 +81,32 @@ int Msg::send(kernel_pid_t target_pid, int blocking, unsigned irqmask)
     {
         Msg *target_msg = static_cast<Msg *>(target_thread->wait_data);
         *target_msg = *this;
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, target_pid, sender_pid);
         scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        if (current_thread->status == THREAD_STATUS_REPLY_BLOCKED)
+        {
+            scheduler->inherit_priority(current_thread, target_thread);
+            scheduler->add_ipc_client(current_thread);
+        }
+#endif
+        scheduler->set_handoff(target_thread);
         cpu_irq_restore(irqmask);
         ThreadScheduler::yield_higher_priority_thread();
     }
     return 1;
 }
 
+void Msg::block_receive(Thread *thread, uint16_t type_mask)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+
+    thread->wait_data = static_cast<void *>(this);
+    /* senders hand over what passes the filter and queue the rest */
+    thread->msg_type_mask = type_mask;
+    scheduler->set_thread_status(thread, THREAD_STATUS_RECEIVE_BLOCKED);
+}
+
 int Msg::receive(int blocking)
 {
     unsigned irqmask = cpu_irq_disable();
@@ -100,6 +134,7 @@ int Msg::receive(int blocking)
     if (queue_index >= 0)
     {
         *this = *static_cast<Msg *>(&current_thread->msg_array[queue_index]);
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, current_thread->pid, sender_pid);
         cpu_irq_restore(irqmask);
         return 1;
     }
@@ -114,7 +149,7 @@ int Msg::receive(int blocking)
     {
         if (queue_index < 0)
         {
-            scheduler->set_thread_status(current_thread, THREAD_STATUS_RECEIVE_BLOCKED);
+            block_receive(current_thread, 0);
             cpu_irq_restore(irqmask);
             ThreadScheduler::yield_higher_priority_thread();
         }
@@ -149,14 +184,26 @@ int Msg::receive(int blocking)
             *this = *sender_msg;
         }
 
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, current_thread->pid, sender_pid);
+
         /* remove sender from queue */
         uint8_t sender_priority = KERNEL_THREAD_PRIORITY_IDLE;
         if (sender_thread->get_status() != THREAD_STATUS_REPLY_BLOCKED)
         {
             sender_thread->wait_data = nullptr;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+            /* a REPLY_BLOCKED sender keeps lending until the reply */
+            scheduler->release_priority(sender_thread);
+#endif
             scheduler->set_thread_status(sender_thread, THREAD_STATUS_PENDING);
             sender_priority = sender_thread->get_priority();
         }
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        else
+        {
+            scheduler->add_ipc_client(sender_thread);
+        }
+#endif
 
         cpu_irq_restore(irqmask);
 
@@ -167,6 +214,280 @@ int Msg::receive(int blocking)
     }
 }
 
+int Msg::receive_type(uint16_t type_mask, uint32_t timeout)
+{
+    unsigned irqmask = cpu_irq_disable();
+
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    Thread *current_thread = (Thread *)sched_active_thread;
+
+    bool timed = (timeout != 0 && timeout != MSG_TIMEOUT_FOREVER);
+
+    /* a finite wait needs the timer, it is refused before anything is taken */
+    if (current_thread == nullptr || !current_thread->has_msg_queue() ||
+        (timed && !VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE))
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    Cib *queue = static_cast<Cib *>(&current_thread->msg_queue);
+    List *waiters = static_cast<List *>(&current_thread->msg_waiters);
+    msg_t *array = current_thread->msg_array;
+    unsigned read = queue->get_read_count();
+    unsigned mask = queue->get_mask();
+    Thread *sender_thread = nullptr;
+    bool found = false;
+
+    /* a linear scan, queued messages are older than the ones of blocked
+     * senders */
+    for (unsigned i = 0; i < queue->avail(); i++)
+    {
+        if (((array[(read + i) & mask].type ^ type) & type_mask) != 0)
+            continue;
+
+        *this = *static_cast<Msg *>(&array[(read + i) & mask]);
+
+        /* the older ones move up by one and keep their order */
+        for (; i > 0; i--)
+            array[(read + i) & mask] = array[(read + i - 1) & mask];
+
+        queue->get();
+        found = true;
+
+        /* a blocked sender takes the freed space like in receive() */
+        List *next = waiters->remove_head();
+
+        if (next != nullptr)
+        {
+            sender_thread = Thread::get_thread_pointer_from_list_member(next);
+            current_thread->queued_msg(static_cast<Msg *>(sender_thread->wait_data));
+        }
+        break;
+    }
+
+    for (List *prev = waiters; !found && prev->next != nullptr; prev = static_cast<List *>(prev->next))
+    {
+        Thread *thread = Thread::get_thread_pointer_from_list_member(static_cast<List *>(prev->next));
+        Msg *sender_msg = static_cast<Msg *>(thread->wait_data);
+
+        if (((sender_msg->type ^ type) & type_mask) != 0)
+            continue;
+
+        prev->next = prev->next->next;
+        *this = *sender_msg;
+        sender_thread = thread;
+        found = true;
+        break;
+    }
+
+    if (found)
+    {
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, current_thread->pid, sender_pid);
+
+        uint8_t sender_priority = KERNEL_THREAD_PRIORITY_IDLE;
+
+        if (sender_thread != nullptr && sender_thread->get_status() != THREAD_STATUS_REPLY_BLOCKED)
+        {
+            sender_thread->wait_data = nullptr;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+            scheduler->release_priority(sender_thread);
+#endif
+            scheduler->set_thread_status(sender_thread, THREAD_STATUS_PENDING);
+            sender_priority = sender_thread->get_priority();
+        }
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        else if (sender_thread != nullptr)
+        {
+            scheduler->add_ipc_client(sender_thread);
+        }
+#endif
+
+        cpu_irq_restore(irqmask);
+
+        if (sender_priority < KERNEL_THREAD_PRIORITY_IDLE)
+            scheduler->context_switch(sender_priority);
+
+        return 1;
+    }
+
+    if (timeout == 0)
+    {
+        cpu_irq_restore(irqmask);
+        return 0;
+    }
+
+    block_receive(current_thread, type_mask);
+
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+    if (timed)
+        scheduler->msg_timeout_start(current_thread, timeout);
+#endif
+
+    cpu_irq_restore(irqmask);
+    ThreadScheduler::yield_higher_priority_thread();
+
+    /* an expired timeout takes wait_data away */
+    return (current_thread->wait_data != nullptr) ? 1 : 0;
+}
+
+int Msg::receive_batch(Msg *msgs, unsigned max, int blocking)
+{
+    unsigned irqmask = cpu_irq_disable();
+
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    Thread *current_thread = (Thread *)sched_active_thread;
+
+    if (current_thread == nullptr || !current_thread->has_msg_queue())
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    Cib *queue = static_cast<Cib *>(&current_thread->msg_queue);
+    List *waiters = static_cast<List *>(&current_thread->msg_waiters);
+    unsigned count = 0;
+    int index;
+
+    /* queued messages were sent before the ones of the blocked senders */
+    while (count < max && (index = queue->get()) >= 0)
+    {
+        msgs[count] = *static_cast<Msg *>(&current_thread->msg_array[index]);
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, current_thread->pid, msgs[count].sender_pid);
+        count++;
+    }
+
+    uint8_t sender_priority = KERNEL_THREAD_PRIORITY_IDLE;
+    List *next;
+
+    /* once max is reached the senders move into the freed queue space like
+     * receive() does, all of them are woken with one switch */
+    while ((count < max || !queue->full()) && (next = waiters->remove_head()) != nullptr)
+    {
+        Thread *sender_thread = Thread::get_thread_pointer_from_list_member(next);
+        Msg *sender_msg = static_cast<Msg *>(sender_thread->wait_data);
+
+        if (count < max)
+        {
+            msgs[count++] = *sender_msg;
+            VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, current_thread->pid, sender_msg->sender_pid);
+        }
+        else
+        {
+            current_thread->queued_msg(sender_msg);
+        }
+
+        if (sender_thread->get_status() != THREAD_STATUS_REPLY_BLOCKED)
+        {
+            sender_thread->wait_data = nullptr;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+            scheduler->release_priority(sender_thread);
+#endif
+            scheduler->set_thread_status(sender_thread, THREAD_STATUS_PENDING);
+            if (sender_thread->get_priority() < sender_priority)
+                sender_priority = sender_thread->get_priority();
+        }
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        else
+        {
+            scheduler->add_ipc_client(sender_thread);
+        }
+#endif
+    }
+
+    if (count == 0)
+    {
+        if (!blocking || max == 0)
+        {
+            cpu_irq_restore(irqmask);
+            return 0;
+        }
+
+        /* the first message to arrive is delivered straight into msgs[0] */
+        msgs[0].block_receive(current_thread, 0);
+        cpu_irq_restore(irqmask);
+        ThreadScheduler::yield_higher_priority_thread();
+        return 1;
+    }
+
+    cpu_irq_restore(irqmask);
+
+    if (sender_priority < KERNEL_THREAD_PRIORITY_IDLE)
+        scheduler->context_switch(sender_priority);
+
+    return static_cast<int>(count);
+}
+
+int Msg::send_batch(Msg *msgs, unsigned count, kernel_pid_t target_pid)
+{
+    unsigned irqmask = cpu_irq_disable();
+
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    Thread *target_thread = scheduler->get_thread_from_container(target_pid);
+
+    if (target_thread == nullptr || !target_thread->has_msg_queue())
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    kernel_pid_t source_pid = cpu_is_in_isr() ? KERNEL_PID_ISR : sched_active_pid;
+    unsigned sent = 0;
+    bool woken = false;
+
+    /* the first message a blocked receiver waits for is handed over, the
+     * rest is queued and what does not fit is left to the caller */
+    for (; sent < count; sent++)
+    {
+        msgs[sent].sender_pid = source_pid;
+
+        if (target_thread->is_receiving(&msgs[sent]))
+        {
+            *static_cast<Msg *>(target_thread->wait_data) = msgs[sent];
+            VCRTOS_TRACE(TRACE_EVENT_MSG_SEND, source_pid, target_pid);
+            VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, target_pid, source_pid);
+            scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
+            woken = true;
+            continue;
+        }
+
+        if (!target_thread->queued_msg(&msgs[sent]))
+            break;
+        VCRTOS_TRACE(TRACE_EVENT_MSG_SEND, source_pid, target_pid);
+    }
+
+    cpu_irq_restore(irqmask);
+
+    if (woken)
+    {
+        if (cpu_is_in_isr())
+            scheduler->request_context_switch();
+        else
+            scheduler->context_switch(target_thread->priority);
+    }
+
+    return static_cast<int>(sent);
+}
+
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+int Msg::send_buf(void *buf, kernel_pid_t target_pid)
+{
+    MsgBufPool &pool = ThreadScheduler::get().get_msgbuf_pool();
+    kernel_pid_t owner = pool.get_owner(buf);
+
+    /* handed over before the send, the target may pass it on right away */
+    content.ptr = buf;
+    pool.set_owner(buf, target_pid);
+
+    int result = send(target_pid);
+
+    if (result != 1)
+        pool.set_owner(buf, owner);
+
+    return result;
+}
+#endif
+
 int Msg::send(kernel_pid_t target_pid)
 {
     if (cpu_is_in_isr())
@@ -214,10 +535,13 @@ int Msg::send_in_isr(kernel_pid_t target_pid)
 
     sender_pid = KERNEL_PID_ISR;
 
-    if (target_thread->status == THREAD_STATUS_RECEIVE_BLOCKED)
+    VCRTOS_TRACE(TRACE_EVENT_MSG_SEND, sender_pid, target_pid);
+
+    if (target_thread->is_receiving(this))
     {
         Msg *target_msg = static_cast<Msg *>(target_thread->wait_data);
         *target_msg = *this;
+        VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, target_pid, sender_pid);
         scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
         scheduler->request_context_switch();
         return 1;
@@ -236,13 +560,23 @@ int Msg::send_receive(Msg *reply_msg, kernel_pid_t target_pid)
     Thread *current_thread = (Thread *)sched_active_thread;
 
     if (current_thread->pid == target_pid || !current_thread->has_msg_queue())
+    {
+        cpu_irq_restore(irqmask);
         return -1;
+    }
 
     scheduler->set_thread_status(current_thread, THREAD_STATUS_REPLY_BLOCKED);
     current_thread->wait_data = static_cast<void *>(reply_msg);
 
+    /* fast path: the server is waiting, the request is copied straight into
+     * its buffer and the core is handed to it */
+    Thread *target_thread = scheduler->get_thread_from_container(target_pid);
+
+    if (target_thread != nullptr && target_thread->is_receiving(this))
+        return send(target_pid, 1 /* blocking */, irqmask);
+
     /* we re-use (abuse) reply for sending, because wait_data might be
-     * overwritten if the target is not in RECEIVE_BLOCKED */
+     * overwritten if the target is not waiting for it */
 
     *reply_msg = *this;
 
@@ -267,12 +601,59 @@ int Msg::reply(Msg *reply_msg)
 
     Msg *target_msg = static_cast<Msg *>(target_thread->wait_data);
     *target_msg = *reply_msg;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    scheduler->release_priority(target_thread);
+#endif
     scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
+    scheduler->set_handoff(target_thread);
     cpu_irq_restore(irqmask);
     scheduler->context_switch(target_thread->priority);
     return 1;
 }
 
+int Msg::reply_and_receive(Msg *reply_msg)
+{
+    unsigned irqmask = cpu_irq_disable();
+
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    Thread *current_thread = (Thread *)sched_active_thread;
+    Thread *target_thread = scheduler->get_thread_from_container(sender_pid);
+
+    if (!current_thread->has_msg_queue() ||
+        target_thread == nullptr ||
+        !target_thread->has_msg_queue() ||
+        target_thread->status != THREAD_STATUS_REPLY_BLOCKED)
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    Msg *target_msg = static_cast<Msg *>(target_thread->wait_data);
+    *target_msg = *reply_msg;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    scheduler->release_priority(target_thread);
+#endif
+    scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
+
+    if (current_thread->msg_waiters.next == nullptr && current_thread->numof_msg_in_queue() == 0)
+    {
+        /* nothing else to serve: block right away, one switch takes the
+         * reply to the client instead of a second one into receive() */
+        block_receive(current_thread, 0);
+        scheduler->set_handoff(target_thread);
+        cpu_irq_restore(irqmask);
+        ThreadScheduler::yield_higher_priority_thread();
+        return 1;
+    }
+
+    /* a request is queued already, it is taken without blocking, only
+     * messages are added in between */
+    cpu_irq_restore(irqmask);
+    int result = receive(0 /* non-blocking */);
+    scheduler->context_switch(target_thread->priority);
+    return result;
+}
+
 int Msg::reply_in_isr(Msg *reply_msg)
 {
     ThreadScheduler *scheduler = &ThreadScheduler::get();
@@ -287,6 +668,9 @@ int Msg::reply_in_isr(Msg *reply_msg)
 
     Msg *target_msg = static_cast<Msg *>(target_thread->wait_data);
     *target_msg = *reply_msg;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    scheduler->release_priority(target_thread);
+#endif
     scheduler->set_thread_status(target_thread, THREAD_STATUS_PENDING);
     scheduler->request_context_switch();
     return 1;
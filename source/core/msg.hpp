@@ -52,9 +52,17 @@ public:
     int try_receive() { return receive(0); }
     int send_receive(Msg *reply, kernel_pid_t target_pid);
     int reply(Msg *reply);
+    int reply_and_receive(Msg *reply);
     int reply_in_isr(Msg *reply);
+    int receive_type(uint16_t type_mask, uint32_t timeout);
+    static int receive_batch(Msg *msgs, unsigned max, int blocking);
+    static int send_batch(Msg *msgs, unsigned count, kernel_pid_t target_pid);
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+    int send_buf(void *buf, kernel_pid_t target_pid);
+#endif
 
 private:
+    void block_receive(Thread *thread, uint16_t type_mask);
     int send(kernel_pid_t target_pid, int blocking, unsigned state);
     int receive(int blocking);
 };
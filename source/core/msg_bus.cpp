@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/trace.h>
+
+#include "core/thread.hpp"
+#include "core/msg_bus.hpp"
+
+namespace vc {
+
+void MsgBusEntry::subscribe(uint8_t type)
+{
+    vcassert(type < MSG_BUS_NUMOF_TYPES);
+
+    unsigned irqmask = cpu_irq_disable();
+    event_mask |= (1UL << type);
+    cpu_irq_restore(irqmask);
+}
+
+void MsgBusEntry::unsubscribe(uint8_t type)
+{
+    vcassert(type < MSG_BUS_NUMOF_TYPES);
+
+    unsigned irqmask = cpu_irq_disable();
+    event_mask &= ~(1UL << type);
+    cpu_irq_restore(irqmask);
+}
+
+void MsgBus::attach(MsgBusEntry *entry, kernel_pid_t pid)
+{
+    entry->event_mask = 0;
+    entry->pid = pid;
+    entry->drops = 0;
+
+    unsigned irqmask = cpu_irq_disable();
+    static_cast<List *>(&subs)->add(static_cast<List *>(&entry->next));
+    cpu_irq_restore(irqmask);
+}
+
+void MsgBus::detach(MsgBusEntry *entry)
+{
+    unsigned irqmask = cpu_irq_disable();
+    List::remove(static_cast<List *>(&subs), static_cast<List *>(&entry->next));
+    cpu_irq_restore(irqmask);
+}
+
+int MsgBus::post(uint8_t type, void *arg)
+{
+    vcassert(type < MSG_BUS_NUMOF_TYPES);
+
+    unsigned irqmask = cpu_irq_disable();
+
+    ThreadScheduler *scheduler = &ThreadScheduler::get();
+    Msg msg;
+
+    msg.sender_pid = cpu_is_in_isr() ? KERNEL_PID_ISR : sched_active_pid;
+    msg.type = static_cast<uint16_t>((id << 5) | type);
+    msg.content.ptr = arg;
+
+    uint32_t mask = 1UL << type;
+    uint8_t wakeup_priority = KERNEL_THREAD_PRIORITY_IDLE;
+    int count = 0;
+
+    for (list_node_t *node = subs.next; node != nullptr; node = node->next)
+    {
+        MsgBusEntry *entry = reinterpret_cast<MsgBusEntry *>(node);
+
+        if (!(entry->event_mask & mask))
+            continue;
+
+        Thread *thread = scheduler->get_thread_from_container(entry->pid);
+
+        if (thread == nullptr || !thread->has_msg_queue())
+        {
+            entry->drops++;
+            continue;
+        }
+
+        VCRTOS_TRACE(TRACE_EVENT_MSG_SEND, msg.sender_pid, entry->pid);
+
+        if (thread->is_receiving(&msg))
+        {
+            *static_cast<Msg *>(thread->wait_data) = msg;
+            VCRTOS_TRACE(TRACE_EVENT_MSG_RECV, entry->pid, msg.sender_pid);
+            scheduler->set_thread_status(thread, THREAD_STATUS_PENDING);
+            if (thread->priority < wakeup_priority)
+                wakeup_priority = thread->priority;
+        }
+        else if (!thread->queued_msg(&msg))
+        {
+            entry->drops++;
+            continue;
+        }
+
+        count++;
+    }
+
+    cpu_irq_restore(irqmask);
+
+    /* one decision for all the threads woken */
+    if (wakeup_priority < KERNEL_THREAD_PRIORITY_IDLE)
+    {
+        if (cpu_is_in_isr())
+            scheduler->request_context_switch();
+        else
+            scheduler->context_switch(wakeup_priority);
+    }
+
+    return count;
+}
+
+} // namespace vc
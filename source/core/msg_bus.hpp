@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CORE_MSG_BUS_HPP
+#define CORE_MSG_BUS_HPP
+
+#include <stdint.h>
+
+#include <vcrtos/assert.h>
+#include <vcrtos/config.h>
+#include <vcrtos/msg_bus.h>
+
+#include "core/list.hpp"
+
+namespace vc {
+
+class MsgBusEntry : public msg_bus_entry_t
+{
+public:
+    MsgBusEntry()
+    {
+        this->next.next = nullptr;
+        this->event_mask = 0;
+        this->pid = KERNEL_PID_UNDEF;
+        this->drops = 0;
+    }
+
+    void subscribe(uint8_t type);
+    void unsubscribe(uint8_t type);
+};
+
+class MsgBus : public msg_bus_t
+{
+public:
+    explicit MsgBus(uint16_t id)
+    {
+        vcassert(id <= MSG_BUS_ID_MAX);
+        this->subs.next = nullptr;
+        this->id = id;
+    }
+
+    void attach(MsgBusEntry *entry, kernel_pid_t pid);
+    void detach(MsgBusEntry *entry);
+    int post(uint8_t type, void *arg);
+};
+
+} // namespace vc
+
+#endif /* CORE_MSG_BUS_HPP */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CORE_MSGBUF_POOL_HPP
+#define CORE_MSGBUF_POOL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vcrtos/assert.h>
+#include <vcrtos/config.h>
+#include <vcrtos/cpu.h>
+#include <vcrtos/kernel.h>
+
+namespace vc {
+
+/* Fixed size, reference counted message payloads. A buffer travels in
+ * msg_t.content.ptr and is owned by the thread it was last sent to until
+ * that thread releases it. The reference of an owner that is gone is dropped
+ * for it and counted as a leak. References taken with retain() are not
+ * tracked. */
+class MsgBufPool
+{
+public:
+    MsgBufPool() : free_list(nullptr), numof_free(0), leaks(0)
+    {
+        for (unsigned i = VCRTOS_CONFIG_MSGBUF_NUMOF; i > 0; i--)
+            put(&blocks[i - 1]);
+    }
+
+    void *alloc(size_t size, kernel_pid_t owner)
+    {
+        if (size > VCRTOS_CONFIG_MSGBUF_SIZE)
+            return nullptr;
+
+        unsigned irqmask = cpu_irq_disable();
+        Block *block = free_list;
+
+        if (block != nullptr)
+        {
+            free_list = block->next_free;
+            numof_free--;
+            block->owner = owner;
+            block->refs = 1;
+        }
+
+        cpu_irq_restore(irqmask);
+
+        return (block != nullptr) ? block->data : nullptr;
+    }
+
+    void retain(void *data)
+    {
+        unsigned irqmask = cpu_irq_disable();
+        Block *block = block_of(data);
+        block->refs++;
+        cpu_irq_restore(irqmask);
+    }
+
+    /* caller is the thread giving up a reference, the owner's one is not
+     * dropped again for it when it is gone */
+    void release(void *data, kernel_pid_t caller)
+    {
+        unsigned irqmask = cpu_irq_disable();
+        Block *block = block_of(data);
+        if (block->owner == caller)
+            block->owner = KERNEL_PID_UNDEF;
+        if (--block->refs == 0)
+            put(block);
+        cpu_irq_restore(irqmask);
+    }
+
+    kernel_pid_t get_owner(void *data) { return block_of(data)->owner; }
+
+    void set_owner(void *data, kernel_pid_t owner)
+    {
+        unsigned irqmask = cpu_irq_disable();
+        block_of(data)->owner = owner;
+        cpu_irq_restore(irqmask);
+    }
+
+    /* drops the reference of a thread that is gone, called with interrupts
+     * disabled. Returns the number of buffers it still owned. */
+    unsigned reclaim(kernel_pid_t owner)
+    {
+        unsigned count = 0;
+
+        for (unsigned i = 0; i < VCRTOS_CONFIG_MSGBUF_NUMOF; i++)
+        {
+            Block *block = &blocks[i];
+
+            if (block->refs == 0 || block->owner != owner)
+                continue;
+
+            block->owner = KERNEL_PID_UNDEF;
+            if (--block->refs == 0)
+                put(block);
+            count++;
+        }
+
+        leaks += count;
+
+        return count;
+    }
+
+    unsigned get_numof_free() { return numof_free; }
+    unsigned get_leaks() { return leaks; }
+
+private:
+    struct Block
+    {
+        Block *next_free;
+        uint16_t refs;
+        kernel_pid_t owner; /* KERNEL_PID_UNDEF for none */
+        alignas(8) char data[VCRTOS_CONFIG_MSGBUF_SIZE];
+    };
+
+    void put(Block *block)
+    {
+        block->refs = 0;
+        block->owner = KERNEL_PID_UNDEF;
+        block->next_free = free_list;
+        free_list = block;
+        numof_free++;
+    }
+
+    Block *block_of(void *data)
+    {
+        uintptr_t offset = reinterpret_cast<uintptr_t>(data) - reinterpret_cast<uintptr_t>(blocks[0].data);
+        unsigned index = offset / sizeof(Block);
+
+        vcassert(offset % sizeof(Block) == 0 && index < VCRTOS_CONFIG_MSGBUF_NUMOF);
+        vcassert(blocks[index].refs != 0);
+
+        return &blocks[index];
+    }
+
+    Block blocks[VCRTOS_CONFIG_MSGBUF_NUMOF];
+    Block *free_list;
+    unsigned numof_free;
+    unsigned leaks;
+};
+
+} // namespace vc
+
+#endif /* CORE_MSGBUF_POOL_HPP */
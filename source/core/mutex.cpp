@@ -15,6 +15,8 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <vcrtos/trace.h>
+
 #include "core/mutex.hpp"
 #include "core/thread.hpp"
 
@@ -34,6 +36,7 @@ int Mutex::set_lock(int blocking)
     else if (blocking)
     {
         Thread *current_thread = (Thread *)sched_active_thread;
+        VCRTOS_TRACE(TRACE_EVENT_MUTEX_CONTENDED, current_thread->pid, this);
         scheduler->set_thread_status(current_thread, THREAD_STATUS_MUTEX_BLOCKED);
         if (queue.next == MUTEX_LOCKED)
         {
@@ -65,7 +68,9 @@ kernel_pid_t Mutex::peek()
     }
     List *head = (static_cast<List *>(queue.next));
     Thread *thread = Thread::get_thread_pointer_from_list_member(head);
-    return thread->pid;
+    kernel_pid_t pid = thread->pid;
+    cpu_irq_restore(irqmask);
+    return pid;
 }
 
 void Mutex::unlock()
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CORE_PRIORITY_BITMAP_HPP
+#define CORE_PRIORITY_BITMAP_HPP
+
+#include <stdint.h>
+
+#include <vcrtos/assert.h>
+
+namespace vc {
+
+/* index of the lowest set bit, v must not be 0 */
+static inline unsigned bitmap_lsb(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#else
+    /* Source: http://graphics.stanford.edu/~seander/bithacks.html#ZerosOnRightMultLookup */
+    static const uint8_t debruijn_position[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    return debruijn_position[((uint32_t)((v & -v) * 0x077CB531U)) >> 27];
+#endif
+}
+
+/* one bit per priority level that has a ready thread, the lowest set bit is
+ * the most urgent level. Up to 32 levels fit in one word, above that a
+ * summary word tells which of the level words are non empty, so every lookup
+ * stays two bit scans at most. */
+template <unsigned LEVELS, bool TWO_LEVEL = (LEVELS > 32)>
+class PriorityBitmap;
+
+template <unsigned LEVELS>
+class PriorityBitmap<LEVELS, false>
+{
+public:
+    PriorityBitmap() : bits(0) {}
+
+    void reset() { bits = 0; }
+    void set(unsigned level) { bits |= 1u << level; }
+    void clear(unsigned level) { bits &= ~(1u << level); }
+    bool test(unsigned level) const { return (bits & (1u << level)) != 0; }
+    bool empty() const { return bits == 0; }
+
+    /* most urgent level, the bitmap must not be empty */
+    unsigned lowest() const { return bitmap_lsb(bits); }
+
+    /* first set level at or after level, LEVELS when there is none */
+    unsigned next(unsigned level) const
+    {
+        if (level >= LEVELS)
+            return LEVELS;
+
+        uint32_t rest = bits & (~0u << level);
+        return (rest != 0) ? bitmap_lsb(rest) : LEVELS;
+    }
+
+private:
+    uint32_t bits;
+};
+
+template <unsigned LEVELS>
+class PriorityBitmap<LEVELS, true>
+{
+public:
+    PriorityBitmap() { reset(); }
+
+    void reset()
+    {
+        summary = 0;
+
+        for (unsigned i = 0; i < NUMOF_WORDS; i++)
+            words[i] = 0;
+    }
+
+    void set(unsigned level)
+    {
+        words[level >> 5] |= 1u << (level & 31);
+        summary |= 1u << (level >> 5);
+    }
+
+    void clear(unsigned level)
+    {
+        words[level >> 5] &= ~(1u << (level & 31));
+
+        if (words[level >> 5] == 0)
+            summary &= ~(1u << (level >> 5));
+    }
+
+    bool test(unsigned level) const { return (words[level >> 5] & (1u << (level & 31))) != 0; }
+    bool empty() const { return summary == 0; }
+
+    unsigned lowest() const
+    {
+        unsigned word = bitmap_lsb(summary);
+        return (word << 5) + bitmap_lsb(words[word]);
+    }
+
+    unsigned next(unsigned level) const
+    {
+        if (level >= LEVELS)
+            return LEVELS;
+
+        unsigned word = level >> 5;
+        uint32_t rest = words[word] & (~0u << (level & 31));
+
+        if (rest != 0)
+            return (word << 5) + bitmap_lsb(rest);
+
+        /* shifting a 32 bit word by 32 is undefined */
+        uint32_t later = (word < 31) ? (summary & (~0u << (word + 1))) : 0;
+
+        if (later == 0)
+            return LEVELS;
+
+        word = bitmap_lsb(later);
+        return (word << 5) + bitmap_lsb(words[word]);
+    }
+
+private:
+    enum
+    {
+        NUMOF_WORDS = (LEVELS + 31) / 32,
+    };
+
+    static_assert(NUMOF_WORDS <= 32, "the summary word covers at most 1024 levels");
+
+    uint32_t summary;
+    uint32_t words[NUMOF_WORDS];
+};
+
+} // namespace vc
+
+#endif /* CORE_PRIORITY_BITMAP_HPP */
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <vcrtos/config.h>
+#include <vcrtos/cpu.h>
+#include <vcrtos/spinlock.h>
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+
+/* One recursive lock for all kernel objects: every critical section of the
+ * kernel already masks interrupts, on SMP it also takes this lock so the
+ * scheduler, msg, mutex and event code need no per object locking. */
+static spinlock_t smp_kernel_lock = SPINLOCK_INIT;
+static unsigned smp_kernel_lock_depth[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+
+unsigned smp_irq_disable()
+{
+    unsigned state = (cpu_irq_disable)();
+    unsigned core = cpu_core_id();
+
+    if (smp_kernel_lock_depth[core]++ == 0)
+        spinlock_lock(&smp_kernel_lock);
+
+    return state;
+}
+
+void smp_irq_restore(unsigned state)
+{
+    unsigned core = cpu_core_id();
+
+    if (--smp_kernel_lock_depth[core] == 0)
+        spinlock_unlock(&smp_kernel_lock);
+
+    (cpu_irq_restore)(state);
+}
+
+#endif // #if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef CORE_STACK_MONITOR_HPP
+#define CORE_STACK_MONITOR_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vcrtos/cpu.h>
+
+namespace vc {
+
+/* Stacks grow downwards and are painted with one byte, the lowest word is a
+ * canary holding its own address. Used frames may leave painted holes (a
+ * buffer only partly written, padding), so painted words above the deepest
+ * write do not mean the stack below them is untouched. */
+class StackMonitor
+{
+public:
+    static const uint8_t paint_byte = STACK_MARKER & 0xff;
+    static const uintptr_t paint_word = UINTPTR_MAX / 0xff * paint_byte;
+
+    static void paint(char *stack, size_t size)
+    {
+        memset(stack, paint_byte, size);
+        set_canary(stack);
+    }
+
+    static void set_canary(char *stack) { *reinterpret_cast<uintptr_t *>(stack) = reinterpret_cast<uintptr_t>(stack); }
+
+    static bool canary_intact(const char *stack)
+    {
+        return *reinterpret_cast<const uintptr_t *>(stack) == reinterpret_cast<uintptr_t>(stack);
+    }
+
+    /* bytes from the bottom of a painted stack of @p size bytes that were
+     * never written, the canary counts as free while it is intact. The
+     * bisection finds a used word with painted ones right below it, the
+     * deepest write is there or further down, and every word under it is
+     * checked to find it. */
+    static size_t measure_free(const char *stack, size_t size)
+    {
+        const uintptr_t *words = reinterpret_cast<const uintptr_t *>(stack);
+        size_t count = size / sizeof(uintptr_t);
+
+        if (count == 0 || !canary_intact(stack))
+            return 0;
+
+        /* estimate, the first used word is not above low */
+        size_t low = 1;
+        size_t high = count;
+
+        while (low < high)
+        {
+            size_t mid = low + (high - low) / 2;
+
+            if (words[mid] == paint_word)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        return measure_free_linear(stack, low);
+    }
+
+    /* same as measure_free() without knowing the size, the scan stops at the
+     * first word that is not painted */
+    static size_t measure_free_linear(const char *stack, size_t count = SIZE_MAX)
+    {
+        const uintptr_t *words = reinterpret_cast<const uintptr_t *>(stack);
+
+        if (!canary_intact(stack))
+            return 0;
+
+        size_t i = 1;
+
+        while (i < count && words[i] == paint_word)
+            i++;
+
+        return i * sizeof(uintptr_t);
+    }
+};
+
+} // namespace vc
+
+#endif /* CORE_STACK_MONITOR_HPP */
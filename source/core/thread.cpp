@@ -16,34 +16,105 @@
  */
 
 #include <vcrtos/assert.h>
+#include <vcrtos/trace.h>
 
 #include "core/new.hpp"
 #include "core/thread.hpp"
 #include "core/code_utils.h"
 
+namespace vc {
+
+DEFINE_ALIGNED_VAR(vcrtosThreadScheduler, sizeof(ThreadScheduler), uint64_t);
+
+} // namespace vc
+
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+
+#define sched_is_initialized (kernel_instance_get_current()->is_initialized)
+
+static kernel_instance_t kernel_default_instance = {
+    nullptr, KERNEL_PID_UNDEF, 0, &vc::vcrtosThreadScheduler
+};
+
+static thread_local kernel_instance_t *kernel_current_instance = &kernel_default_instance;
+
+extern "C" kernel_instance_t *kernel_instance_create(void)
+{
+    kernel_instance_t *instance = new kernel_instance_t;
+
+    instance->active_thread = nullptr;
+    instance->active_pid = KERNEL_PID_UNDEF;
+    instance->is_initialized = 0;
+    instance->scheduler = new uint64_t[ALIGNED_VAR_SIZE(sizeof(vc::ThreadScheduler), uint64_t)];
+
+    return instance;
+}
+
+extern "C" void kernel_instance_destroy(kernel_instance_t *instance)
+{
+    vcassert(instance != &kernel_default_instance);
+
+    if (kernel_current_instance == instance)
+        kernel_current_instance = &kernel_default_instance;
+
+    delete[] static_cast<uint64_t *>(instance->scheduler);
+    delete instance;
+}
+
+extern "C" void kernel_instance_set_current(kernel_instance_t *instance)
+{
+    kernel_current_instance = (instance != nullptr) ? instance : &kernel_default_instance;
+}
+
+extern "C" kernel_instance_t *kernel_instance_get_current(void)
+{
+    return kernel_current_instance;
+}
+
+#elif VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+
+extern "C" {
+void *sched_active_threads[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+int16_t sched_active_pids[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+int sched_is_initialized = 0;
+}
+
+#else
+
 extern "C" {
 void *sched_active_thread = nullptr;
 int16_t sched_active_pid = KERNEL_PID_UNDEF;
 int sched_is_initialized = 0;
 }
 
-namespace vc {
+#endif // #if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
 
-DEFINE_ALIGNED_VAR(vcrtosThreadScheduler, sizeof(ThreadScheduler), uint64_t);
+namespace vc {
 
 ThreadScheduler &ThreadScheduler::init()
 {
-    ThreadScheduler *sched = &get();
-    sched = new (&vcrtosThreadScheduler) ThreadScheduler();
+    ThreadScheduler *sched = new (&get()) ThreadScheduler();
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    for (unsigned core = 0; core < SMP_NUMOF_CORES; core++)
+    {
+        sched_active_threads[core] = nullptr;
+        sched_active_pids[core] = KERNEL_PID_UNDEF;
+    }
+#else
     sched_active_thread = nullptr;
     sched_active_pid = KERNEL_PID_UNDEF;
+#endif
     sched_is_initialized = 1;
     return *sched;
 }
 
 ThreadScheduler &ThreadScheduler::get()
 {
+#if VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE
+    void *sched = kernel_current_instance->scheduler;
+#else
     void *sched = &vcrtosThreadScheduler;
+#endif
     return *static_cast<ThreadScheduler *>(sched);
 }
 
@@ -52,6 +123,55 @@ int ThreadScheduler::is_initialized()
     return sched_is_initialized;
 }
 
+kernel_pid_t ThreadScheduler::alloc_pid()
+{
+    if (numof_free_pids == 0)
+        return KERNEL_PID_UNDEF;
+
+    kernel_pid_t pid = free_pids[free_pids_head];
+
+    free_pids_head = (free_pids_head + 1) % KERNEL_MAXTHREADS;
+    numof_free_pids--;
+
+    /* 0 is left out so a handle is never THREAD_HANDLE_INVALID */
+    if (++pid_generation[pid] == 0)
+        pid_generation[pid] = 1;
+
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+    stack_peaks[pid] = 0;
+#endif
+
+    return pid;
+}
+
+void ThreadScheduler::release_pid(kernel_pid_t pid)
+{
+    vcassert(numof_free_pids < KERNEL_MAXTHREADS);
+    free_pids[(free_pids_head + numof_free_pids) % KERNEL_MAXTHREADS] = pid;
+    numof_free_pids++;
+}
+
+thread_handle_t ThreadScheduler::get_handle(kernel_pid_t pid)
+{
+    if (!Thread::is_pid_valid(pid) || threads_container[pid] == nullptr)
+        return THREAD_HANDLE_INVALID;
+
+    return ((thread_handle_t)pid_generation[pid] << 16) | (uint16_t)pid;
+}
+
+kernel_pid_t ThreadScheduler::get_pid_from_handle(thread_handle_t handle)
+{
+    kernel_pid_t pid = (kernel_pid_t)(handle & 0xffff);
+
+    if (!Thread::is_pid_valid(pid) || threads_container[pid] == nullptr ||
+        pid_generation[pid] != (uint16_t)(handle >> 16))
+    {
+        return KERNEL_PID_UNDEF;
+    }
+
+    return pid;
+}
+
 Thread::Thread()
 {
     this->stack_pointer = nullptr;
@@ -62,7 +182,30 @@ Thread::Thread()
     this->flags = 0;
     this->waited_flags = 0;
 #endif
+    this->msg_type_mask = 0;
     this->runqueue_entry.next = nullptr;
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    this->core = 0;
+    this->affinity = THREAD_AFFINITY_ALL;
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    this->budget_group = THREAD_BUDGET_GROUP_NONE;
+    this->budget_next = KERNEL_PID_UNDEF;
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    this->base_priority = KERNEL_THREAD_PRIORITY_IDLE;
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    this->ipc_server = KERNEL_PID_UNDEF;
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    this->spawn_slot = nullptr;
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+    this->deadline = 0;
+    this->deadline_slot = -1;
+    this->deadline_misses = 0;
+#endif
     this->wait_data = nullptr;
     this->msg_waiters.next = nullptr;
 
@@ -117,36 +260,20 @@ Thread *Thread::init(char *allocated_stack,
 
     if (flags & THREAD_FLAGS_CREATE_STACKMARKER)
     {
-        /* assign each int of the stack the value of it's address, for test purposes */
-        uintptr_t *stackmax = reinterpret_cast<uintptr_t *>(stack + size);
-        uintptr_t *stackp = reinterpret_cast<uintptr_t *>(stack);
-
-        while (stackp < stackmax)
-        {
-            *stackp = reinterpret_cast<uintptr_t>(stackp);
-            stackp++;
-        }
+        /* paint the stack so its usage can be measured */
+        StackMonitor::paint(stack, size);
     }
     else
     {
         /* create stack guard */
-        *(uintptr_t *)stack = reinterpret_cast<uintptr_t>(stack);
+        StackMonitor::set_canary(stack);
     }
 
     unsigned irqmask = cpu_irq_disable();
 
-    kernel_pid_t pid = KERNEL_PID_UNDEF;
-
     ThreadScheduler &scheduler = ThreadScheduler::get();
 
-    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; ++i)
-    {
-        if (scheduler.get_thread_from_container(i) == nullptr)
-        {
-            pid = i;
-            break;
-        }
-    }
+    kernel_pid_t pid = scheduler.alloc_pid();
 
     if (pid == KERNEL_PID_UNDEF)
     {
@@ -163,6 +290,22 @@ Thread *Thread::init(char *allocated_stack,
     thread->name = name;
     thread->priority = priority;
     thread->status = THREAD_STATUS_STOPPED;
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    thread->base_priority = priority;
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    thread->ipc_server = KERNEL_PID_UNDEF;
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+    /* due right away, create EDF threads with THREAD_FLAGS_CREATE_SLEEPING
+     * and set the deadline before waking them */
+    thread->deadline = cpu_get_timestamp();
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    /* queued on the creating core, idle cores steal it if needed */
+    thread->core = cpu_core_id();
+    thread->affinity = (flags & THREAD_FLAGS_CREATE_PINNED) ? (1u << thread->core) : THREAD_AFFINITY_ALL;
+#endif
 
     scheduler.add_numof_threads();
 
@@ -251,12 +394,62 @@ int Thread::queued_msg(Msg *msg)
 
 void ThreadScheduler::run()
 {
-    context_switch_request = 0;
+    Core &core = get_core();
+    core.context_switch_request = 0;
     Thread *current_thread = (Thread *)sched_active_thread;
-    Thread *next_thread = get_next_thread_from_runqueue();
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    /* the context of a thread that exited is gone by now */
+    if (core.spawn_zombie != nullptr)
+    {
+        spawn_finish(core.spawn_zombie);
+        core.spawn_zombie = nullptr;
+    }
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    /* the affinity of the current thread was changed, its context is saved
+     * by now so it can be handed over */
+    if (current_thread != nullptr &&
+        current_thread->status >= THREAD_STATUS_RUNNING &&
+        !current_thread->runs_on(cpu_core_id()))
+    {
+        move_to_core(current_thread, least_busy_core(current_thread));
+        notify_core(current_thread);
+    }
+
+    /* nothing but idle left on this core */
+    if (core.runqueue_bitcache.next(0) >= KERNEL_THREAD_PRIORITY_IDLE)
+        steal();
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    /* may move threads between priorities, so before picking the next one */
+    uint32_t budget_now = cpu_get_timestamp();
+    budget_charge(core, current_thread, budget_now);
+    budget_replenish(budget_now);
+#endif
+    Thread *next_thread = core.handoff;
+    core.handoff = nullptr;
+
+    if (next_thread == nullptr)
+        next_thread = get_next_thread_from_runqueue();
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    update_budget_timer(core, next_thread, budget_now);
+#endif
 
     if (current_thread == next_thread)
+    {
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+        update_time_slice(core, next_thread, false);
+#endif
         return;
+    }
+
+#if VCRTOS_CONFIG_STACK_CHECK_ENABLE
+    /* the outgoing thread is caught right after it overran, the incoming
+     * one if anything else wrote into its stack while it was switched out */
+    check_stack(current_thread);
+    check_stack(next_thread);
+#endif
 
     if (current_thread != nullptr)
     {
@@ -266,31 +459,92 @@ void ThreadScheduler::run()
 
     scheduler_stats[next_thread->pid].schedules += 1;
 
+#if VCRTOS_CONFIG_THREAD_RUNTIME_STATS_ENABLE
+    uint32_t now = cpu_get_timestamp();
+
+    if (current_thread != nullptr)
+    {
+        scheduler_stats[current_thread->pid].runtime_ticks += now - scheduler_stats[current_thread->pid].last_start;
+    }
+
+    scheduler_stats[next_thread->pid].last_start = now;
+#endif
+
     next_thread->status = THREAD_STATUS_RUNNING;
     sched_active_thread = (void *)next_thread;
     sched_active_pid = (int16_t)next_thread->pid;
+
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+    update_time_slice(core, next_thread, true);
+#endif
+
+    VCRTOS_TRACE(TRACE_EVENT_SWITCH, next_thread->pid, (current_thread != nullptr) ? current_thread->pid : KERNEL_PID_UNDEF);
 }
 
+#if VCRTOS_CONFIG_STACK_CHECK_ENABLE
+void ThreadScheduler::check_stack(Thread *thread)
+{
+    if (thread == nullptr || StackMonitor::canary_intact(thread->stack_start))
+        return;
+
+    VCRTOS_TRACE(TRACE_EVENT_STACK_OVERFLOW, thread->pid, 0);
+    cpu_stack_overflow(thread);
+}
+#endif
+
 void ThreadScheduler::set_thread_status(Thread *thread, thread_status_t new_status)
 {
     uint8_t priority = thread->priority;
 
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+    /* a timed receive is over however the thread leaves it */
+    if (thread->status == THREAD_STATUS_RECEIVE_BLOCKED)
+        msg_timeout_stop(thread);
+#endif
+
     if (new_status >= THREAD_STATUS_RUNNING)
     {
         if (thread->status < THREAD_STATUS_RUNNING)
         {
+            VCRTOS_TRACE(TRACE_EVENT_WAKE, thread->pid, thread->status);
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+            thread->core = select_core(thread);
+#endif
+            Core &core = get_core(thread);
+            core.handoff = nullptr;
             list_node_t *thread_runqueue_entry = thread->get_runqueue_entry();
-            scheduler_runqueue[priority].right_push(static_cast<Clist *>(thread_runqueue_entry));
-            runqueue_bitcache |= 1 << priority;
+            core.runqueue[priority].right_push(static_cast<Clist *>(thread_runqueue_entry));
+            core.runqueue_bitcache.set(priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+            if (priority == VCRTOS_CONFIG_EDF_PRIORITY)
+                core.deadline_heap.insert(thread);
+#endif
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+            time_slice_peer_woken(thread);
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+            notify_core(thread);
+#endif
         }
     }
     else
     {
+        VCRTOS_TRACE(TRACE_EVENT_BLOCK, thread->pid, new_status);
+
         if (thread->status >= THREAD_STATUS_RUNNING)
         {
-            scheduler_runqueue[priority].left_pop();
-            if (scheduler_runqueue[priority].next == nullptr)
-                runqueue_bitcache &= ~(1 << priority);
+            /* a running thread is the head of its queue, a pending one
+             * (e.g. terminated by another thread) may be anywhere in it */
+            Core &core = get_core(thread);
+            if (core.handoff == thread)
+                core.handoff = nullptr;
+            core.runqueue[priority].remove(static_cast<Clist *>(thread->get_runqueue_entry()));
+            if (core.runqueue[priority].next == nullptr)
+                core.runqueue_bitcache.clear(priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+            if (priority == VCRTOS_CONFIG_EDF_PRIORITY)
+                core.deadline_heap.remove(thread);
+#endif
         }
     }
 
@@ -303,11 +557,16 @@ void ThreadScheduler::context_switch(uint8_t priority_to_switch)
     uint8_t current_priority = current_thread->priority;
     int is_in_runqueue = (current_thread->status >= THREAD_STATUS_RUNNING);
     /* Note: the lowest priority number is the highest priority thread */
-    if (!is_in_runqueue || (current_priority > priority_to_switch))
+    if (!is_in_runqueue || (current_priority > priority_to_switch)
+#if VCRTOS_CONFIG_EDF_ENABLE
+        || (current_priority == priority_to_switch &&
+            preempts_by_deadline(static_cast<Thread *>(get_core().deadline_heap.top()), current_thread))
+#endif
+       )
     {
         if (cpu_is_in_isr())
         {
-            context_switch_request = 1;
+            get_core().context_switch_request = 1;
         }
         else
         {
@@ -316,150 +575,1264 @@ void ThreadScheduler::context_switch(uint8_t priority_to_switch)
     }
 }
 
-void ThreadScheduler::yield_higher_priority_thread()
+void ThreadScheduler::set_handoff(Thread *thread)
 {
-    thread_arch_yield_higher();
-}
+    Core &core = get_core(thread);
+    uint8_t priority = thread->priority;
 
-/* Source: http://graphics.stanford.edu/~seander/bithacks.html#ZerosOnRightMultLookup */
-const uint8_t MultiplyDeBruijnBitPosition[32] =
-{
-    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
-    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
-};
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    if (thread->core != cpu_core_id())
+        return;
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        return;
+#endif
+
+    /* only what get_next_thread_from_runqueue() would return anyway */
+    if (core.runqueue_bitcache.lowest() == priority &&
+        core.runqueue[priority].next->next == thread->get_runqueue_entry())
+    {
+        core.handoff = thread;
+    }
+}
 
-unsigned ThreadScheduler::bitarithm_lsb(unsigned v)
+void ThreadScheduler::yield_higher_priority_thread()
 {
-    return MultiplyDeBruijnBitPosition[((uint32_t)((v & -v) * 0x077CB531U)) >> 27];
+    thread_arch_yield_higher();
 }
 
 Thread *ThreadScheduler::get_next_thread_from_runqueue()
 {
-    uint8_t priority = bitarithm_lsb(runqueue_bitcache);
-    list_node_t *thread_ptr_in_queue = static_cast<list_node_t *>((scheduler_runqueue[priority].next)->next);
+    Core &core = get_core();
+    uint8_t priority = core.runqueue_bitcache.lowest();
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        return static_cast<Thread *>(core.deadline_heap.top());
+#endif
+    list_node_t *thread_ptr_in_queue = static_cast<list_node_t *>((core.runqueue[priority].next)->next);
     thread_t *thread = container_of(thread_ptr_in_queue, thread_t, runqueue_entry);
     return static_cast<Thread *>(thread);
 }
 
-void ThreadScheduler::sleep()
+#if VCRTOS_CONFIG_EDF_ENABLE
+bool ThreadScheduler::preempts_by_deadline(Thread *thread, Thread *running)
 {
-    if (cpu_is_in_isr())
-        return;
-
-    unsigned irqmask = cpu_irq_disable();
-    set_thread_status((Thread *)sched_active_thread, THREAD_STATUS_SLEEPING);
-    cpu_irq_restore(irqmask);
-    yield_higher_priority_thread();
+    return thread != nullptr && running != nullptr && thread != running &&
+           thread->priority == VCRTOS_CONFIG_EDF_PRIORITY &&
+           running->priority == VCRTOS_CONFIG_EDF_PRIORITY &&
+           running->status >= THREAD_STATUS_RUNNING &&
+           DeadlineHeap<thread_t>::earlier(thread, running);
 }
 
-int ThreadScheduler::wakeup_thread(kernel_pid_t pid)
+int ThreadScheduler::set_deadline(kernel_pid_t pid, uint32_t deadline)
 {
     unsigned irqmask = cpu_irq_disable();
-    Thread *thread_to_wakeup = get_thread_from_container(pid);
-    if (!thread_to_wakeup)
+    Thread *thread = get_thread_from_container(pid);
+
+    if (thread == nullptr)
     {
-        //TODO: Warning thread does not exist!
         cpu_irq_restore(irqmask);
         return -1;
     }
-    else if (thread_to_wakeup->status == THREAD_STATUS_SLEEPING)
+
+    int yield = 0;
+
+    if (thread->deadline_slot >= 0)
     {
-        set_thread_status(thread_to_wakeup, THREAD_STATUS_PENDING);
-        cpu_irq_restore(irqmask);
-        context_switch(thread_to_wakeup->priority);
-        return 1;
+        /* reposition a ready thread */
+        Core &core = get_core(thread);
+        core.deadline_heap.remove(thread);
+        thread->deadline = deadline;
+        core.deadline_heap.insert(thread);
+
+        Thread *current_thread = (Thread *)sched_active_thread;
+        Thread *top = static_cast<Thread *>(get_core().deadline_heap.top());
+
+        if (current_thread != nullptr && current_thread->priority == VCRTOS_CONFIG_EDF_PRIORITY &&
+            top != current_thread && top != nullptr && !DeadlineHeap<thread_t>::earlier(current_thread, top))
+        {
+            yield = 1;
+        }
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+        else if (thread->core != cpu_core_id())
+        {
+            cpu_send_ipi(thread->core);
+        }
+#endif
     }
     else
     {
-        // TODO: Warning thread is not sleeping!
-        cpu_irq_restore(irqmask);
-        return 0;
+        thread->deadline = deadline;
     }
+
+    cpu_irq_restore(irqmask);
+
+    if (yield)
+        context_switch(VCRTOS_CONFIG_EDF_PRIORITY);
+
+    return 1;
 }
 
-void ThreadScheduler::yield()
+int ThreadScheduler::renew_deadline(uint32_t relative_deadline)
 {
     unsigned irqmask = cpu_irq_disable();
     Thread *current_thread = (Thread *)sched_active_thread;
+    int missed = (int32_t)(cpu_get_timestamp() - current_thread->deadline) > 0;
 
-    if (current_thread->status >= THREAD_STATUS_RUNNING)
-        scheduler_runqueue[current_thread->priority].left_pop_right_push();
+    if (missed)
+    {
+        current_thread->deadline_misses++;
+        VCRTOS_TRACE(TRACE_EVENT_DEADLINE_MISS, current_thread->pid, current_thread->deadline_misses);
+    }
 
     cpu_irq_restore(irqmask);
-    yield_higher_priority_thread();
+
+    /* the next job is due relative to the previous deadline, so the period
+     * does not drift with the time the job took */
+    set_deadline(current_thread->pid, current_thread->deadline + relative_deadline);
+
+    return missed;
 }
 
-void ThreadScheduler::exit()
+uint32_t ThreadScheduler::get_deadline_misses(kernel_pid_t pid)
 {
-    (void)cpu_irq_disable();
-    threads_container[sched_active_pid] = nullptr;
-    numof_threads_in_container -= 1;
-    set_thread_status((Thread *)sched_active_thread, THREAD_STATUS_STOPPED);
-    sched_active_thread = nullptr;
-    // Note: user need to call cpu_switch_context_exit() after this function
+    vcassert(Thread::is_pid_valid(pid));
+    Thread *thread = get_thread_from_container(pid);
+    return (thread != nullptr) ? thread->deadline_misses : 0;
 }
+#endif // #if VCRTOS_CONFIG_EDF_ENABLE
 
-void ThreadScheduler::terminate(kernel_pid_t pid)
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+void ThreadScheduler::change_priority(Thread *thread, uint8_t priority)
 {
-    if (sched_active_pid == pid)
+    if (thread->priority == priority)
+        return;
+
+    if (thread->status < THREAD_STATUS_RUNNING)
     {
-        exit();
+        thread->priority = priority;
         return;
     }
-    unsigned irqmask = cpu_irq_disable();
-    Thread *thread = threads_container[pid];
-    threads_container[pid] = nullptr;
-    numof_threads_in_container -= 1;
-    set_thread_status(thread, THREAD_STATUS_STOPPED);
-    cpu_irq_restore(irqmask);
+
+    Core &core = get_core(thread);
+    Clist *entry = static_cast<Clist *>(thread->get_runqueue_entry());
+
+    core.handoff = nullptr;
+    core.runqueue[thread->priority].remove(entry);
+    if (core.runqueue[thread->priority].next == nullptr)
+        core.runqueue_bitcache.clear(thread->priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (thread->priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        core.deadline_heap.remove(thread);
+#endif
+
+    thread->priority = priority;
+
+    core.runqueue[priority].right_push(entry);
+    core.runqueue_bitcache.set(priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        core.deadline_heap.insert(thread);
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    /* the local core is switched by the caller */
+    if (thread->core != cpu_core_id())
+        cpu_send_ipi(thread->core);
+#endif
 }
 
-const char *ThreadScheduler::thread_status_to_string(thread_status_t status)
+uint8_t ThreadScheduler::effective_priority(Thread *thread)
 {
-    const char *retval;
+    uint8_t priority = thread->base_priority;
 
-    switch (status)
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    if (thread->budget_group != THREAD_BUDGET_GROUP_NONE && budget_groups[thread->budget_group].throttled)
+        priority = budget_groups[thread->budget_group].background_priority;
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    /* the most urgent thread waiting on it in IPC lends its priority, both
+     * lists are ordered by priority so it is at the head of one of them */
+    List *heads[] = {static_cast<List *>(thread->msg_waiters.next),
+                     static_cast<List *>(ipc_clients[thread->pid].next)};
+
+    for (List *head : heads)
     {
-    case THREAD_STATUS_RUNNING:
-        retval = "running";
-        break;
+        if (head != nullptr && Thread::get_thread_pointer_from_list_member(head)->priority < priority)
+            priority = Thread::get_thread_pointer_from_list_member(head)->priority;
+    }
+#endif
 
-    case THREAD_STATUS_PENDING:
-        retval = "pending";
-        break;
+    return priority;
+}
 
-    case THREAD_STATUS_STOPPED:
-        retval = "stopped";
-        break;
+void ThreadScheduler::update_priority(Thread *thread)
+{
+    /* a chain of servers can not be longer than the number of threads */
+    for (unsigned depth = 0; thread != nullptr && depth < KERNEL_MAXTHREADS; depth++)
+    {
+        uint8_t priority = effective_priority(thread);
 
-    case THREAD_STATUS_SLEEPING:
-        retval = "sleeping";
-        break;
+        if (priority == thread->priority)
+            return;
 
-    case THREAD_STATUS_MUTEX_BLOCKED:
-        retval = "bl mutex";
-        break;
+        change_priority(thread, priority);
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+        thread = requeue_ipc_waiter(thread);
+#else
+        thread = nullptr;
+#endif
+    }
+}
+#endif // #if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
 
-    case THREAD_STATUS_RECEIVE_BLOCKED:
-        retval = "bl rx";
-        break;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+Thread *ThreadScheduler::requeue_ipc_waiter(Thread *thread)
+{
+    if (thread->ipc_server == KERNEL_PID_UNDEF)
+        return nullptr;
 
-    case THREAD_STATUS_SEND_BLOCKED:
-        retval = "bl send";
-        break;
+    Thread *server = threads_container[thread->ipc_server];
 
-    case THREAD_STATUS_REPLY_BLOCKED:
-        retval = "bl reply";
-        break;
+    if (server == nullptr)
+        return nullptr;
 
-    case THREAD_STATUS_FLAG_BLOCKED_ANY:
-        retval = "bl flag";
-        break;
+    /* senders the server has not received from yet and clients waiting for
+     * its reply are both kept ordered by priority */
+    List *entry = static_cast<List *>(thread->get_runqueue_entry());
+    List *waiters = static_cast<List *>(&server->msg_waiters);
+    List *clients = &ipc_clients[server->pid];
 
-    case THREAD_STATUS_FLAG_BLOCKED_ALL:
+    if (List::remove(waiters, entry) != nullptr)
+        thread->add_to_list(waiters);
+    else if (List::remove(clients, entry) != nullptr)
+        thread->add_to_list(clients);
+
+    return server;
+}
+
+void ThreadScheduler::inherit_priority(Thread *waiter, Thread *server)
+{
+    waiter->ipc_server = server->pid;
+
+    /* a new waiter can only raise priorities, no need to look at the others */
+    for (unsigned depth = 0; server != nullptr && depth < KERNEL_MAXTHREADS; depth++)
+    {
+        if (waiter->priority >= server->priority)
+            return;
+
+        change_priority(server, waiter->priority);
+        waiter = server;
+        server = requeue_ipc_waiter(server);
+    }
+}
+
+void ThreadScheduler::add_ipc_client(Thread *client)
+{
+    /* its request was taken, it waits for the reply off msg_waiters */
+    if (client->ipc_server != KERNEL_PID_UNDEF)
+        client->add_to_list(&ipc_clients[client->ipc_server]);
+}
+
+void ThreadScheduler::release_priority(Thread *waiter)
+{
+    if (waiter->ipc_server == KERNEL_PID_UNDEF)
+        return;
+
+    Thread *server = threads_container[waiter->ipc_server];
+
+    List::remove(&ipc_clients[waiter->ipc_server], static_cast<List *>(waiter->get_runqueue_entry()));
+    waiter->ipc_server = KERNEL_PID_UNDEF;
+
+    /* only the waiter the server got its priority from makes a difference */
+    if (server != nullptr && server->priority == waiter->priority)
+        update_priority(server);
+}
+
+void ThreadScheduler::release_ipc_waiters(Thread *thread)
+{
+    if (thread->ipc_server != KERNEL_PID_UNDEF && threads_container[thread->ipc_server] != nullptr)
+    {
+        /* a blocked sender that goes away must not be received from */
+        List::remove(static_cast<List *>(&threads_container[thread->ipc_server]->msg_waiters),
+                     static_cast<List *>(thread->get_runqueue_entry()));
+    }
+
+    release_priority(thread);
+
+    /* the ones waiting on it stay blocked, they only stop lending */
+    List *heads[] = {static_cast<List *>(&thread->msg_waiters), &ipc_clients[thread->pid]};
+
+    for (List *head : heads)
+    {
+        for (List *node = static_cast<List *>(head->next); node != nullptr; node = static_cast<List *>(node->next))
+        {
+            Thread::get_thread_pointer_from_list_member(node)->ipc_server = KERNEL_PID_UNDEF;
+        }
+    }
+
+    ipc_clients[thread->pid].next = nullptr;
+}
+#endif // #if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+void ThreadScheduler::budget_charge(Core &core, Thread *thread, uint32_t now)
+{
+    uint32_t elapsed = now - core.budget_start;
+
+    core.budget_start = now;
+
+    if (thread == nullptr || thread->budget_group == THREAD_BUDGET_GROUP_NONE)
+        return;
+
+    BudgetGroup &group = budget_groups[thread->budget_group];
+
+    /* running in the background is free */
+    if (group.throttled)
+        return;
+
+    group.remaining = (elapsed < group.remaining) ? group.remaining - elapsed : 0;
+
+    if (group.remaining == 0)
+        budget_throttle(thread->budget_group, true);
+}
+
+void ThreadScheduler::budget_replenish(uint32_t now)
+{
+    for (uint8_t id = 0; id < VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS; id++)
+    {
+        BudgetGroup &group = budget_groups[id];
+        uint32_t elapsed = now - group.period_start;
+
+        if (group.period == 0 || elapsed < group.period)
+            continue;
+
+        /* skip the periods nobody looked at, the budget does not pile up */
+        group.period_start += elapsed - (elapsed % group.period);
+        group.remaining = group.budget;
+
+        if (group.throttled)
+            budget_throttle(id, false);
+    }
+}
+
+void ThreadScheduler::budget_throttle(uint8_t id, bool throttle)
+{
+    BudgetGroup &group = budget_groups[id];
+
+    group.throttled = throttle;
+
+    if (throttle)
+        group.throttles++;
+
+    for (kernel_pid_t pid = group.members; pid != KERNEL_PID_UNDEF;)
+    {
+        Thread *thread = threads_container[pid];
+
+        pid = thread->budget_next;
+        update_priority(thread);
+    }
+}
+
+void ThreadScheduler::budget_group_unlink(Thread *thread)
+{
+    if (thread->budget_group == THREAD_BUDGET_GROUP_NONE)
+        return;
+
+    kernel_pid_t *link = &budget_groups[thread->budget_group].members;
+
+    while (*link != KERNEL_PID_UNDEF && *link != thread->pid)
+    {
+        link = &threads_container[*link]->budget_next;
+    }
+
+    if (*link == thread->pid)
+        *link = thread->budget_next;
+
+    thread->budget_next = KERNEL_PID_UNDEF;
+}
+
+void ThreadScheduler::update_budget_timer(Core &core, Thread *thread, uint32_t now)
+{
+    uint32_t ticks = 0;
+
+    /* fires when the running group runs dry ... */
+    if (thread != nullptr && thread->budget_group != THREAD_BUDGET_GROUP_NONE &&
+        !budget_groups[thread->budget_group].throttled)
+    {
+        ticks = budget_groups[thread->budget_group].remaining;
+    }
+
+    /* ... or when a throttled group is due for its budget again */
+    for (uint8_t id = 0; id < VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS; id++)
+    {
+        BudgetGroup &group = budget_groups[id];
+
+        if (!group.throttled)
+            continue;
+
+        uint32_t until = group.period - (now - group.period_start);
+
+        if (ticks == 0 || until < ticks)
+            ticks = until;
+    }
+
+    if (ticks != 0)
+    {
+        cpu_budget_timer_start(ticks);
+        core.budget_armed = 1;
+    }
+    else if (core.budget_armed)
+    {
+        cpu_budget_timer_stop();
+        core.budget_armed = 0;
+    }
+}
+
+int ThreadScheduler::budget_group_init(uint8_t id, uint32_t budget, uint32_t period, uint8_t background_priority)
+{
+    if (id >= VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS || budget == 0 || budget > period ||
+        background_priority >= KERNEL_THREAD_PRIORITY_LEVELS)
+    {
+        return -1;
+    }
+
+    unsigned irqmask = cpu_irq_disable();
+    BudgetGroup &group = budget_groups[id];
+    Core &core = get_core();
+    uint32_t now = cpu_get_timestamp();
+
+    /* a period that ended with the timer interrupt still pending is handed
+     * out first, the timer is re-armed for the others below */
+    budget_charge(core, (Thread *)sched_active_thread, now);
+    budget_replenish(now);
+
+    if (group.throttled)
+        budget_throttle(id, false);
+
+    group.budget = budget;
+    group.period = period;
+    group.remaining = budget;
+    group.period_start = now;
+    group.background_priority = background_priority;
+    group.throttles = 0;
+
+    update_budget_timer(core, (Thread *)sched_active_thread, now);
+
+    cpu_irq_restore(irqmask);
+
+    return 1;
+}
+
+int ThreadScheduler::budget_group_join(kernel_pid_t pid, uint8_t id)
+{
+    if (id != THREAD_BUDGET_GROUP_NONE &&
+        (id >= VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS || budget_groups[id].period == 0))
+    {
+        return -1;
+    }
+
+    unsigned irqmask = cpu_irq_disable();
+    Thread *thread = get_thread_from_container(pid);
+
+    if (thread == nullptr)
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    Core &core = get_core();
+    Thread *current_thread = (Thread *)sched_active_thread;
+    uint32_t now = cpu_get_timestamp();
+
+    /* the time run so far is paid by the old group, periods that ended in
+     * the meantime are handed out as in run() */
+    budget_charge(core, current_thread, now);
+    budget_replenish(now);
+
+    uint8_t old_priority = thread->priority;
+
+    budget_group_unlink(thread);
+    thread->budget_group = id;
+
+    if (id != THREAD_BUDGET_GROUP_NONE)
+    {
+        thread->budget_next = budget_groups[id].members;
+        budget_groups[id].members = thread->pid;
+    }
+
+    update_priority(thread);
+
+    uint8_t priority = thread->priority;
+    update_budget_timer(core, current_thread, now);
+
+    cpu_irq_restore(irqmask);
+
+    if (priority < old_priority)
+        context_switch(priority);
+    else if (thread == current_thread && priority > old_priority)
+        context_switch(old_priority);
+
+    return 1;
+}
+
+uint32_t ThreadScheduler::budget_group_get_throttles(uint8_t id)
+{
+    vcassert(id < VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS);
+    return budget_groups[id].throttles;
+}
+
+void ThreadScheduler::budget_expired()
+{
+    unsigned irqmask = cpu_irq_disable();
+    Core &core = get_core();
+    uint32_t now = cpu_get_timestamp();
+
+    core.budget_armed = 0;
+
+    budget_charge(core, (Thread *)sched_active_thread, now);
+    budget_replenish(now);
+
+    /* run() picks the next thread and re-arms the timer */
+    core.context_switch_request = 1;
+
+    cpu_irq_restore(irqmask);
+}
+#endif // #if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+void ThreadScheduler::init_spawn_pools()
+{
+    const struct
+    {
+        char *base;
+        int stack_size;
+        unsigned numof;
+    } pools[THREAD_STACK_NUMOF] = {
+        { &spawn_stacks_small[0][0], VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE, VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF },
+        { &spawn_stacks_medium[0][0], VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_STACKSIZE, VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF },
+        { &spawn_stacks_large[0][0], VCRTOS_CONFIG_THREAD_SPAWN_LARGE_STACKSIZE, VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF },
+    };
+    unsigned index = 0;
+
+    for (unsigned stack_class = 0; stack_class < THREAD_STACK_NUMOF; stack_class++)
+    {
+        spawn_free[stack_class] = nullptr;
+
+        for (unsigned i = 0; i < pools[stack_class].numof; i++)
+        {
+            SpawnSlot *slot = &spawn_slots[index++];
+
+            slot->stack = pools[stack_class].base + i * pools[stack_class].stack_size;
+            slot->stack_size = pools[stack_class].stack_size;
+            slot->stack_class = static_cast<thread_stack_class_t>(stack_class);
+            slot->pid = KERNEL_PID_UNDEF;
+            spawn_release(slot);
+        }
+    }
+}
+
+void *ThreadScheduler::spawn_entry(void *arg)
+{
+    SpawnSlot *slot = static_cast<SpawnSlot *>(arg);
+
+    slot->result = slot->func(slot->arg);
+
+    return slot->result;
+}
+
+ThreadScheduler::SpawnSlot *ThreadScheduler::find_spawn_slot(kernel_pid_t pid)
+{
+    for (unsigned i = 0; i < SPAWN_NUMOF_SLOTS; i++)
+    {
+        if (spawn_slots[i].state != SPAWN_FREE && spawn_slots[i].pid == pid)
+            return &spawn_slots[i];
+    }
+
+    return nullptr;
+}
+
+void ThreadScheduler::spawn_finish(SpawnSlot *slot)
+{
+    if (slot->detached)
+    {
+        spawn_release(slot);
+        return;
+    }
+
+    slot->state = SPAWN_EXITED;
+
+    Thread *joiner = (slot->joiner != KERNEL_PID_UNDEF) ? get_thread_from_container(slot->joiner) : nullptr;
+
+    if (joiner != nullptr)
+        set_thread_status(joiner, THREAD_STATUS_PENDING);
+}
+
+void ThreadScheduler::spawn_release(SpawnSlot *slot)
+{
+    /* the pid of a joinable thread is kept until it is joined, so it names
+     * the slot unambiguously */
+    if (slot->pid != KERNEL_PID_UNDEF)
+        release_pid(slot->pid);
+
+    slot->pid = KERNEL_PID_UNDEF;
+    slot->state = SPAWN_FREE;
+    slot->next_free = spawn_free[slot->stack_class];
+    spawn_free[slot->stack_class] = slot;
+}
+
+kernel_pid_t ThreadScheduler::spawn(thread_handler_func_t func, void *arg, thread_stack_class_t stack_class,
+                                    uint8_t priority, int flags)
+{
+    if ((unsigned)stack_class >= THREAD_STACK_NUMOF)
+        return KERNEL_PID_UNDEF;
+
+    unsigned irqmask = cpu_irq_disable();
+    SpawnSlot *slot = spawn_free[stack_class];
+
+    if (slot == nullptr)
+    {
+        cpu_irq_restore(irqmask);
+        return KERNEL_PID_UNDEF;
+    }
+
+    spawn_free[stack_class] = slot->next_free;
+    slot->state = SPAWN_RUNNING;
+    slot->detached = (flags & THREAD_FLAGS_CREATE_DETACHED) != 0;
+    slot->joiner = KERNEL_PID_UNDEF;
+    slot->func = func;
+    slot->arg = arg;
+    slot->result = nullptr;
+
+    cpu_irq_restore(irqmask);
+
+    /* created asleep so the slot is attached before it can run, the stack
+     * is only painted again with THREAD_FLAGS_CREATE_STACKMARKER */
+    Thread *thread = Thread::init(slot->stack, slot->stack_size, spawn_entry, "spawn", priority, slot,
+                                  (flags & ~THREAD_FLAGS_CREATE_DETACHED) | THREAD_FLAGS_CREATE_SLEEPING);
+
+    irqmask = cpu_irq_disable();
+
+    if (thread == nullptr)
+    {
+        spawn_release(slot);
+        cpu_irq_restore(irqmask);
+        return KERNEL_PID_UNDEF;
+    }
+
+    thread->spawn_slot = slot;
+    slot->pid = thread->pid;
+
+    if (!(flags & THREAD_FLAGS_CREATE_SLEEPING))
+        set_thread_status(thread, THREAD_STATUS_PENDING);
+
+    kernel_pid_t pid = thread->pid;
+
+    cpu_irq_restore(irqmask);
+
+    if (!(flags & (THREAD_FLAGS_CREATE_SLEEPING | THREAD_FLAGS_CREATE_WOUT_YIELD)))
+        context_switch(priority);
+
+    return pid;
+}
+
+int ThreadScheduler::join(kernel_pid_t pid, void **result)
+{
+    unsigned irqmask = cpu_irq_disable();
+    Thread *current_thread = (Thread *)sched_active_thread;
+    SpawnSlot *slot = find_spawn_slot(pid);
+
+    if (slot == nullptr || slot->detached || slot->joiner != KERNEL_PID_UNDEF || pid == current_thread->pid)
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    if (slot->state != SPAWN_EXITED)
+    {
+        slot->joiner = current_thread->pid;
+        set_thread_status(current_thread, THREAD_STATUS_JOIN_BLOCKED);
+        cpu_irq_restore(irqmask);
+        yield_higher_priority_thread();
+        irqmask = cpu_irq_disable();
+
+        /* only spawn_finish() wakes a joiner */
+        vcassert(slot->state == SPAWN_EXITED);
+    }
+
+    if (result != nullptr)
+        *result = slot->result;
+
+    spawn_release(slot);
+
+    cpu_irq_restore(irqmask);
+
+    return 1;
+}
+
+int ThreadScheduler::detach(kernel_pid_t pid)
+{
+    unsigned irqmask = cpu_irq_disable();
+    SpawnSlot *slot = find_spawn_slot(pid);
+
+    if (slot == nullptr || slot->detached || slot->joiner != KERNEL_PID_UNDEF)
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    if (slot->state == SPAWN_EXITED)
+        spawn_release(slot);
+    else
+        slot->detached = true;
+
+    cpu_irq_restore(irqmask);
+
+    return 1;
+}
+#endif // #if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+void ThreadScheduler::update_time_slice(Core &core, Thread *thread, bool restart)
+{
+    Clist *queue = &core.runqueue[thread->priority];
+    uint32_t quantum = time_slice_quanta[thread->priority];
+
+#if VCRTOS_CONFIG_EDF_ENABLE
+    /* the EDF level is ordered by deadline, not rotated */
+    if (thread->priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        quantum = 0;
+#endif
+
+    /* the timer only runs while a peer waits at the same priority */
+    if (quantum != 0 && queue->next != nullptr && queue->next->next != queue->next)
+    {
+        if (restart || !core.time_slice_armed)
+        {
+            cpu_time_slice_start(quantum);
+            core.time_slice_armed = 1;
+        }
+    }
+    else if (core.time_slice_armed)
+    {
+        cpu_time_slice_stop();
+        core.time_slice_armed = 0;
+    }
+}
+
+void ThreadScheduler::time_slice_peer_woken(Thread *thread)
+{
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    unsigned core_id = thread->core;
+    Thread *running = (Thread *)sched_active_threads[core_id];
+#else
+    unsigned core_id = 0;
+    Thread *running = (Thread *)sched_active_thread;
+#endif
+
+    if (running == nullptr ||
+        running->status != THREAD_STATUS_RUNNING ||
+        running->priority != thread->priority ||
+        cores[core_id].time_slice_armed)
+    {
+        return;
+    }
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    /* the timer belongs to that core, its run() arms it */
+    if (core_id != cpu_core_id())
+    {
+        cpu_send_ipi(core_id);
+        return;
+    }
+#endif
+
+    update_time_slice(cores[core_id], running, false);
+}
+
+void ThreadScheduler::set_time_slice(uint8_t priority, uint32_t ticks)
+{
+    vcassert(priority < KERNEL_THREAD_PRIORITY_LEVELS);
+    unsigned irqmask = cpu_irq_disable();
+    time_slice_quanta[priority] = ticks;
+    cpu_irq_restore(irqmask);
+}
+
+void ThreadScheduler::time_slice_expired()
+{
+    unsigned irqmask = cpu_irq_disable();
+    Core &core = get_core();
+    Thread *current_thread = (Thread *)sched_active_thread;
+
+    core.time_slice_armed = 0;
+
+    if (current_thread != nullptr && current_thread->status == THREAD_STATUS_RUNNING)
+    {
+        Clist *queue = &core.runqueue[current_thread->priority];
+
+        /* the running thread is the head, the next peer takes over */
+        if (queue->next->next != queue->next)
+        {
+            queue->left_pop_right_push();
+            core.context_switch_request = 1;
+        }
+    }
+
+    cpu_irq_restore(irqmask);
+}
+#endif // #if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+void ThreadScheduler::msg_timeout_start(Thread *thread, uint32_t ticks)
+{
+    uint32_t now = cpu_get_timestamp();
+    MsgTimeout *timeout = &msg_timeouts[thread->pid];
+
+    if (timeout->deadline_slot >= 0)
+        msg_timeout_heap.remove(timeout);
+
+    timeout->deadline = now + ticks;
+    msg_timeout_heap.insert(timeout);
+
+    update_msg_timer(now);
+}
+
+void ThreadScheduler::msg_timeout_stop(Thread *thread)
+{
+    MsgTimeout *timeout = &msg_timeouts[thread->pid];
+
+    if (timeout->deadline_slot < 0)
+        return;
+
+    /* the timer only runs for the earliest one */
+    bool first = (msg_timeout_heap.top() == timeout);
+
+    msg_timeout_heap.remove(timeout);
+
+    if (first)
+        update_msg_timer(cpu_get_timestamp());
+}
+
+void ThreadScheduler::msg_timeout_expired()
+{
+    unsigned irqmask = cpu_irq_disable();
+    uint32_t now = cpu_get_timestamp();
+    MsgTimeout *timeout;
+
+    while ((timeout = msg_timeout_heap.top()) != nullptr && (int32_t)(timeout->deadline - now) <= 0)
+    {
+        msg_timeout_heap.remove(timeout);
+
+        /* armed ones belong to threads blocked in msg_receive_type() */
+        Thread *thread = threads_container[timeout - msg_timeouts];
+
+        /* tells msg_receive_type() nothing was delivered */
+        thread->wait_data = nullptr;
+        set_thread_status(thread, THREAD_STATUS_PENDING);
+        get_core().context_switch_request = 1;
+    }
+
+    update_msg_timer(now);
+
+    cpu_irq_restore(irqmask);
+}
+
+void ThreadScheduler::update_msg_timer(uint32_t now)
+{
+    MsgTimeout *timeout = msg_timeout_heap.top();
+
+    if (timeout != nullptr)
+    {
+        int32_t remaining = (int32_t)(timeout->deadline - now);
+
+        cpu_msg_timer_start((remaining > 0) ? (uint32_t)remaining : 1);
+    }
+    else
+    {
+        cpu_msg_timer_stop();
+    }
+}
+#endif // #if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+unsigned ThreadScheduler::get_core_priority(unsigned core)
+{
+    Thread *thread = (Thread *)sched_active_threads[core];
+
+    /* a core that has not started yet counts as idle */
+    return (thread != nullptr) ? thread->priority : KERNEL_THREAD_PRIORITY_IDLE;
+}
+
+unsigned ThreadScheduler::least_busy_core(Thread *thread)
+{
+    unsigned best = SMP_NUMOF_CORES;
+
+    for (unsigned core = 0; core < SMP_NUMOF_CORES; core++)
+    {
+        if (!thread->runs_on(core))
+            continue;
+
+        if (best == SMP_NUMOF_CORES || get_core_priority(core) > get_core_priority(best))
+            best = core;
+    }
+
+    return best;
+}
+
+unsigned ThreadScheduler::select_core(Thread *thread)
+{
+    unsigned home = thread->core;
+    unsigned local = cpu_core_id();
+
+    /* still switching out on its home core, run() there moves it if needed */
+    if (sched_active_threads[home] == thread)
+        return home;
+
+    /* the affinity was changed while the thread was blocked */
+    if (!thread->runs_on(home))
+        home = least_busy_core(thread);
+
+    /* stay on the home core, unless it is busy with something at least as
+     * urgent and the waking core would be preempted anyway */
+    if (home != local &&
+        thread->runs_on(local) &&
+        get_core_priority(home) <= thread->priority &&
+        get_core_priority(local) > thread->priority)
+    {
+        return local;
+    }
+
+    return home;
+}
+
+void ThreadScheduler::notify_core(Thread *thread)
+{
+    unsigned local = cpu_core_id();
+
+    if (get_core_priority(thread->core) > thread->priority
+#if VCRTOS_CONFIG_EDF_ENABLE
+        || preempts_by_deadline(thread, (Thread *)sched_active_threads[thread->core])
+#endif
+       )
+    {
+        /* the local core is switched by the caller */
+        if (thread->core != local)
+            cpu_send_ipi(thread->core);
+
+        return;
+    }
+
+    /* the home core is busy, wake an idle core to steal the thread */
+    for (unsigned core = 0; core < SMP_NUMOF_CORES; core++)
+    {
+        if (core != thread->core && thread->runs_on(core) &&
+            get_core_priority(core) == KERNEL_THREAD_PRIORITY_IDLE)
+        {
+            if (core != local)
+                cpu_send_ipi(core);
+
+            return;
+        }
+    }
+}
+
+void ThreadScheduler::steal()
+{
+    unsigned local = cpu_core_id();
+    Thread *victim = nullptr;
+
+    for (unsigned core = 0; core < SMP_NUMOF_CORES; core++)
+    {
+        if (core == local)
+            continue;
+
+        /* idle threads stay on their core */
+        for (unsigned priority = cores[core].runqueue_bitcache.next(0);
+             priority < KERNEL_THREAD_PRIORITY_IDLE;
+             priority = cores[core].runqueue_bitcache.next(priority + 1))
+        {
+            if (victim != nullptr && priority >= victim->priority)
+                break;
+
+            /* skip the thread running on that core */
+            Clist *queue = &cores[core].runqueue[priority];
+            Clist *node = queue->left_peek();
+
+            do
+            {
+                Thread *thread = static_cast<Thread *>(container_of(static_cast<list_node_t *>(node), thread_t, runqueue_entry));
+
+                if (thread->status == THREAD_STATUS_PENDING &&
+                    sched_active_threads[core] != thread &&
+                    thread->runs_on(local))
+                {
+                    victim = thread;
+                    break;
+                }
+
+                node = static_cast<Clist *>(node->next);
+            } while (node != queue->left_peek());
+
+            if (victim != nullptr && victim->core == core)
+                break;
+        }
+    }
+
+    if (victim != nullptr)
+        move_to_core(victim, local);
+}
+
+void ThreadScheduler::move_to_core(Thread *thread, unsigned core_id)
+{
+    Core &from = cores[thread->core];
+    Core &to = cores[core_id];
+    Clist *entry = static_cast<Clist *>(thread->get_runqueue_entry());
+
+    from.handoff = nullptr;
+    to.handoff = nullptr;
+    from.runqueue[thread->priority].remove(entry);
+    if (from.runqueue[thread->priority].next == nullptr)
+        from.runqueue_bitcache.clear(thread->priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (thread->priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        from.deadline_heap.remove(thread);
+#endif
+
+    thread->core = core_id;
+    to.runqueue[thread->priority].right_push(entry);
+    to.runqueue_bitcache.set(thread->priority);
+#if VCRTOS_CONFIG_EDF_ENABLE
+    if (thread->priority == VCRTOS_CONFIG_EDF_PRIORITY)
+        to.deadline_heap.insert(thread);
+#endif
+}
+
+int ThreadScheduler::set_thread_affinity(kernel_pid_t pid, thread_affinity_t affinity)
+{
+    affinity &= THREAD_AFFINITY_ALL;
+
+    if (affinity == 0)
+        return -1;
+
+    unsigned irqmask = cpu_irq_disable();
+    Thread *thread = get_thread_from_container(pid);
+
+    if (thread == nullptr)
+    {
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+
+    thread->affinity = affinity;
+
+    int yield = 0;
+
+    if (!thread->runs_on(thread->core))
+    {
+        if (sched_active_threads[thread->core] == thread)
+        {
+            /* running, its core hands it over in run() */
+            if (thread->core == cpu_core_id())
+                yield = 1;
+            else
+                cpu_send_ipi(thread->core);
+        }
+        else if (thread->status >= THREAD_STATUS_RUNNING)
+        {
+            move_to_core(thread, least_busy_core(thread));
+            notify_core(thread);
+        }
+        /* a blocked thread picks an allowed core when it is woken */
+    }
+
+    cpu_irq_restore(irqmask);
+
+    if (yield)
+        yield_higher_priority_thread();
+
+    return 1;
+}
+
+thread_affinity_t ThreadScheduler::get_thread_affinity(kernel_pid_t pid)
+{
+    vcassert(Thread::is_pid_valid(pid));
+    Thread *thread = get_thread_from_container(pid);
+    return (thread != nullptr) ? thread->affinity : 0;
+}
+#endif // #if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+
+void ThreadScheduler::sleep()
+{
+    if (cpu_is_in_isr())
+        return;
+
+    unsigned irqmask = cpu_irq_disable();
+    set_thread_status((Thread *)sched_active_thread, THREAD_STATUS_SLEEPING);
+    cpu_irq_restore(irqmask);
+    yield_higher_priority_thread();
+}
+
+int ThreadScheduler::wakeup_thread(kernel_pid_t pid)
+{
+    unsigned irqmask = cpu_irq_disable();
+    Thread *thread_to_wakeup = get_thread_from_container(pid);
+    if (!thread_to_wakeup)
+    {
+        //TODO: Warning thread does not exist!
+        cpu_irq_restore(irqmask);
+        return -1;
+    }
+    else if (thread_to_wakeup->status == THREAD_STATUS_SLEEPING)
+    {
+        set_thread_status(thread_to_wakeup, THREAD_STATUS_PENDING);
+        cpu_irq_restore(irqmask);
+        context_switch(thread_to_wakeup->priority);
+        return 1;
+    }
+    else
+    {
+        // TODO: Warning thread is not sleeping!
+        cpu_irq_restore(irqmask);
+        return 0;
+    }
+}
+
+void ThreadScheduler::yield()
+{
+    unsigned irqmask = cpu_irq_disable();
+    Thread *current_thread = (Thread *)sched_active_thread;
+
+    if (current_thread->status >= THREAD_STATUS_RUNNING)
+    {
+        Core &core = get_core(current_thread);
+        core.handoff = nullptr;
+        core.runqueue[current_thread->priority].left_pop_right_push();
+    }
+
+    cpu_irq_restore(irqmask);
+    yield_higher_priority_thread();
+}
+
+void ThreadScheduler::exit()
+{
+    /* never restored, interrupts come back with the next context, so it is
+     * kept out of the critical section profiler. On SMP the kernel lock is
+     * taken as well and dropped by cpu_switch_context_exit() */
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    (void)smp_irq_disable();
+#else
+    (void)(cpu_irq_disable)();
+#endif
+    Thread *thread = (Thread *)sched_active_thread;
+    threads_container[sched_active_pid] = nullptr;
+    numof_threads_in_container -= 1;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    release_ipc_waiters(thread);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    budget_group_unlink(thread);
+#endif
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+    msgbuf_pool.reclaim(thread->pid);
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    if (thread->spawn_slot != nullptr)
+    {
+        /* still running on the stack, run() hands it back */
+        SpawnSlot *slot = static_cast<SpawnSlot *>(thread->spawn_slot);
+        slot->state = SPAWN_EXITING;
+        get_core().spawn_zombie = slot;
+    }
+    else
+#endif
+    {
+        release_pid(sched_active_pid);
+    }
+    set_thread_status(thread, THREAD_STATUS_STOPPED);
+    sched_active_thread = nullptr;
+    // Note: user need to call cpu_switch_context_exit() after this function
+}
+
+void ThreadScheduler::terminate(kernel_pid_t pid)
+{
+    if (sched_active_pid == pid)
+    {
+        exit();
+        return;
+    }
+    unsigned irqmask = cpu_irq_disable();
+    Thread *thread = threads_container[pid];
+    threads_container[pid] = nullptr;
+    numof_threads_in_container -= 1;
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    release_ipc_waiters(thread);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    budget_group_unlink(thread);
+#endif
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+    msgbuf_pool.reclaim(thread->pid);
+#endif
+    set_thread_status(thread, THREAD_STATUS_STOPPED);
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    if (thread->spawn_slot != nullptr)
+        spawn_finish(static_cast<SpawnSlot *>(thread->spawn_slot));
+    else
+#endif
+        release_pid(pid);
+    cpu_irq_restore(irqmask);
+}
+
+const char *ThreadScheduler::thread_status_to_string(thread_status_t status)
+{
+    const char *retval;
+
+    switch (status)
+    {
+    case THREAD_STATUS_RUNNING:
+        retval = "running";
+        break;
+
+    case THREAD_STATUS_PENDING:
+        retval = "pending";
+        break;
+
+    case THREAD_STATUS_STOPPED:
+        retval = "stopped";
+        break;
+
+    case THREAD_STATUS_SLEEPING:
+        retval = "sleeping";
+        break;
+
+    case THREAD_STATUS_MUTEX_BLOCKED:
+        retval = "bl mutex";
+        break;
+
+    case THREAD_STATUS_RECEIVE_BLOCKED:
+        retval = "bl rx";
+        break;
+
+    case THREAD_STATUS_SEND_BLOCKED:
+        retval = "bl send";
+        break;
+
+    case THREAD_STATUS_REPLY_BLOCKED:
+        retval = "bl reply";
+        break;
+
+    case THREAD_STATUS_FLAG_BLOCKED_ANY:
+        retval = "bl flag";
+        break;
+
+    case THREAD_STATUS_FLAG_BLOCKED_ALL:
         retval = "bl flags";
         break;
 
+    case THREAD_STATUS_JOIN_BLOCKED:
+        retval = "bl join";
+        break;
+
     default:
         retval = "unknown";
         break;
@@ -480,6 +1853,112 @@ uint32_t ThreadScheduler::get_thread_schedules_stat(kernel_pid_t pid)
     return scheduler_stats[pid].schedules;
 }
 
+int ThreadScheduler::get_snapshot(thread_snapshot_t *snapshot, int size)
+{
+    int count = 0;
+
+    /* only plain copies are made with all threads held still */
+    unsigned irqmask = cpu_irq_disable();
+
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST && count < size; ++i)
+    {
+        Thread *thread = threads_container[i];
+
+        if (thread == nullptr)
+            continue;
+
+        thread_snapshot_t *entry = &snapshot[count++];
+
+        entry->pid = thread->pid;
+        entry->name = thread->name;
+        entry->status = thread->status;
+        entry->priority = thread->priority;
+        entry->stack_start = thread->stack_start;
+        entry->stack_size = thread->stack_size;
+        entry->stack_free = 0;
+        entry->msg_queue_depth = thread->numof_msg_in_queue();
+        entry->schedules = scheduler_stats[i].schedules;
+        entry->runtime_ticks = scheduler_stats[i].runtime_ticks;
+    }
+
+    cpu_irq_restore(irqmask);
+
+    /* one stack at a time like stack_monitor_sample(), a thread that is
+     * gone by now keeps 0 */
+    for (int i = 0; i < count; i++)
+    {
+        thread_snapshot_t *entry = &snapshot[i];
+
+        irqmask = cpu_irq_disable();
+        Thread *thread = threads_container[entry->pid];
+
+        if (thread != nullptr && thread->stack_start == entry->stack_start)
+            entry->stack_free = thread->get_stack_free();
+
+        cpu_irq_restore(irqmask);
+    }
+
+    return count;
+}
+
+uintptr_t ThreadScheduler::measure_stack_free(char *stack)
+{
+    /* the thread gives the end of the stack, which bounds the bisection */
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; ++i)
+    {
+        unsigned irqmask = cpu_irq_disable();
+        Thread *thread = threads_container[i];
+
+        if (thread != nullptr && thread->stack_start == stack)
+        {
+            uintptr_t space_free = thread->get_stack_free();
+            cpu_irq_restore(irqmask);
+            return space_free;
+        }
+
+        cpu_irq_restore(irqmask);
+    }
+
+    /* not the stack of a thread (anymore), without its size there is no end
+     * to scan to */
+    return 0;
+}
+
+uintptr_t ThreadScheduler::measure_stack_free(char *stack, size_t size)
+{
+    return StackMonitor::measure_free(stack, size);
+}
+
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+void ThreadScheduler::stack_monitor_sample()
+{
+    /* one thread at a time, so the interrupts are only held off for a
+     * single bisection */
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; ++i)
+    {
+        unsigned irqmask = cpu_irq_disable();
+        Thread *thread = threads_container[i];
+
+        if (thread != nullptr)
+        {
+            int used = (reinterpret_cast<char *>(thread) - thread->stack_start) - thread->get_stack_free();
+
+            if (used > stack_peaks[i])
+                stack_peaks[i] = used;
+        }
+
+        cpu_irq_restore(irqmask);
+    }
+}
+
+int ThreadScheduler::get_stack_peak(kernel_pid_t pid)
+{
+    vcassert(Thread::is_pid_valid(pid));
+    Thread *thread = get_thread_from_container(pid);
+    return (thread != nullptr) ? stack_peaks[pid] : -1;
+}
+#endif
+
 #if VCRTOS_CONFIG_THREAD_FLAGS_ENABLE
 thread_flags_t ThreadScheduler::thread_flags_clear_atomic(Thread *thread, thread_flags_t mask)
 {
@@ -549,7 +2028,7 @@ int ThreadScheduler::thread_flags_wake(Thread *thread)
     if (wakeup)
     {
         set_thread_status(thread, THREAD_STATUS_PENDING);
-        context_switch_request = 1;
+        get_core().context_switch_request = 1;
     }
     return wakeup;
 }
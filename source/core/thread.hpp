@@ -30,6 +30,14 @@
 #include "core/msg.hpp"
 #include "core/cib.hpp"
 #include "core/clist.hpp"
+#include "core/priority_bitmap.hpp"
+#include "core/stack_monitor.hpp"
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+#include "core/msgbuf_pool.hpp"
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+#include "core/deadline_heap.hpp"
+#endif
 
 namespace vc {
 
@@ -42,6 +50,7 @@ class Thread : public thread_t
     friend class ThreadScheduler;
     friend class Mutex;
     friend class Msg;
+    friend class MsgBus;
 
 public:
     Thread();
@@ -63,10 +72,26 @@ public:
     int numof_msg_in_queue();
     int has_msg_queue();
 
+    /* blocked in receive and waiting for a message like @p msg, a thread
+     * in msg_receive_type() compares the type bits of its mask */
+    int is_receiving(Msg *msg)
+    {
+        return status == THREAD_STATUS_RECEIVE_BLOCKED &&
+               ((msg->type ^ static_cast<Msg *>(wait_data)->type) & msg_type_mask) == 0;
+    }
+
     kernel_pid_t get_pid() { return pid; }
     unsigned get_priority() { return priority; }
     const char *get_name() { return name; }
     thread_status_t get_status() { return status; }
+    /* the stack ends where the thread control block starts */
+    int get_stack_free()
+    {
+        return StackMonitor::measure_free(stack_start, reinterpret_cast<char *>(this) - stack_start);
+    }
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    bool runs_on(unsigned core_id) { return (affinity & (1u << core_id)) != 0; }
+#endif
 };
 
 #if VCRTOS_CONFIG_THREAD_EVENT_ENABLE
@@ -104,23 +129,64 @@ class ThreadScheduler
 public:
     ThreadScheduler()
         : numof_threads_in_container(0)
-        , context_switch_request(0)
+        , free_pids_head(0)
+        , numof_free_pids(KERNEL_MAXTHREADS)
         , current_active_thread(nullptr)
         , current_active_pid(KERNEL_PID_UNDEF)
-        , runqueue_bitcache(0)
     {
         for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; ++i)
         {
             this->threads_container[i] = nullptr;
+            this->pid_generation[i] = 0;
+            /* handed out in ascending order first */
+            this->free_pids[i - KERNEL_PID_FIRST] = i;
 
             this->scheduler_stats[i].last_start = 0;
             this->scheduler_stats[i].schedules = 0;
             this->scheduler_stats[i].runtime_ticks = 0;
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+            this->msg_timeouts[i].deadline_slot = -1;
+#endif
+        }
+        for (unsigned core = 0; core < SMP_NUMOF_CORES; core++)
+        {
+            for (unsigned prio = 0; prio < KERNEL_THREAD_PRIORITY_LEVELS; prio++)
+            {
+                this->cores[core].runqueue[prio].next = nullptr;
+            }
+            this->cores[core].runqueue_bitcache.reset();
+            this->cores[core].context_switch_request = 0;
+            this->cores[core].handoff = nullptr;
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+            this->cores[core].time_slice_armed = 0;
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+            this->cores[core].budget_start = 0;
+            this->cores[core].budget_armed = 0;
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+            this->cores[core].spawn_zombie = nullptr;
+#endif
+        }
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+        init_spawn_pools();
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+        for (uint8_t group = 0; group < VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS; group++)
+        {
+            /* a period of 0 marks an unused group */
+            this->budget_groups[group].period = 0;
+            this->budget_groups[group].throttled = 0;
+            this->budget_groups[group].throttles = 0;
+            this->budget_groups[group].members = KERNEL_PID_UNDEF;
         }
-        for (uint8_t prio = 0; prio < KERNEL_THREAD_PRIORITY_LEVELS; prio++)
+#endif
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+        for (unsigned prio = 0; prio < KERNEL_THREAD_PRIORITY_LEVELS; prio++)
         {
-            this->scheduler_runqueue[prio].next = nullptr;
+            this->time_slice_quanta[prio] = VCRTOS_CONFIG_TIME_SLICE_TICKS;
         }
+#endif
     }
 
     static ThreadScheduler &init();
@@ -130,13 +196,29 @@ public:
     Thread *get_thread_from_container(kernel_pid_t pid) { return threads_container[pid]; }
     void add_thread(Thread *thread, kernel_pid_t pid) { threads_container[pid] = thread; }
     void add_numof_threads() { numof_threads_in_container += 1; }
-    int requested_context_switch() { return context_switch_request; }
-    void request_context_switch() { context_switch_request = 1; }
-    void set_context_switch_request(unsigned state) { context_switch_request = state; }
+    kernel_pid_t alloc_pid();
+    void release_pid(kernel_pid_t pid);
+    thread_handle_t get_handle(kernel_pid_t pid);
+    kernel_pid_t get_pid_from_handle(thread_handle_t handle);
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    kernel_pid_t spawn(thread_handler_func_t func, void *arg, thread_stack_class_t stack_class, uint8_t priority,
+                       int flags);
+    int join(kernel_pid_t pid, void **result);
+    int detach(kernel_pid_t pid);
+#endif
+    int requested_context_switch() { return get_core().context_switch_request; }
+    void request_context_switch() { get_core().context_switch_request = 1; }
+    void set_context_switch_request(unsigned state) { get_core().context_switch_request = state; }
     int numof_threads() { return numof_threads_in_container; }
     void run();
     void set_thread_status(Thread *thread, thread_status_t status);
     void context_switch(uint8_t priority_to_switch);
+    void set_handoff(Thread *thread);
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    void inherit_priority(Thread *waiter, Thread *server);
+    void add_ipc_client(Thread *client);
+    void release_priority(Thread *waiter);
+#endif
     void sleep();
     int wakeup_thread(kernel_pid_t pid);
     void yield();
@@ -144,6 +226,9 @@ public:
     void terminate(kernel_pid_t pid);
     static void yield_higher_priority_thread();
     static const char *thread_status_to_string(thread_status_t status);
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+    MsgBufPool &get_msgbuf_pool() { return msgbuf_pool; }
+#endif
 #if VCRTOS_CONFIG_THREAD_FLAGS_ENABLE
     void thread_flags_set(Thread *thread, thread_flags_t mask);
     thread_flags_t thread_flags_clear(thread_flags_t mask);
@@ -154,10 +239,166 @@ public:
 #endif
     uint64_t get_thread_runtime_ticks(kernel_pid_t pid);
     uint32_t get_thread_schedules_stat(kernel_pid_t pid);
+    int get_snapshot(thread_snapshot_t *snapshot, int size);
+    uintptr_t measure_stack_free(char *stack);
+    uintptr_t measure_stack_free(char *stack, size_t size);
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+    void stack_monitor_sample();
+    int get_stack_peak(kernel_pid_t pid);
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+    int set_deadline(kernel_pid_t pid, uint32_t deadline);
+    int renew_deadline(uint32_t relative_deadline);
+    uint32_t get_deadline_misses(kernel_pid_t pid);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    int budget_group_init(uint8_t group, uint32_t budget, uint32_t period, uint8_t background_priority);
+    int budget_group_join(kernel_pid_t pid, uint8_t group);
+    uint32_t budget_group_get_throttles(uint8_t group);
+    void budget_expired();
+#endif
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+    void set_time_slice(uint8_t priority, uint32_t ticks);
+    void time_slice_expired();
+#endif
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+    void msg_timeout_start(Thread *thread, uint32_t ticks);
+    void msg_timeout_stop(Thread *thread);
+    void msg_timeout_expired();
+#endif
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    int set_thread_affinity(kernel_pid_t pid, thread_affinity_t affinity);
+    thread_affinity_t get_thread_affinity(kernel_pid_t pid);
+#endif
 
 private:
+    enum
+    {
+        SMP_NUMOF_CORES = VCRTOS_CONFIG_SMP_NUMOF_CORES,
+    };
+
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    enum
+    {
+        SPAWN_NUMOF_SLOTS = VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF +
+                            VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF +
+                            VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF,
+    };
+
+    enum SpawnState
+    {
+        SPAWN_FREE,
+        SPAWN_RUNNING,
+        SPAWN_EXITING, /* thread gone, stack still in use until run() */
+        SPAWN_EXITED,  /* waiting to be joined, the pid stays reserved */
+    };
+
+    struct SpawnSlot
+    {
+        SpawnSlot *next_free;
+        char *stack;
+        int stack_size;
+        thread_stack_class_t stack_class;
+        SpawnState state;
+        bool detached;
+        kernel_pid_t pid;
+        kernel_pid_t joiner;
+        thread_handler_func_t func;
+        void *arg;
+        void *result;
+    };
+#endif
+
+    /* scheduling state of one core, a thread is queued on exactly one core */
+    struct Core
+    {
+        Clist runqueue[VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS];
+        PriorityBitmap<VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS> runqueue_bitcache;
+        unsigned int context_switch_request;
+        /* next thread already known to run() without a lookup, any other
+         * change to the runqueues of the core drops it */
+        Thread *handoff;
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+        uint8_t time_slice_armed;
+#endif
+#if VCRTOS_CONFIG_EDF_ENABLE
+        DeadlineHeap<thread_t> deadline_heap; /* ready threads of the EDF level */
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+        uint32_t budget_start; /* last time the running thread was charged */
+        uint8_t budget_armed;
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+        /* exited on this core, its stack is in use until the next run() */
+        SpawnSlot *spawn_zombie;
+#endif
+    };
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    struct BudgetGroup
+    {
+        uint32_t budget;
+        uint32_t period;
+        uint32_t remaining;
+        uint32_t period_start;
+        uint32_t throttles;
+        uint8_t background_priority;
+        uint8_t throttled;
+        kernel_pid_t members; /* first member, the others follow budget_next */
+    };
+#endif
+
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    Core &get_core() { return cores[cpu_core_id()]; }
+    Core &get_core(Thread *thread) { return cores[thread->core]; }
+    unsigned get_core_priority(unsigned core);
+    unsigned select_core(Thread *thread);
+    unsigned least_busy_core(Thread *thread);
+    void move_to_core(Thread *thread, unsigned core_id);
+    void notify_core(Thread *thread);
+    void steal();
+#else
+    Core &get_core() { return cores[0]; }
+    Core &get_core(Thread *thread) { (void)thread; return cores[0]; }
+#endif
+
     Thread *get_next_thread_from_runqueue();
-    static unsigned bitarithm_lsb(unsigned v);
+#if VCRTOS_CONFIG_EDF_ENABLE
+    bool preempts_by_deadline(Thread *thread, Thread *running);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE || VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    void change_priority(Thread *thread, uint8_t priority);
+    uint8_t effective_priority(Thread *thread);
+    void update_priority(Thread *thread);
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    Thread *requeue_ipc_waiter(Thread *thread);
+    void release_ipc_waiters(Thread *thread);
+#endif
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+    void update_msg_timer(uint32_t now);
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    void budget_charge(Core &core, Thread *thread, uint32_t now);
+    void budget_replenish(uint32_t now);
+    void budget_throttle(uint8_t group, bool throttle);
+    void budget_group_unlink(Thread *thread);
+    void update_budget_timer(Core &core, Thread *thread, uint32_t now);
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    void init_spawn_pools();
+    static void *spawn_entry(void *arg);
+    SpawnSlot *find_spawn_slot(kernel_pid_t pid);
+    void spawn_finish(SpawnSlot *slot);
+    void spawn_release(SpawnSlot *slot);
+#endif
+#if VCRTOS_CONFIG_STACK_CHECK_ENABLE
+    static void check_stack(Thread *thread);
+#endif
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+    void update_time_slice(Core &core, Thread *thread, bool restart);
+    void time_slice_peer_woken(Thread *thread);
+#endif
 #if VCRTOS_CONFIG_THREAD_FLAGS_ENABLE
     thread_flags_t thread_flags_clear_atomic(Thread *thread, thread_flags_t mask);
     void thread_flags_wait(thread_flags_t mask, Thread *thread, thread_status_t thread_status, unsigned irqstate);
@@ -165,13 +406,51 @@ private:
 #endif
 
     int numof_threads_in_container;
-    unsigned int context_switch_request;
     Thread *threads_container[KERNEL_PID_LAST + 1];
+    /* free pids in a ring, an exited pid is reused as late as possible */
+    kernel_pid_t free_pids[KERNEL_MAXTHREADS];
+    unsigned free_pids_head;
+    unsigned numof_free_pids;
+    uint16_t pid_generation[KERNEL_PID_LAST + 1];
     Thread *current_active_thread;
     kernel_pid_t current_active_pid;
-    Clist scheduler_runqueue[VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS];
-    uint32_t runqueue_bitcache;
+    Core cores[SMP_NUMOF_CORES];
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+    uint32_t time_slice_quanta[VCRTOS_CONFIG_THREAD_PRIORITY_LEVELS];
+#endif
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+    BudgetGroup budget_groups[VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS];
+#endif
+#if VCRTOS_CONFIG_THREAD_SPAWN_ENABLE
+    SpawnSlot spawn_slots[SPAWN_NUMOF_SLOTS];
+    SpawnSlot *spawn_free[THREAD_STACK_NUMOF];
+    alignas(8) char spawn_stacks_small[VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF][VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE];
+    alignas(8) char spawn_stacks_medium[VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF][VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_STACKSIZE];
+    alignas(8) char spawn_stacks_large[VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF][VCRTOS_CONFIG_THREAD_SPAWN_LARGE_STACKSIZE];
+#endif
     scheduler_stat_t scheduler_stats[KERNEL_PID_LAST + 1];
+#if VCRTOS_CONFIG_STACK_MONITOR_ENABLE
+    /* most stack bytes seen in use by the sampler, reset with the pid */
+    int stack_peaks[KERNEL_PID_LAST + 1];
+#endif
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+    MsgBufPool msgbuf_pool;
+#endif
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+    /* REPLY_BLOCKED clients whose request the server took, per server pid
+     * and ordered by priority, blocked senders are in its msg_waiters */
+    List ipc_clients[KERNEL_PID_LAST + 1];
+#endif
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+    /* end of a timed msg_receive_type(), armed while the thread waits in it */
+    struct MsgTimeout
+    {
+        uint32_t deadline;
+        int16_t deadline_slot; /* -1 when not armed */
+    };
+    MsgTimeout msg_timeouts[KERNEL_PID_LAST + 1];
+    DeadlineHeap<MsgTimeout> msg_timeout_heap; /* armed ones, the timer runs for the top */
+#endif
 };
 
 } // namespace vc
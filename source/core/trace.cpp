@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <vcrtos/config.h>
+#include <vcrtos/cpu.h>
+#include <vcrtos/thread.h>
+#include <vcrtos/trace.h>
+
+#include "core/code_utils.h"
+
+#if VCRTOS_CONFIG_TRACE_ENABLE
+
+enum
+{
+    TRACE_BUFFER_SIZE = VCRTOS_CONFIG_TRACE_BUFFER_SIZE,
+    TRACE_NUMOF_CORES = VCRTOS_CONFIG_SMP_NUMOF_CORES,
+};
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "trace buffer size must be a power of two");
+
+/* one ring per core, so writers on different cores never share the cache
+ * line of a head */
+struct TraceRing
+{
+    /* free running count of reserved slots, never wraps back to the start
+     * of the buffer so readers can tell how many events were overwritten */
+    uint32_t head;
+    trace_event_t buffer[TRACE_BUFFER_SIZE];
+};
+
+static TraceRing trace_rings[TRACE_NUMOF_CORES];
+static uint8_t trace_enabled = 1;
+
+static unsigned trace_core_id()
+{
+#if VCRTOS_CONFIG_SMP_NUMOF_CORES > 1
+    return cpu_core_id();
+#else
+    return 0;
+#endif
+}
+
+static uint32_t trace_retained(uint32_t head)
+{
+    return (head > static_cast<uint32_t>(TRACE_BUFFER_SIZE)) ? static_cast<uint32_t>(TRACE_BUFFER_SIZE) : head;
+}
+
+void trace_record(uint8_t type, kernel_pid_t pid, uint32_t arg)
+{
+    if (!__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED))
+        return;
+
+    unsigned core = trace_core_id();
+    TraceRing &ring = trace_rings[core];
+
+    /* slot reservation is the only shared update, writers from threads and
+     * interrupts never wait on each other */
+    uint32_t index = __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+    trace_event_t *event = &ring.buffer[index & (TRACE_BUFFER_SIZE - 1)];
+
+    event->timestamp = cpu_get_timestamp();
+    event->type = type;
+    event->core = static_cast<uint8_t>(core);
+    event->pid = pid;
+    event->arg = arg;
+}
+
+void trace_start()
+{
+    __atomic_store_n(&trace_enabled, 1, __ATOMIC_RELEASE);
+}
+
+void trace_stop()
+{
+    __atomic_store_n(&trace_enabled, 0, __ATOMIC_RELEASE);
+}
+
+void trace_clear()
+{
+    for (unsigned core = 0; core < TRACE_NUMOF_CORES; core++)
+    {
+        __atomic_store_n(&trace_rings[core].head, 0, __ATOMIC_RELEASE);
+    }
+}
+
+size_t trace_read(size_t offset, trace_event_t *events, size_t count)
+{
+    size_t copied = 0;
+
+    /* the rings are read one after the other, oldest event of each first */
+    for (unsigned core = 0; core < TRACE_NUMOF_CORES && copied < count; core++)
+    {
+        const TraceRing &ring = trace_rings[core];
+        uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+        uint32_t retained = trace_retained(head);
+
+        if (offset >= retained)
+        {
+            offset -= retained;
+            continue;
+        }
+
+        uint32_t first = head - retained + offset;
+        size_t n = retained - offset;
+
+        if (n > count - copied)
+        {
+            n = count - copied;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            events[copied + i] = ring.buffer[(first + i) & (TRACE_BUFFER_SIZE - 1)];
+        }
+
+        copied += n;
+        offset = 0;
+    }
+
+    return copied;
+}
+
+uint32_t trace_get_dropped()
+{
+    uint32_t dropped = 0;
+
+    for (unsigned core = 0; core < TRACE_NUMOF_CORES; core++)
+    {
+        uint32_t head = __atomic_load_n(&trace_rings[core].head, __ATOMIC_ACQUIRE);
+        dropped += head - trace_retained(head);
+    }
+
+    return dropped;
+}
+
+void trace_isr_enter(unsigned irq)
+{
+    VCRTOS_TRACE(TRACE_EVENT_ISR_ENTER, sched_active_pid, irq);
+}
+
+void trace_isr_exit()
+{
+    VCRTOS_TRACE(TRACE_EVENT_ISR_EXIT, sched_active_pid, 0);
+}
+
+#endif // #if VCRTOS_CONFIG_TRACE_ENABLE
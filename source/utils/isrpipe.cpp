@@ -15,6 +15,8 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <string.h>
+
 #include "utils/isrpipe.hpp"
 
 namespace vc {
@@ -33,6 +35,13 @@ int Isrpipe::write_one(char byte)
     return res;
 }
 
+int Isrpipe::write(const char *buf, size_t size)
+{
+    int res = get_tsrb().add(buf, size);
+    get_mutex().unlock();
+    return res;
+}
+
 int Isrpipe::read(char *buf, size_t size)
 {
     int res;
@@ -64,13 +73,26 @@ int Tsrb::get_one()
 
 int Tsrb::get(char *buf, size_t size)
 {
-    size_t tmp = size;
-    while (tmp && !is_empty())
-    {
-        *buf++ = pop();
-        tmp--;
-    }
-    return (size - tmp);
+    unsigned reads = _reads;
+    size_t count = _writes - reads;
+
+    if (size < count)
+        count = size;
+
+    /* copy at most two contiguous segments, then publish the new read index
+     * once so a concurrent writer never sees a partially consumed buffer */
+    size_t offset = reads & (_size - 1);
+    size_t first = _size - offset;
+
+    if (first > count)
+        first = count;
+
+    memcpy(buf, &_buf[offset], first);
+    memcpy(buf + first, _buf, count - first);
+
+    _reads = reads + count;
+
+    return count;
 }
 
 int Tsrb::drop(size_t size)
@@ -99,13 +121,24 @@ int Tsrb::add_one(char byte)
 
 int Tsrb::add(const char *buf, size_t size)
 {
-    size_t tmp = size;
-    while (tmp && !is_full())
-    {
-        push(*buf++);
-        tmp--;
-    }
-    return (size - tmp);
+    unsigned writes = _writes;
+    size_t count = _size - (writes - _reads);
+
+    if (size < count)
+        count = size;
+
+    size_t offset = writes & (_size - 1);
+    size_t first = _size - offset;
+
+    if (first > count)
+        first = count;
+
+    memcpy(&_buf[offset], buf, first);
+    memcpy(_buf, buf + first, count - first);
+
+    _writes = writes + count;
+
+    return count;
 }
 
 } // namespace utils
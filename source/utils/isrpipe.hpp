@@ -66,6 +66,7 @@ public:
     explicit Isrpipe(char *buf, unsigned int size);
 
     int write_one(char byte);
+    int write(const char *buf, size_t size);
     int read(char *buf, size_t size);
     Mutex &get_mutex() { return _mutex; }
     Tsrb &get_tsrb() { return _tsrb; }
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <vcrtos/config.h>
+#include <vcrtos/assert.h>
+#include <vcrtos/vcstdio.h>
+
+#if VCRTOS_CONFIG_VCSTDIO_HOST
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static int vcstdio_rx_fd = STDIN_FILENO;
+static int vcstdio_tx_fd = STDOUT_FILENO;
+
+void vcstdio_init()
+{
+}
+
+int vcstdio_host_set_fd(int rx_fd, int tx_fd)
+{
+    if (rx_fd < 0 || tx_fd < 0)
+        return -1;
+
+    vcstdio_rx_fd = rx_fd;
+    vcstdio_tx_fd = tx_fd;
+    return 0;
+}
+
+int vcstdio_host_open_pty(char *name, size_t size)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0)
+        return -1;
+
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    /* the cli does its own echo and line editing */
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    if (name != NULL && size > 0)
+    {
+        const char *slave = ptsname(fd);
+        strncpy(name, (slave != NULL) ? slave : "", size - 1);
+        name[size - 1] = '\0';
+    }
+
+    vcstdio_rx_fd = fd;
+    vcstdio_tx_fd = fd;
+
+    return fd;
+}
+
+ssize_t vcstdio_read(void *buffer, size_t count)
+{
+    ssize_t res;
+
+    do
+    {
+        res = read(vcstdio_rx_fd, buffer, count);
+    } while (res < 0 && errno == EINTR);
+
+    return res;
+}
+
+ssize_t vcstdio_write(const void *buffer, size_t len)
+{
+    const char *data = static_cast<const char *>(buffer);
+    size_t written = 0;
+
+    while (written < len)
+    {
+        ssize_t res = write(vcstdio_tx_fd, data + written, len - written);
+
+        if (res < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return (written > 0) ? static_cast<ssize_t>(written) : -1;
+        }
+
+        written += res;
+    }
+
+    return written;
+}
+
+#else // #if VCRTOS_CONFIG_VCSTDIO_HOST
+
+#include "core/code_utils.h"
+#include "core/new.hpp"
+
+#include "utils/isrpipe.hpp"
+
+using namespace vc;
+using namespace utils;
+
+namespace {
+
+class StdioTx
+{
+public:
+    StdioTx()
+        : _mutex()
+        , _tsrb(_buf, sizeof(_buf))
+    {
+    }
+
+    Mutex &get_mutex() { return _mutex; }
+    Tsrb &get_tsrb() { return _tsrb; }
+
+private:
+    Mutex _mutex;
+    Tsrb _tsrb;
+    char _buf[VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE];
+};
+
+} // namespace
+
+static DEFINE_ALIGNED_VAR(vcstdio_rx_raw, sizeof(UartIsrpipe), uint64_t);
+static DEFINE_ALIGNED_VAR(vcstdio_tx_raw, sizeof(StdioTx), uint64_t);
+
+static UartIsrpipe *vcstdio_rx = NULL;
+static StdioTx *vcstdio_tx = NULL;
+
+void vcstdio_init()
+{
+    vcstdio_rx = new (&vcstdio_rx_raw) UartIsrpipe();
+    vcstdio_tx = new (&vcstdio_tx_raw) StdioTx();
+    vcstdio_arch_init();
+}
+
+ssize_t vcstdio_read(void *buffer, size_t count)
+{
+    vcassert(vcstdio_rx != NULL);
+    return vcstdio_rx->read(static_cast<char *>(buffer), count);
+}
+
+ssize_t vcstdio_write(const void *buffer, size_t len)
+{
+    vcassert(vcstdio_tx != NULL);
+
+    const char *data = static_cast<const char *>(buffer);
+    size_t written = 0;
+
+#ifdef UNITTEST
+    written += vcstdio_tx->get_tsrb().add(data, len);
+    vcstdio_arch_tx_start();
+    if (written < len)
+    {
+        vcstdio_tx->get_mutex().lock();
+    }
+#else
+    while (1)
+    {
+        written += vcstdio_tx->get_tsrb().add(data + written, len - written);
+        vcstdio_arch_tx_start();
+
+        if (written == len)
+            break;
+
+        /* tx ring is full, wait for the uart interrupt to drain it */
+        vcstdio_tx->get_mutex().lock();
+    }
+#endif
+
+    return written;
+}
+
+int vcstdio_isr_rx(const char *data, size_t len)
+{
+    return vcstdio_rx->write(data, len);
+}
+
+int vcstdio_isr_tx(char *buffer, size_t size)
+{
+    int res = vcstdio_tx->get_tsrb().get(buffer, size);
+    if (res > 0)
+    {
+        vcstdio_tx->get_mutex().unlock();
+    }
+    return res;
+}
+
+#endif // #if VCRTOS_CONFIG_VCSTDIO_HOST
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "bench.hpp"
+
+namespace bench {
+
+static Case *cases_head = nullptr;
+static Case *cases_tail = nullptr;
+
+Case::Case(const char *case_name, case_func_t case_func)
+    : name(case_name)
+    , func(case_func)
+    , next(nullptr)
+{
+    /* keep registration order so the report follows the source file */
+    if (cases_tail)
+        cases_tail->next = this;
+    else
+        cases_head = this;
+
+    cases_tail = this;
+}
+
+static uint64_t percentile(const std::vector<uint64_t> &sorted, unsigned permille)
+{
+    size_t index = (sorted.size() * permille) / 1000;
+
+    if (index >= sorted.size())
+        index = sorted.size() - 1;
+
+    return sorted[index];
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-n iterations] [-w warmup] [-f filter] [--csv]\n", prog);
+}
+
+} // namespace bench
+
+using namespace bench;
+
+int main(int argc, char *argv[])
+{
+    unsigned iterations = 100000;
+    unsigned warmup = 1000;
+    const char *filter = nullptr;
+    bool csv = false;
+    int failures = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            iterations = (unsigned)strtoul(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            warmup = (unsigned)strtoul(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (iterations == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (csv)
+        printf("name,iterations,min_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,mean_ns\n");
+    else
+        printf("%-32s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+               "benchmark (ns)", "n", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+
+    for (Case *c = cases_head; c != nullptr; c = c->next)
+    {
+        if (filter && strstr(c->name, filter) == nullptr)
+            continue;
+
+        if (warmup)
+        {
+            Recorder warm(warmup);
+            c->func(warm);
+        }
+
+        Recorder recorder(iterations);
+        c->func(recorder);
+
+        std::vector<uint64_t> &samples = recorder.samples();
+
+        if (recorder.failure() || samples.empty())
+        {
+            fprintf(stderr, "%s: FAILED (%s)\n", c->name,
+                    recorder.failure() ? recorder.failure() : "no samples");
+            failures++;
+            continue;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        uint64_t total = 0;
+
+        for (uint64_t sample : samples)
+            total += sample;
+
+        const char *fmt = csv ? "%s,%u,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n"
+                              : "%-32s %8u %8llu %8llu %8llu %8llu %8llu %8llu %8llu\n";
+
+        printf(fmt, c->name, (unsigned)samples.size(),
+               (unsigned long long)samples.front(),
+               (unsigned long long)percentile(samples, 500),
+               (unsigned long long)percentile(samples, 900),
+               (unsigned long long)percentile(samples, 990),
+               (unsigned long long)percentile(samples, 999),
+               (unsigned long long)samples.back(),
+               (unsigned long long)(total / samples.size()));
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <stdint.h>
+
+#include <chrono>
+#include <vector>
+
+namespace bench {
+
+class Recorder
+{
+public:
+    explicit Recorder(unsigned iterations)
+        : _iterations(iterations)
+    {
+        _samples.reserve(iterations);
+    }
+
+    unsigned iterations() const { return _iterations; }
+
+    void begin() { _start = std::chrono::steady_clock::now(); }
+
+    void end()
+    {
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        _samples.push_back((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - _start).count());
+    }
+
+    /* marks the iteration as failed, the case is reported as broken */
+    void fail(const char *reason) { _failure = reason; }
+
+    const char *failure() const { return _failure; }
+
+    std::vector<uint64_t> &samples() { return _samples; }
+
+private:
+    unsigned _iterations;
+    const char *_failure = nullptr;
+    std::chrono::steady_clock::time_point _start;
+    std::vector<uint64_t> _samples;
+};
+
+typedef void (*case_func_t)(Recorder &recorder);
+
+class Case
+{
+public:
+    Case(const char *name, case_func_t func);
+
+    const char *name;
+    case_func_t func;
+    Case *next;
+};
+
+} // namespace bench
+
+#define BENCH_CASE(name)                                          \
+    static void bench_##name(bench::Recorder &recorder);          \
+    static bench::Case bench_case_##name(#name, &bench_##name);   \
+    static void bench_##name(bench::Recorder &recorder)
+
+#endif /* BENCH_HPP */
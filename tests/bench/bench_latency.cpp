@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+/*
+ * Wakeup latency of the kernel IPC primitives on the host port.
+ *
+ * There is no real context switch on the host: a pended PendSV is serviced
+ * by calling ThreadScheduler::run(), which is what the port does on return
+ * from the PendSV handler. A sample covers the time from the triggering call
+ * until the woken thread is the active one (and for events, until its
+ * handler returned), so it measures the kernel path only.
+ */
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/event.h>
+
+#include "core/msg.hpp"
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+#include "bench.hpp"
+
+using namespace vc;
+
+namespace {
+
+enum
+{
+    STACK_SIZE = 256,
+    MSG_QUEUE_SIZE = 32,
+    MSG_BURST = 32,
+};
+
+char idle_stack[STACK_SIZE];
+char main_stack[STACK_SIZE];
+char peer_stack[STACK_SIZE];
+
+Msg main_msg_queue[MSG_QUEUE_SIZE];
+Msg peer_msg_queue[MSG_QUEUE_SIZE];
+
+ThreadScheduler *scheduler;
+Thread *main_thread;
+Thread *peer_thread;
+
+/* idle and main are always present, the peer is the thread under test */
+void kernel_setup(unsigned peer_priority)
+{
+    test_helper_set_cpu_in_isr(0);
+    test_helper_reset_pendsv_trigger();
+
+    scheduler = &ThreadScheduler::init();
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    main_thread = Thread::init(main_stack, sizeof(main_stack), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+    main_thread->init_msg_queue(main_msg_queue, MSG_QUEUE_SIZE);
+
+    scheduler->run();
+
+    peer_thread = Thread::init(peer_stack, sizeof(peer_stack), nullptr, "peer", peer_priority);
+    peer_thread->init_msg_queue(peer_msg_queue, MSG_QUEUE_SIZE);
+}
+
+void pendsv()
+{
+    if (test_helper_is_pendsv_interrupt_triggered())
+    {
+        test_helper_reset_pendsv_trigger();
+        scheduler->run();
+    }
+}
+
+void isr_enter()
+{
+    test_helper_set_cpu_in_isr(1);
+}
+
+void isr_exit()
+{
+    cpu_end_of_isr();
+    test_helper_set_cpu_in_isr(0);
+    pendsv();
+}
+
+int is_running(Thread *thread)
+{
+    return sched_active_thread == thread;
+}
+
+struct BenchEvent : public Event
+{
+    void (*handler)(BenchEvent *event);
+    unsigned count;
+};
+
+void bench_event_handler(BenchEvent *event)
+{
+    event->count++;
+}
+
+} // namespace
+
+BENCH_CASE(isr_msg_send_to_receiver)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    Msg request;
+    Msg received;
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        /* receiver blocks, main is back */
+        received.receive();
+        pendsv();
+
+        if (!is_running(main_thread))
+            return recorder.fail("receiver did not block");
+
+        request.content.value = i;
+
+        recorder.begin();
+        isr_enter();
+        request.send(peer_thread->get_pid());
+        isr_exit();
+        recorder.end();
+
+        if (!is_running(peer_thread) || received.content.value != i)
+            return recorder.fail("receiver not woken");
+    }
+}
+
+BENCH_CASE(isr_thread_flags_to_waiter)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        scheduler->thread_flags_wait_any(0x1);
+        pendsv();
+
+        if (!is_running(main_thread))
+            return recorder.fail("waiter did not block");
+
+        recorder.begin();
+        isr_enter();
+        scheduler->thread_flags_set(peer_thread, 0x1);
+        isr_exit();
+        recorder.end();
+
+        if (!is_running(peer_thread) || scheduler->thread_flags_clear(0x1) != 0x1)
+            return recorder.fail("waiter not woken");
+    }
+}
+
+BENCH_CASE(event_post_to_handler)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EventQueue queue;
+    BenchEvent event;
+
+    event.handler = bench_event_handler;
+    event.count = 0;
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (queue.event_wait() != nullptr)
+            return recorder.fail("unexpected event");
+
+        pendsv();
+
+        if (!is_running(main_thread))
+            return recorder.fail("event thread did not block");
+
+        recorder.begin();
+        queue.event_post(&event, peer_thread);
+        pendsv();
+        /* the woken event loop consumes the flag and dispatches */
+        scheduler->thread_flags_clear(THREAD_FLAG_EVENT);
+        BenchEvent *pending = static_cast<BenchEvent *>(queue.event_get());
+        if (pending != nullptr)
+            pending->handler(pending);
+        recorder.end();
+
+        if (!is_running(peer_thread) || pending != &event || event.count != i + 1)
+            return recorder.fail("handler not run");
+    }
+}
+
+BENCH_CASE(mutex_unlock_to_waiter)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    Mutex mutex(MUTEX_INIT_UNLOCKED);
+
+    /* peer is not scheduled yet, main owns the mutex first */
+    mutex.lock();
+
+    scheduler->run();
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        mutex.lock();
+        pendsv();
+
+        if (!is_running(main_thread))
+            return recorder.fail("waiter did not block");
+
+        recorder.begin();
+        mutex.unlock();
+        pendsv();
+        recorder.end();
+
+        if (!is_running(peer_thread))
+            return recorder.fail("waiter not woken");
+
+        /* hand the mutex back to main and let the waiter try again */
+        mutex.unlock();
+        scheduler->sleep();
+        pendsv();
+        mutex.lock();
+        scheduler->wakeup_thread(peer_thread->get_pid());
+        pendsv();
+    }
+}
+
+BENCH_CASE(send_receive_reply_to_higher)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    Msg request;
+    Msg response;
+    Msg server_msg;
+    Msg server_reply;
+
+    /* server waits for the first request */
+    server_msg.receive();
+    pendsv();
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (!is_running(main_thread))
+            return recorder.fail("server did not block");
+
+        request.content.value = i;
+
+        recorder.begin();
+        request.send_receive(&response, peer_thread->get_pid());
+        pendsv();
+        /* server preempts the client, replies and waits again */
+        server_reply.content.value = server_msg.content.value + 1;
+        server_msg.reply(&server_reply);
+        server_msg.receive();
+        pendsv();
+        recorder.end();
+
+        if (!is_running(main_thread) || response.content.value != i + 1)
+            return recorder.fail("no reply");
+    }
+}
+
+BENCH_CASE(send_receive_reply_and_receive)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    Msg request;
+    Msg response;
+    Msg server_msg;
+    Msg server_reply;
+
+    server_msg.receive();
+    pendsv();
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (!is_running(main_thread))
+            return recorder.fail("server did not block");
+
+        request.content.value = i;
+
+        recorder.begin();
+        request.send_receive(&response, peer_thread->get_pid());
+        pendsv();
+        /* the reply and the next receive are one call and one switch */
+        server_reply.content.value = server_msg.content.value + 1;
+        server_msg.reply_and_receive(&server_reply);
+        pendsv();
+        recorder.end();
+
+        if (!is_running(main_thread) || response.content.value != i + 1)
+            return recorder.fail("no reply");
+    }
+}
+
+BENCH_CASE(send_receive_reply_to_lower)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    Msg request;
+    Msg response;
+    Msg server_msg;
+    Msg server_reply;
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (!is_running(main_thread))
+            return recorder.fail("client not running");
+
+        request.content.value = i;
+
+        /* the server is preempted right after each reply, so requests are
+         * taken from its queue */
+        recorder.begin();
+        request.send_receive(&response, peer_thread->get_pid());
+        pendsv();
+        server_msg.receive();
+        server_reply.content.value = server_msg.content.value + 1;
+        server_msg.reply(&server_reply);
+        pendsv();
+        recorder.end();
+
+        if (!is_running(main_thread) || response.content.value != i + 1)
+            return recorder.fail("no reply");
+    }
+}
+
+BENCH_CASE(msg_receive_burst)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    Msg burst[MSG_BURST];
+    Msg received;
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (Msg::send_batch(burst, MSG_BURST, main_thread->get_pid()) != MSG_BURST)
+            return recorder.fail("queue full");
+
+        recorder.begin();
+        for (unsigned j = 0; j < MSG_BURST; j++)
+            received.try_receive();
+        recorder.end();
+
+        if (main_thread->numof_msg_in_queue() != 0)
+            return recorder.fail("queue not drained");
+    }
+}
+
+BENCH_CASE(msg_receive_batch_burst)
+{
+    kernel_setup(KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    Msg burst[MSG_BURST];
+    Msg received[MSG_BURST];
+
+    for (unsigned i = 0; i < recorder.iterations(); i++)
+    {
+        if (Msg::send_batch(burst, MSG_BURST, main_thread->get_pid()) != MSG_BURST)
+            return recorder.fail("queue full");
+
+        recorder.begin();
+        int count = Msg::receive_batch(received, MSG_BURST, 0);
+        recorder.end();
+
+        if (count != MSG_BURST)
+            return recorder.fail("queue not drained");
+    }
+}
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <vcrtos/cpu.h>
+
+#include "sim.hpp"
+
+using namespace vc;
+
+namespace sim {
+
+Simulator *Simulator::_current = nullptr;
+
+Step compute(uint32_t ticks)
+{
+    return Step{STEP_COMPUTE, ticks, ticks, 0};
+}
+
+Step compute(uint32_t min, uint32_t max)
+{
+    return Step{STEP_COMPUTE, min, max, 0};
+}
+
+Step msg_receive()
+{
+    return Step{STEP_MSG_RECEIVE, 0, 0, 0};
+}
+
+Step msg_send(int thread)
+{
+    return Step{STEP_MSG_SEND, 0, 0, (uint32_t)thread};
+}
+
+Step mutex_lock(int mutex)
+{
+    return Step{STEP_MUTEX_LOCK, 0, 0, (uint32_t)mutex};
+}
+
+Step mutex_unlock(int mutex)
+{
+    return Step{STEP_MUTEX_UNLOCK, 0, 0, (uint32_t)mutex};
+}
+
+Step flags_wait(uint32_t mask)
+{
+    return Step{STEP_FLAGS_WAIT, 0, 0, mask};
+}
+
+Step delay(uint32_t ticks)
+{
+    return Step{STEP_DELAY, ticks, ticks, 0};
+}
+
+Step period(uint32_t ticks)
+{
+    return Step{STEP_PERIOD, ticks, ticks, 0};
+}
+
+uint64_t ThreadStats::percentile(unsigned permille)
+{
+    if (responses.empty())
+        return 0;
+
+    std::sort(responses.begin(), responses.end());
+
+    size_t index = (responses.size() * permille) / 1000;
+
+    if (index >= responses.size())
+        index = responses.size() - 1;
+
+    return responses[index];
+}
+
+Simulator::Simulator(uint32_t seed)
+    : _now(0)
+    , _seq(0)
+    , _events(0)
+    , _idle_ticks(0)
+    , _random(seed ? seed : 1)
+    , _in_isr(0)
+    , _switch_pending(0)
+{
+    _current = this;
+
+    memset(_by_pid, 0, sizeof(_by_pid));
+
+    _scheduler = &ThreadScheduler::init();
+
+    Thread::init(_idle_stack, sizeof(_idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+}
+
+Simulator::~Simulator()
+{
+    for (SimThread *st : _threads)
+        delete st;
+
+    for (Mutex *mutex : _mutexes)
+        delete mutex;
+
+    _current = nullptr;
+}
+
+bool Simulator::is_release_step(const Step &step)
+{
+    switch (step.type)
+    {
+    case STEP_MSG_RECEIVE:
+    case STEP_FLAGS_WAIT:
+    case STEP_DELAY:
+    case STEP_PERIOD:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+int Simulator::add_thread(const ThreadSpec &spec)
+{
+    bool advances = false;
+
+    /* a script that neither takes time nor blocks would spin forever */
+    for (const Step &step : spec.steps)
+    {
+        if (step.type == STEP_COMPUTE ? (step.max > 0) : (step.type != STEP_MSG_SEND && step.type != STEP_MUTEX_UNLOCK))
+            advances = true;
+    }
+
+    if (!advances)
+        return -1;
+
+    SimThread *st = new SimThread();
+
+    st->spec = spec;
+    st->index = (int)_threads.size();
+    st->thread = Thread::init(st->stack, sizeof(st->stack), nullptr, spec.name, spec.priority);
+
+    if (st->thread == nullptr)
+    {
+        delete st;
+        return -1;
+    }
+
+    st->thread->init_msg_queue(st->msg_queue, MSG_QUEUE_SIZE);
+    st->step = 0;
+    st->remaining = (spec.steps[0].type == STEP_COMPUTE) ? spec.steps[0].min + random(spec.steps[0].max - spec.steps[0].min) : 0;
+    st->waiting = false;
+    st->in_release = true;
+    st->has_release = false;
+    st->ready_time = _now;
+    st->release = _now;
+    st->last_release = _now;
+    st->stats.jobs = 0;
+    st->stats.deadline_misses = 0;
+    st->stats.runtime_ticks = 0;
+    st->stats.min_response = UINT64_MAX;
+    st->stats.max_response = 0;
+    st->stats.total_response = 0;
+
+    _by_pid[st->thread->get_pid()] = st;
+    _threads.push_back(st);
+
+    return st->index;
+}
+
+int Simulator::add_mutex()
+{
+    _mutexes.push_back(new Mutex(MUTEX_INIT_UNLOCKED));
+    return (int)_mutexes.size() - 1;
+}
+
+int Simulator::add_irq(const IrqSpec &spec)
+{
+    if (spec.target < 0 || spec.target >= (int)_threads.size())
+        return -1;
+
+    SimIrq irq;
+
+    irq.spec = spec;
+    irq.stats.count = 0;
+    irq.stats.dropped = 0;
+
+    _irqs.push_back(irq);
+    schedule(spec.first, EVENT_IRQ, (int)_irqs.size() - 1);
+
+    return (int)_irqs.size() - 1;
+}
+
+uint32_t Simulator::random(uint32_t max)
+{
+    if (max == 0)
+        return 0;
+
+    /* xorshift32, the same seed always gives the same run */
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+
+    return (max == UINT32_MAX) ? _random : _random % (max + 1);
+}
+
+uint64_t Simulator::expand_time(uint32_t low)
+{
+    /* messages carry the low half of their send time */
+    uint64_t time = (_now & ~(uint64_t)UINT32_MAX) | low;
+
+    if (time > _now)
+        time -= (uint64_t)UINT32_MAX + 1;
+
+    return time;
+}
+
+void Simulator::schedule(uint64_t time, EventType type, int index)
+{
+    _queue.push(Event{time, _seq++, type, index});
+}
+
+Simulator::SimThread *Simulator::active()
+{
+    if (sched_active_thread == nullptr)
+        return nullptr;
+
+    return _by_pid[sched_active_pid];
+}
+
+void Simulator::yield_higher()
+{
+    /* a pended switch is taken on the way out of the isr */
+    if (_in_isr)
+        _switch_pending = 1;
+    else
+        _scheduler->run();
+}
+
+void Simulator::isr_enter()
+{
+    _in_isr = 1;
+}
+
+void Simulator::isr_exit()
+{
+    cpu_end_of_isr();
+
+    _in_isr = 0;
+
+    if (_switch_pending)
+    {
+        _switch_pending = 0;
+        _scheduler->run();
+    }
+}
+
+void Simulator::mark_woken(uint64_t time)
+{
+    for (SimThread *st : _threads)
+    {
+        if (st->waiting && st->ready_time == UINT64_MAX &&
+            st->thread->get_status() >= THREAD_STATUS_RUNNING)
+        {
+            st->ready_time = time;
+        }
+    }
+}
+
+void Simulator::process_event()
+{
+    Event event = _queue.top();
+    _queue.pop();
+
+    _events++;
+
+    if (event.time > _now)
+        _now = event.time;
+
+    if (event.type == EVENT_IRQ)
+    {
+        SimIrq &irq = _irqs[event.index];
+        const IrqSpec &spec = irq.spec;
+
+        irq.stats.count++;
+
+        if (spec.period)
+            schedule(event.time + spec.period + random(spec.jitter), EVENT_IRQ, event.index);
+
+        /* the handler runs to completion before anything else */
+        _now += spec.isr_ticks;
+
+        Thread *target = _threads[spec.target]->thread;
+
+        isr_enter();
+
+        if (spec.action == IRQ_MSG_SEND)
+        {
+            irq.msg.content.value = (uint32_t)event.time;
+
+            if (irq.msg.send(target->get_pid()) != 1)
+                irq.stats.dropped++;
+        }
+        else
+        {
+            _scheduler->thread_flags_set(target, spec.value);
+        }
+
+        isr_exit();
+        mark_woken(event.time);
+    }
+    else
+    {
+        isr_enter();
+        _scheduler->wakeup_thread(_threads[event.index]->thread->get_pid());
+        isr_exit();
+        mark_woken(event.time);
+    }
+}
+
+void Simulator::execute(SimThread *st, const Step &step)
+{
+    switch (step.type)
+    {
+    case STEP_MSG_RECEIVE:
+        st->msg.receive();
+        break;
+
+    case STEP_MSG_SEND:
+        st->msg.content.value = (uint32_t)_now;
+        st->msg.send(_threads[step.target]->thread->get_pid());
+        break;
+
+    case STEP_MUTEX_LOCK:
+        _mutexes[step.target]->lock();
+        break;
+
+    case STEP_MUTEX_UNLOCK:
+        _mutexes[step.target]->unlock();
+        break;
+
+    case STEP_FLAGS_WAIT:
+        _scheduler->thread_flags_wait_any(step.target);
+        break;
+
+    case STEP_DELAY:
+        if (step.min)
+        {
+            schedule(_now + step.min, EVENT_TIMER, st->index);
+            _scheduler->sleep();
+        }
+        break;
+
+    case STEP_PERIOD:
+        if (st->has_release && st->last_release + step.min > _now)
+        {
+            schedule(st->last_release + step.min, EVENT_TIMER, st->index);
+            _scheduler->sleep();
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    mark_woken(_now);
+}
+
+void Simulator::complete_step(SimThread *st, bool blocked)
+{
+    const std::vector<Step> &steps = st->spec.steps;
+    const Step &step = steps[st->step];
+
+    /* under UNITTEST a blocking wait returns before the flags are set,
+     * consume them now that the thread runs again */
+    if (blocked && step.type == STEP_FLAGS_WAIT)
+        _scheduler->thread_flags_clear(step.target);
+
+    if (st->in_release && is_release_step(step))
+    {
+        if (step.type == STEP_MSG_RECEIVE)
+            st->release = expand_time(st->msg.content.value);
+        else if (step.type == STEP_PERIOD)
+            st->release = st->has_release ? st->last_release + step.min : st->release;
+        else
+            st->release = blocked ? st->ready_time : _now;
+    }
+
+    if (++st->step == steps.size())
+    {
+        uint64_t response = _now - st->release;
+
+        st->stats.jobs++;
+        st->stats.total_response += response;
+        st->stats.responses.push_back((uint32_t)response);
+
+        if (response < st->stats.min_response)
+            st->stats.min_response = response;
+
+        if (response > st->stats.max_response)
+            st->stats.max_response = response;
+
+        if (st->spec.deadline && response > st->spec.deadline)
+            st->stats.deadline_misses++;
+
+        st->last_release = st->release;
+        st->has_release = true;
+        st->release = _now;
+        st->in_release = true;
+        st->step = 0;
+    }
+
+    const Step &next = steps[st->step];
+
+    if (!is_release_step(next))
+        st->in_release = false;
+
+    if (next.type == STEP_COMPUTE)
+        st->remaining = next.min + random(next.max - next.min);
+}
+
+void Simulator::step_thread(SimThread *st, uint64_t until)
+{
+    if (st->waiting)
+    {
+        st->waiting = false;
+        complete_step(st, true);
+    }
+
+    while (active() == st)
+    {
+        const Step &step = st->spec.steps[st->step];
+
+        if (step.type == STEP_COMPUTE)
+        {
+            uint64_t budget = until - _now;
+
+            if (st->remaining > budget)
+            {
+                /* preempted by the next event */
+                st->remaining -= (uint32_t)budget;
+                st->stats.runtime_ticks += budget;
+                _now = until;
+                return;
+            }
+
+            _now += st->remaining;
+            st->stats.runtime_ticks += st->remaining;
+            st->remaining = 0;
+            complete_step(st, false);
+            continue;
+        }
+
+        execute(st, step);
+
+        if (st->thread->get_status() < THREAD_STATUS_RUNNING)
+        {
+            st->waiting = true;
+            st->ready_time = UINT64_MAX;
+            return;
+        }
+
+        complete_step(st, false);
+    }
+}
+
+void Simulator::run(uint64_t ticks)
+{
+    uint64_t end = _now + ticks;
+
+    if (sched_active_thread == nullptr)
+        _scheduler->run();
+
+    for (;;)
+    {
+        while (!_queue.empty() && _queue.top().time <= _now)
+            process_event();
+
+        if (_now >= end)
+            break;
+
+        uint64_t next = _queue.empty() ? end : std::min(_queue.top().time, end);
+        SimThread *st = active();
+
+        if (st == nullptr)
+        {
+            _idle_ticks += next - _now;
+            _now = next;
+        }
+        else
+        {
+            step_thread(st, next);
+        }
+    }
+}
+
+void Simulator::report(FILE *out)
+{
+    fprintf(out, "time %llu ticks, %llu events, idle %llu.%llu%%\n",
+            (unsigned long long)_now, (unsigned long long)_events,
+            (unsigned long long)(_now ? (_idle_ticks * 100) / _now : 0),
+            (unsigned long long)(_now ? ((_idle_ticks * 1000) / _now) % 10 : 0));
+
+    fprintf(out, "%-12s %4s %10s %8s %8s %8s %8s %8s %8s %6s\n",
+            "thread", "prio", "jobs", "min", "p50", "p99", "max", "mean", "misses", "cpu%");
+
+    for (SimThread *st : _threads)
+    {
+        ThreadStats &stats = st->stats;
+
+        fprintf(out, "%-12s %4u %10llu %8llu %8llu %8llu %8llu %8llu %8llu %6llu\n",
+                st->spec.name, st->spec.priority,
+                (unsigned long long)stats.jobs,
+                (unsigned long long)(stats.jobs ? stats.min_response : 0),
+                (unsigned long long)stats.percentile(500),
+                (unsigned long long)stats.percentile(990),
+                (unsigned long long)stats.max_response,
+                (unsigned long long)(stats.jobs ? stats.total_response / stats.jobs : 0),
+                (unsigned long long)stats.deadline_misses,
+                (unsigned long long)(_now ? (stats.runtime_ticks * 100) / _now : 0));
+    }
+
+    for (SimIrq &irq : _irqs)
+    {
+        fprintf(out, "irq %-8s count %llu dropped %llu\n", irq.spec.name,
+                (unsigned long long)irq.stats.count, (unsigned long long)irq.stats.dropped);
+    }
+}
+
+} // namespace sim
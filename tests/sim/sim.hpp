@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef SIM_HPP
+#define SIM_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <queue>
+#include <vector>
+
+#include "core/msg.hpp"
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+namespace sim {
+
+/* one step of a thread workload, scripts are repeated forever */
+enum StepType
+{
+    STEP_COMPUTE,     /* busy for [min, max] ticks, preemptible */
+    STEP_MSG_RECEIVE, /* blocking msg receive, releases at the send time */
+    STEP_MSG_SEND,    /* blocking msg send to thread index `target` */
+    STEP_MUTEX_LOCK,  /* lock mutex index `target` */
+    STEP_MUTEX_UNLOCK,
+    STEP_FLAGS_WAIT,  /* wait any of the flags in `target` */
+    STEP_DELAY,       /* sleep for `min` ticks */
+    STEP_PERIOD,      /* sleep until `min` ticks after the previous release,
+                       * the first release is when the thread was added */
+};
+
+struct Step
+{
+    StepType type;
+    uint32_t min;
+    uint32_t max;
+    uint32_t target;
+};
+
+Step compute(uint32_t ticks);
+Step compute(uint32_t min, uint32_t max);
+Step msg_receive();
+Step msg_send(int thread);
+Step mutex_lock(int mutex);
+Step mutex_unlock(int mutex);
+Step flags_wait(uint32_t mask);
+Step delay(uint32_t ticks);
+Step period(uint32_t ticks);
+
+struct ThreadSpec
+{
+    const char *name;
+    unsigned priority;
+    std::vector<Step> steps;
+    uint32_t deadline; /* relative to the release, 0 for none */
+};
+
+enum IrqAction
+{
+    IRQ_MSG_SEND,  /* msg to thread index `target` from the isr */
+    IRQ_FLAGS_SET, /* set `value` flags on thread index `target` */
+};
+
+struct IrqSpec
+{
+    const char *name;
+    uint64_t first;
+    uint32_t period;
+    uint32_t jitter;    /* uniform [0, jitter] added to each arrival */
+    uint32_t isr_ticks; /* cpu time spent in the handler */
+    IrqAction action;
+    int target;
+    uint32_t value;
+};
+
+struct ThreadStats
+{
+    uint64_t jobs;
+    uint64_t deadline_misses;
+    uint64_t runtime_ticks;
+    uint64_t min_response;
+    uint64_t max_response;
+    uint64_t total_response;
+    std::vector<uint32_t> responses;
+
+    /* permille of the sorted response times, 0 if there was no job */
+    uint64_t percentile(unsigned permille);
+};
+
+struct IrqStats
+{
+    uint64_t count;
+    uint64_t dropped; /* target queue was full */
+};
+
+/**
+ * Deterministic discrete-event simulation of the scheduler.
+ *
+ * A virtual CPU runs the real kernel against a virtual clock: interrupts
+ * arrive as scripted, thread workloads consume virtual time and every
+ * thread_arch_yield_higher() runs the scheduler right away, as a PendSV
+ * would. The kernel is a singleton, so only one simulator can exist at a
+ * time. Runs with the same seed and specs give the same results.
+ */
+class Simulator
+{
+public:
+    explicit Simulator(uint32_t seed = 1);
+    ~Simulator();
+
+    int add_thread(const ThreadSpec &spec);
+    int add_mutex();
+    int add_irq(const IrqSpec &spec);
+
+    void run(uint64_t ticks);
+
+    uint64_t now() { return _now; }
+    uint64_t idle_ticks() { return _idle_ticks; }
+    uint64_t events() { return _events; }
+    ThreadStats &thread_stats(int thread) { return _threads[thread]->stats; }
+    IrqStats &irq_stats(int irq) { return _irqs[irq].stats; }
+
+    void report(FILE *out);
+
+    /* port interface */
+    static Simulator *get() { return _current; }
+    int in_isr() { return _in_isr; }
+    void yield_higher();
+
+private:
+    enum
+    {
+        STACK_SIZE = 512,
+        MSG_QUEUE_SIZE = 8,
+    };
+
+    enum EventType
+    {
+        EVENT_IRQ,
+        EVENT_TIMER,
+    };
+
+    struct Event
+    {
+        uint64_t time;
+        uint64_t seq;
+        EventType type;
+        int index;
+
+        bool operator>(const Event &other) const
+        {
+            return (time != other.time) ? (time > other.time) : (seq > other.seq);
+        }
+    };
+
+    struct SimThread
+    {
+        ThreadSpec spec;
+        int index;
+        vc::Thread *thread;
+        char stack[STACK_SIZE];
+        vc::Msg msg_queue[MSG_QUEUE_SIZE];
+        vc::Msg msg;
+        size_t step;
+        uint32_t remaining;
+        bool waiting;
+        bool in_release;
+        bool has_release;
+        uint64_t ready_time;
+        uint64_t release;
+        uint64_t last_release;
+        ThreadStats stats;
+    };
+
+    struct SimIrq
+    {
+        IrqSpec spec;
+        vc::Msg msg;
+        IrqStats stats;
+    };
+
+    SimThread *active();
+    void schedule(uint64_t time, EventType type, int index);
+    void process_event();
+    void isr_enter();
+    void isr_exit();
+    void mark_woken(uint64_t time);
+    void step_thread(SimThread *st, uint64_t until);
+    void execute(SimThread *st, const Step &step);
+    void complete_step(SimThread *st, bool blocked);
+    static bool is_release_step(const Step &step);
+    uint32_t random(uint32_t max);
+    uint64_t expand_time(uint32_t low);
+
+    static Simulator *_current;
+
+    uint64_t _now;
+    uint64_t _seq;
+    uint64_t _events;
+    uint64_t _idle_ticks;
+    uint32_t _random;
+    int _in_isr;
+    int _switch_pending;
+    vc::ThreadScheduler *_scheduler;
+    char _idle_stack[STACK_SIZE];
+    std::vector<SimThread *> _threads;
+    SimThread *_by_pid[KERNEL_PID_LAST + 1];
+    std::vector<vc::Mutex *> _mutexes;
+    std::vector<SimIrq> _irqs;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> _queue;
+};
+
+} // namespace sim
+
+#endif /* SIM_HPP */
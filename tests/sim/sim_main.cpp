@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+/*
+ * Example: the same workload under two priority assignments.
+ *
+ * A sensor interrupt feeds a handler thread over msg, a control loop and a
+ * logger share a mutex and a background task burns the rest. The first run
+ * uses rate monotonic priorities, the second one inverts them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.hpp"
+
+using namespace sim;
+
+static void scenario(Simulator &simulator, bool rate_monotonic)
+{
+    unsigned high = KERNEL_THREAD_PRIORITY_MAIN - 3;
+    unsigned mid = KERNEL_THREAD_PRIORITY_MAIN - 2;
+    unsigned low = KERNEL_THREAD_PRIORITY_MAIN - 1;
+
+    int bus = simulator.add_mutex();
+
+    int sensor = simulator.add_thread(ThreadSpec{
+        "sensor", rate_monotonic ? high : low,
+        {msg_receive(), compute(40, 120)},
+        500});
+
+    simulator.add_thread(ThreadSpec{
+        "control", mid,
+        {period(2000), compute(200, 400), mutex_lock(bus), compute(50), mutex_unlock(bus)},
+        2000});
+
+    simulator.add_thread(ThreadSpec{
+        "logger", rate_monotonic ? low : high,
+        {period(10000), mutex_lock(bus), compute(300, 900), mutex_unlock(bus)},
+        10000});
+
+    simulator.add_thread(ThreadSpec{
+        "background", KERNEL_THREAD_PRIORITY_MAIN,
+        {compute(1000)},
+        0});
+
+    simulator.add_irq(IrqSpec{"sensor", 100, 1000, 200, 10, IRQ_MSG_SEND, sensor, 0});
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t ticks = 100000000;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            ticks = strtoull(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else
+        {
+            printf("usage: %s [-t ticks] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        Simulator simulator(seed);
+
+        scenario(simulator, pass == 0);
+        simulator.run(ticks);
+
+        printf("%s\n", pass == 0 ? "rate monotonic" : "inverted");
+        simulator.report(stdout);
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+/*
+ * Host port for the simulator: interrupts are never really masked, the
+ * clock is the virtual one and a requested context switch runs the
+ * scheduler immediately instead of pending a PendSV.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/thread.h>
+
+#include "sim.hpp"
+
+extern "C" {
+
+unsigned (cpu_irq_disable)(void)
+{
+    return 0;
+}
+
+unsigned cpu_irq_enable(void)
+{
+    return 0;
+}
+
+void (cpu_irq_restore)(unsigned state)
+{
+    (void)state;
+}
+
+int cpu_is_in_isr(void)
+{
+    return sim::Simulator::get()->in_isr();
+}
+
+uint32_t cpu_get_timestamp(void)
+{
+    return (uint32_t)sim::Simulator::get()->now();
+}
+
+void cpu_trigger_pendsv_interrupt(void)
+{
+    sim::Simulator::get()->yield_higher();
+}
+
+void cpu_switch_context_exit(void)
+{
+}
+
+#if VCRTOS_CONFIG_TIME_SLICE_ENABLE
+/* time slices are not modelled, threads of one priority rotate only when
+ * they block or yield */
+void cpu_time_slice_start(uint32_t ticks)
+{
+    (void)ticks;
+}
+
+void cpu_time_slice_stop(void)
+{
+}
+#endif
+
+#if VCRTOS_CONFIG_CPU_BUDGET_ENABLE
+/* budgets are not enforced, throttling only happens when the kernel charges
+ * a thread on a switch */
+void cpu_budget_timer_start(uint32_t ticks)
+{
+    (void)ticks;
+}
+
+void cpu_budget_timer_stop(void)
+{
+}
+#endif
+
+#if VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE
+/* message timeouts are not modelled, a timed wait ends with a matching
+ * message only */
+void cpu_msg_timer_start(uint32_t ticks)
+{
+    (void)ticks;
+}
+
+void cpu_msg_timer_stop(void)
+{
+}
+#endif
+
+#if VCRTOS_CONFIG_STACK_CHECK_ENABLE
+void cpu_stack_overflow(void *thread)
+{
+    (void)thread;
+    abort();
+}
+#endif
+
+void thread_arch_yield_higher(void)
+{
+    sim::Simulator::get()->yield_higher();
+}
+
+char *thread_arch_stack_init(thread_handler_func_t func, void *arg, void *stack_start, int size)
+{
+    (void)func;
+    (void)arg;
+    (void)size;
+    return (char *)stack_start;
+}
+
+} // extern "C"
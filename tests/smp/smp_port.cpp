@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+/*
+ * Host port for the SMP tests: every core is a pthread, every kernel thread
+ * a ucontext that the cores switch into. Interrupts are emulated by a per
+ * core nesting count, a context switch requested while it is non zero or an
+ * IPI from another core is taken when the count drops back to zero, or when
+ * the idle thread of the core polls it. There is no asynchronous preemption,
+ * a thread that never enters the kernel keeps its core.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/thread.h>
+
+#include "smp_port.hpp"
+
+namespace {
+
+/* placed below the thread control block, thread->stack_pointer points to it */
+struct ThreadStart
+{
+    ucontext_t context;
+    thread_handler_func_t func;
+    void *arg;
+};
+
+struct Core
+{
+    pthread_t pthread;
+    ucontext_t context; /* scheduler loop of the core */
+    int irq_depth;
+    int switch_pending;
+    int scheduling;
+    std::atomic<int> ipi;
+    char idle_stack[SMP_PORT_STACKSIZE];
+};
+
+Core cores[VCRTOS_CONFIG_SMP_NUMOF_CORES];
+std::atomic<bool> running(false);
+pthread_key_t core_key;
+pthread_once_t core_key_once = PTHREAD_ONCE_INIT;
+
+void make_core_key()
+{
+    pthread_key_create(&core_key, nullptr);
+}
+
+/* kernel threads move between pthreads, so the core is looked up on every
+ * call instead of caching a thread_local address across a switch */
+Core &current_core()
+{
+    return cores[cpu_core_id()];
+}
+
+ThreadStart *get_start(void *thread)
+{
+    return reinterpret_cast<ThreadStart *>(static_cast<thread_t *>(thread)->stack_pointer);
+}
+
+void switch_to_scheduler()
+{
+    Core &core = current_core();
+    void *thread = sched_active_thread;
+
+    core.switch_pending = 0;
+
+    if (thread == nullptr)
+    {
+        /* the thread has exited, its context is not needed anymore */
+        setcontext(&core.context);
+    }
+
+    swapcontext(&get_start(thread)->context, &core.context);
+}
+
+void thread_trampoline()
+{
+    ThreadStart *start = get_start(sched_active_thread);
+
+    start->func(start->arg);
+
+    thread_exit();
+    cpu_switch_context_exit();
+}
+
+void *idle_handler(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        Core &core = current_core();
+
+        /* kernel threads hop between pthreads, so no pthread primitive is
+         * held across a switch, the idle core polls its IPI flag instead */
+        while (!core.ipi.load() && running.load())
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+
+        thread_arch_yield_higher();
+    }
+
+    return nullptr;
+}
+
+void *core_main(void *arg)
+{
+    unsigned id = static_cast<unsigned>(reinterpret_cast<uintptr_t>(arg));
+
+    pthread_setspecific(core_key, reinterpret_cast<void *>(static_cast<uintptr_t>(id + 1)));
+
+    Core &core = cores[id];
+
+    /* no context to switch from yet, IPIs are taken by the first run() */
+    core.scheduling = 1;
+    thread_create(core.idle_stack, sizeof(core.idle_stack), idle_handler, "idle",
+                  KERNEL_THREAD_PRIORITY_IDLE, nullptr, THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_PINNED);
+
+    while (running.load())
+    {
+        core.scheduling = 1;
+        core.ipi.store(0);
+
+        unsigned state = smp_irq_disable();
+        thread_scheduler_run();
+        void *thread = sched_active_thread;
+        smp_irq_restore(state);
+
+        core.scheduling = 0;
+        core.switch_pending = 0;
+
+        swapcontext(&core.context, &get_start(thread)->context);
+    }
+
+    return nullptr;
+}
+
+} // namespace
+
+void smp_port_start()
+{
+    pthread_once(&core_key_once, make_core_key);
+    running.store(true);
+
+    for (unsigned id = 0; id < VCRTOS_CONFIG_SMP_NUMOF_CORES; id++)
+    {
+        Core &core = cores[id];
+
+        core.irq_depth = 0;
+        core.switch_pending = 0;
+        core.scheduling = 0;
+        core.ipi.store(0);
+        pthread_create(&core.pthread, nullptr, core_main, reinterpret_cast<void *>(static_cast<uintptr_t>(id)));
+    }
+}
+
+void smp_port_stop()
+{
+    running.store(false);
+
+    for (unsigned id = 0; id < VCRTOS_CONFIG_SMP_NUMOF_CORES; id++)
+    {
+        pthread_join(cores[id].pthread, nullptr);
+    }
+}
+
+extern "C" {
+
+unsigned cpu_core_id(void)
+{
+    pthread_once(&core_key_once, make_core_key);
+
+    /* threads outside of the cores, like main() setting up, count as core 0 */
+    uintptr_t id = reinterpret_cast<uintptr_t>(pthread_getspecific(core_key));
+    return (id != 0) ? static_cast<unsigned>(id - 1) : 0;
+}
+
+void cpu_send_ipi(unsigned id)
+{
+    cores[id].ipi.store(1);
+}
+
+unsigned (cpu_irq_disable)(void)
+{
+    current_core().irq_depth++;
+    return 0;
+}
+
+unsigned cpu_irq_enable(void)
+{
+    current_core().irq_depth = 0;
+    return 0;
+}
+
+void (cpu_irq_restore)(unsigned state)
+{
+    (void)state;
+
+    Core &core = current_core();
+
+    if (--core.irq_depth > 0 || core.scheduling || !running.load())
+        return;
+
+    if (core.ipi.exchange(0))
+        core.switch_pending = 1;
+
+    if (core.switch_pending)
+        switch_to_scheduler();
+}
+
+int cpu_is_in_isr(void)
+{
+    return 0;
+}
+
+uint32_t cpu_get_timestamp(void)
+{
+    return 0;
+}
+
+void cpu_trigger_pendsv_interrupt(void)
+{
+    thread_arch_yield_higher();
+}
+
+void cpu_switch_context_exit(void)
+{
+    /* drop the kernel lock taken by ThreadScheduler::exit() */
+    smp_irq_restore(0);
+    setcontext(&current_core().context);
+}
+
+void thread_arch_yield_higher(void)
+{
+    Core &core = current_core();
+
+    if (core.irq_depth > 0 || core.scheduling)
+    {
+        core.switch_pending = 1;
+        return;
+    }
+
+    switch_to_scheduler();
+}
+
+char *thread_arch_stack_init(thread_handler_func_t func, void *arg, void *stack_start, int size)
+{
+    /* the thread control block sits right above size */
+    uintptr_t top = (reinterpret_cast<uintptr_t>(stack_start) + size - sizeof(ThreadStart)) & ~static_cast<uintptr_t>(15);
+    ThreadStart *start = reinterpret_cast<ThreadStart *>(top);
+    /* keep the stack guard word at stack_start intact */
+    char *bottom = static_cast<char *>(stack_start) + 16;
+
+    start->func = func;
+    start->arg = arg;
+
+    getcontext(&start->context);
+    start->context.uc_stack.ss_sp = bottom;
+    start->context.uc_stack.ss_size = reinterpret_cast<char *>(start) - bottom;
+    start->context.uc_link = nullptr;
+    makecontext(&start->context, thread_trampoline, 0);
+
+    return reinterpret_cast<char *>(start);
+}
+
+void thread_arch_stack_print(void)
+{
+}
+
+int thread_arch_isr_stack_usage(void)
+{
+    return 0;
+}
+
+void *thread_arch_isr_stack_pointer(void)
+{
+    return nullptr;
+}
+
+void *thread_arch_isr_stack_start(void)
+{
+    return nullptr;
+}
+
+} // extern "C"
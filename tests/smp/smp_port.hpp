@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_SMP_PORT_HPP
+#define VCRTOS_SMP_PORT_HPP
+
+/* ucontext stacks run plain host code (printf, gtest), keep them large */
+#define SMP_PORT_STACKSIZE (64 * 1024)
+
+/* start one pthread per core, threads created before are queued on core 0
+ * and spread by work stealing */
+void smp_port_start();
+
+/* stop the cores once they are idle and join them */
+void smp_port_stop();
+
+#endif /* VCRTOS_SMP_PORT_HPP */
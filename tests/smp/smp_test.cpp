@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+/*
+ * SMP scheduler tests, run on the pthread port in smp_port.cpp. Every case
+ * starts from a fresh scheduler with its threads queued on core 0, starts
+ * the cores and waits until all threads finished.
+ */
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/msg.h>
+#include <vcrtos/mutex.h>
+#include <vcrtos/thread.h>
+#include <vcrtos/trace.h>
+
+#include "core/msg.hpp"
+#include "core/thread.hpp"
+
+#include "smp_port.hpp"
+
+using namespace vc;
+
+#define NUMOF_WORKERS 8
+#define WORKER_PRIORITY (KERNEL_THREAD_PRIORITY_MAIN)
+#define ALL_CORES ((1u << VCRTOS_CONFIG_SMP_NUMOF_CORES) - 1)
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+static int failures;
+static std::atomic<int> finished;
+static std::atomic<unsigned> cores_seen;
+static char stacks[NUMOF_WORKERS][SMP_PORT_STACKSIZE];
+
+static void mark_core()
+{
+    cores_seen.fetch_or(1u << cpu_core_id());
+}
+
+static kernel_pid_t create_worker(int index, thread_handler_func_t func, void *arg, uint8_t priority = WORKER_PRIORITY)
+{
+    return thread_create(stacks[index], sizeof(stacks[index]), func, "worker", priority, arg,
+                         THREAD_FLAGS_CREATE_WOUT_YIELD);
+}
+
+/* state left behind by a stuck case */
+static void dump_threads()
+{
+    ThreadScheduler &scheduler = ThreadScheduler::get();
+
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++)
+    {
+        Thread *thread = scheduler.get_thread_from_container(pid);
+
+        if (thread == nullptr)
+            continue;
+
+        printf("  pid %d %-8s %-10s core %u%s\n", pid, thread->name,
+               ThreadScheduler::thread_status_to_string(thread->status), thread->core,
+               (sched_active_threads[thread->core] == thread) ? " active" : "");
+    }
+}
+
+static bool run_cores(int numof_threads)
+{
+    smp_port_start();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    while (finished.load() < numof_threads)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            /* cores are stuck in a thread, they can not be joined */
+            printf("timeout, %d of %d threads finished\n", finished.load(), numof_threads);
+            dump_threads();
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    smp_port_stop();
+
+    return true;
+}
+
+static void setup()
+{
+    thread_scheduler_init();
+    trace_clear();
+    finished.store(0);
+    cores_seen.store(0);
+}
+
+/* ---- yielding workers are spread over the cores ---- */
+
+static void *yield_worker(void *arg)
+{
+    (void)arg;
+
+    /* a core that came up late still finds work to steal */
+    for (int i = 0; i < 1000 || (cores_seen.load() != ALL_CORES && i < 1000000); i++)
+    {
+        mark_core();
+        thread_yield();
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_stealing()
+{
+    setup();
+
+    for (int i = 0; i < NUMOF_WORKERS; i++)
+        create_worker(i, yield_worker, nullptr);
+
+    if (!run_cores(NUMOF_WORKERS))
+        return false;
+
+    /* every core stole work from core 0 */
+    CHECK(cores_seen.load() == ALL_CORES);
+
+    /* each core records into its own ring and stamps its id */
+    static trace_event_t events[VCRTOS_CONFIG_SMP_NUMOF_CORES * VCRTOS_CONFIG_TRACE_BUFFER_SIZE];
+    size_t count = trace_read(0, events, sizeof(events) / sizeof(events[0]));
+    unsigned switch_cores = 0;
+    unsigned previous_core = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(events[i].core < VCRTOS_CONFIG_SMP_NUMOF_CORES);
+        CHECK(events[i].core >= previous_core);
+        previous_core = events[i].core;
+
+        if (events[i].type == TRACE_EVENT_SWITCH)
+            switch_cores |= 1u << events[i].core;
+    }
+
+    CHECK(switch_cores == ALL_CORES);
+    return true;
+}
+
+/* ---- mutex protected counter ---- */
+
+static mutex_t counter_mutex;
+static volatile unsigned counter;
+
+static void *mutex_worker(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < 10000; i++)
+    {
+        mutex_lock(&counter_mutex);
+        mark_core();
+        unsigned value = counter;
+        if ((i % 64) == 0)
+            thread_yield();
+        counter = value + 1;
+        mutex_unlock(&counter_mutex);
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_mutex()
+{
+    setup();
+    mutex_init_unlocked(&counter_mutex);
+    counter = 0;
+
+    for (int i = 0; i < NUMOF_WORKERS; i++)
+        create_worker(i, mutex_worker, nullptr);
+
+    if (!run_cores(NUMOF_WORKERS))
+        return false;
+
+    CHECK(counter == NUMOF_WORKERS * 10000);
+    CHECK(cores_seen.load() != 1);
+    return true;
+}
+
+/* ---- send_receive / reply between threads on different cores ---- */
+
+#define NUMOF_ROUNDS 2000
+#define NUMOF_CLIENTS 3
+
+static Msg server_queue[8];
+static Msg client_queues[NUMOF_CLIENTS][2];
+static kernel_pid_t server_pid;
+static std::atomic<int> bad_replies;
+
+static void *server(void *arg)
+{
+    (void)arg;
+    msg_t msg;
+    msg_t reply;
+
+    for (int i = 0; i < NUMOF_ROUNDS * NUMOF_CLIENTS; i++)
+    {
+        msg_receive(&msg);
+        mark_core();
+        reply.type = msg.type;
+        reply.content.value = msg.content.value + 1;
+        msg_reply(&msg, &reply);
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static void *client(void *arg)
+{
+    uint16_t id = (uint16_t)(uintptr_t)arg;
+    msg_t msg;
+    msg_t reply;
+
+    for (uint32_t i = 0; i < NUMOF_ROUNDS; i++)
+    {
+        msg.type = id;
+        msg.content.value = i;
+        int result = msg_send_receive(&msg, &reply, server_pid);
+        mark_core();
+
+        if (result != 1 || reply.type != id || reply.content.value != i + 1)
+            bad_replies++;
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_msg()
+{
+    setup();
+    bad_replies.store(0);
+
+    server_pid = create_worker(0, server, nullptr, WORKER_PRIORITY - 1);
+    ThreadScheduler::get().get_thread_from_container(server_pid)->init_msg_queue(server_queue, 8);
+
+    /* send_receive needs a queue on the sender too */
+    for (int i = 0; i < NUMOF_CLIENTS; i++)
+    {
+        kernel_pid_t pid = create_worker(i + 1, client, (void *)(uintptr_t)(i + 1));
+        ThreadScheduler::get().get_thread_from_container(pid)->init_msg_queue(client_queues[i], 2);
+    }
+
+    if (!run_cores(NUMOF_CLIENTS + 1))
+        return false;
+
+    CHECK(bad_replies.load() == 0);
+    CHECK(cores_seen.load() != 1);
+    return true;
+}
+
+/* ---- thread flags set from another core ---- */
+
+#define NUMOF_SIGNALS 2000
+
+static kernel_pid_t waiter_pid;
+static std::atomic<int> waiter_ready;
+
+static void *flags_waiter(void *arg)
+{
+    (void)arg;
+    ThreadScheduler &scheduler = ThreadScheduler::get();
+
+    for (int i = 0; i < NUMOF_SIGNALS; i++)
+    {
+        waiter_ready.store(1);
+        scheduler.thread_flags_wait_any(0x1);
+        mark_core();
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static void *flags_setter(void *arg)
+{
+    (void)arg;
+    ThreadScheduler &scheduler = ThreadScheduler::get();
+    Thread *waiter = scheduler.get_thread_from_container(waiter_pid);
+
+    for (int i = 0; i < NUMOF_SIGNALS; i++)
+    {
+        /* wait for the waiter to consume the last signal, yielding lets it
+         * run when both ended up on the same core */
+        while (!waiter_ready.exchange(0))
+            thread_yield();
+
+        mark_core();
+        scheduler.thread_flags_set(waiter, 0x1);
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_thread_flags()
+{
+    setup();
+    waiter_ready.store(0);
+
+    waiter_pid = create_worker(0, flags_waiter, nullptr);
+    create_worker(1, flags_setter, nullptr);
+
+    if (!run_cores(2))
+        return false;
+
+    CHECK(cores_seen.load() != 1);
+    return true;
+}
+
+/* ---- pinned threads stay on their cores ---- */
+
+static std::atomic<unsigned> pinned_cores[2];
+static std::atomic<int> migrate_errors;
+
+static void *pinned_worker(void *arg)
+{
+    int group = (int)(uintptr_t)arg;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        pinned_cores[group].fetch_or(1u << cpu_core_id());
+        thread_yield();
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static void *migrating_worker(void *arg)
+{
+    (void)arg;
+
+    /* the running thread is handed over before set_affinity returns */
+    for (unsigned i = 0; i < 100; i++)
+    {
+        unsigned core = i % VCRTOS_CONFIG_SMP_NUMOF_CORES;
+
+        thread_set_affinity(thread_current_pid(), 1u << core);
+
+        if (cpu_core_id() != core)
+            migrate_errors++;
+    }
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_affinity()
+{
+    setup();
+    pinned_cores[0].store(0);
+    pinned_cores[1].store(0);
+    migrate_errors.store(0);
+
+    /* created from main(), so pinned to core 0 */
+    for (int i = 0; i < 3; i++)
+    {
+        thread_create(stacks[i], sizeof(stacks[i]), pinned_worker, "pinned", WORKER_PRIORITY, (void *)0,
+                      THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_PINNED);
+    }
+
+    for (int i = 3; i < 6; i++)
+    {
+        kernel_pid_t pid = create_worker(i, pinned_worker, (void *)1);
+        CHECK(thread_set_affinity(pid, 1u << 2) == 1);
+        CHECK(thread_get_affinity(pid) == 1u << 2);
+    }
+
+    create_worker(6, migrating_worker, nullptr);
+
+    CHECK(thread_set_affinity(KERNEL_PID_FIRST, 0) == -1);
+
+    if (!run_cores(7))
+        return false;
+
+    CHECK(pinned_cores[0].load() == 1u << 0);
+    CHECK(pinned_cores[1].load() == 1u << 2);
+    CHECK(migrate_errors.load() == 0);
+    return true;
+}
+
+/* ---- spawned threads, joined and detached ---- */
+
+#define NUMOF_CHILDREN 4
+#define NUMOF_DETACHED 500
+
+static std::atomic<int> bad_results;
+static std::atomic<int> detached_done;
+
+static void *child(void *arg)
+{
+    mark_core();
+
+    for (int i = 0; i < 100; i++)
+        thread_yield();
+
+    return (void *)((uintptr_t)arg * 2);
+}
+
+static void *detached_child(void *arg)
+{
+    (void)arg;
+    mark_core();
+    detached_done++;
+    return nullptr;
+}
+
+static void *parent(void *arg)
+{
+    (void)arg;
+    kernel_pid_t pids[NUMOF_CHILDREN];
+
+    for (int round = 0; round < 50; round++)
+    {
+        for (uintptr_t i = 0; i < NUMOF_CHILDREN; i++)
+        {
+            pids[i] = thread_spawn(child, (void *)(i + 1), THREAD_STACK_SMALL, WORKER_PRIORITY, 0);
+
+            if (pids[i] == KERNEL_PID_UNDEF)
+                bad_results++;
+        }
+
+        for (uintptr_t i = 0; i < NUMOF_CHILDREN; i++)
+        {
+            void *result = nullptr;
+
+            if (pids[i] == KERNEL_PID_UNDEF)
+                continue;
+
+            if (thread_join(pids[i], &result) != 1 || result != (void *)((i + 1) * 2))
+                bad_results++;
+        }
+    }
+
+    /* the pool runs dry while the children have not been reaped yet */
+    for (int i = 0; i < NUMOF_DETACHED; i++)
+    {
+        while (thread_spawn(detached_child, nullptr, THREAD_STACK_SMALL, WORKER_PRIORITY,
+                            THREAD_FLAGS_CREATE_DETACHED) == KERNEL_PID_UNDEF)
+        {
+            thread_yield();
+        }
+    }
+
+    while (detached_done.load() != NUMOF_DETACHED)
+        thread_yield();
+
+    finished++;
+    return nullptr;
+}
+
+static bool test_spawn()
+{
+    setup();
+    bad_results.store(0);
+    detached_done.store(0);
+
+    create_worker(0, parent, nullptr);
+
+    if (!run_cores(1))
+        return false;
+
+    CHECK(bad_results.load() == 0);
+    CHECK(cores_seen.load() != 1);
+    return true;
+}
+
+int main()
+{
+    static const struct
+    {
+        const char *name;
+        bool (*func)();
+    } cases[] = {
+        { "stealing", test_stealing },
+        { "mutex", test_mutex },
+        { "msg", test_msg },
+        { "thread_flags", test_thread_flags },
+        { "affinity", test_affinity },
+        { "spawn", test_spawn },
+    };
+
+    for (auto &c : cases)
+    {
+        int before = failures;
+
+        printf("[ RUN  ] %s\n", c.name);
+
+        if (!c.func())
+        {
+            /* the cores can not be recovered, give up */
+            printf("[ FAIL ] %s\n", c.name);
+            return 1;
+        }
+
+        printf("[ %s ] %s\n", (failures == before) ? " OK " : "FAIL", c.name);
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_SMP_CONFIG_H
+#define VCRTOS_SMP_CONFIG_H
+
+#define VCRTOS_CONFIG_SMP_NUMOF_CORES 4
+#define VCRTOS_CONFIG_THREAD_FLAGS_ENABLE 1
+#define VCRTOS_CONFIG_THREAD_SPAWN_ENABLE 1
+#define VCRTOS_CONFIG_TRACE_ENABLE 1
+
+/* host contexts need larger stacks than the defaults */
+#define VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE (16 * 1024)
+#define VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF 6
+#define VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_STACKSIZE (32 * 1024)
+#define VCRTOS_CONFIG_THREAD_SPAWN_MEDIUM_NUMOF 1
+#define VCRTOS_CONFIG_THREAD_SPAWN_LARGE_STACKSIZE (64 * 1024)
+#define VCRTOS_CONFIG_THREAD_SPAWN_LARGE_NUMOF 1
+
+#endif /* VCRTOS_SMP_CONFIG_H */
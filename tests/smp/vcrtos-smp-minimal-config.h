@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#ifndef VCRTOS_SMP_MINIMAL_CONFIG_H
+#define VCRTOS_SMP_MINIMAL_CONFIG_H
+
+/* SMP with the optional features left at their defaults, only built to keep
+ * that combination compiling */
+#define VCRTOS_CONFIG_SMP_NUMOF_CORES 2
+
+#endif /* VCRTOS_SMP_MINIMAL_CONFIG_H */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "gtest/gtest.h"
+
+#include "sim.hpp"
+
+using namespace sim;
+
+class TestSim : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestSim, periodicThreadTest)
+{
+    Simulator simulator;
+
+    int thread = simulator.add_thread(ThreadSpec{"periodic", KERNEL_THREAD_PRIORITY_MAIN, {period(1000), compute(100)}, 1000});
+
+    EXPECT_EQ(thread, 0);
+
+    simulator.run(100000);
+
+    ThreadStats &stats = simulator.thread_stats(thread);
+
+    EXPECT_EQ(stats.jobs, 100u);
+    EXPECT_EQ(stats.min_response, 100u);
+    EXPECT_EQ(stats.max_response, 100u);
+    EXPECT_EQ(stats.deadline_misses, 0u);
+    EXPECT_EQ(stats.runtime_ticks, 10000u);
+    EXPECT_EQ(simulator.idle_ticks(), 90000u);
+
+    // neither takes time nor blocks
+
+    EXPECT_EQ(simulator.add_thread(ThreadSpec{"spin", KERNEL_THREAD_PRIORITY_MAIN, {msg_send(thread)}, 0}), -1);
+}
+
+TEST_F(TestSim, priorityAssignmentTest)
+{
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] rate monotonic, both released at 0: t2 runs 20..50 and
+     * 70..80 around the second t1 job
+     * -------------------------------------------------------------------------
+     **/
+    {
+        Simulator simulator;
+
+        int t1 = simulator.add_thread(ThreadSpec{"t1", KERNEL_THREAD_PRIORITY_MAIN - 1, {period(50), compute(20)}, 50});
+        int t2 = simulator.add_thread(ThreadSpec{"t2", KERNEL_THREAD_PRIORITY_MAIN, {period(100), compute(40)}, 100});
+
+        simulator.run(10000);
+
+        EXPECT_EQ(simulator.thread_stats(t1).max_response, 20u);
+        EXPECT_EQ(simulator.thread_stats(t1).deadline_misses, 0u);
+        EXPECT_EQ(simulator.thread_stats(t2).max_response, 80u);
+        EXPECT_EQ(simulator.thread_stats(t2).deadline_misses, 0u);
+    }
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] inverted, t1 waits for the whole t2 job
+     * -------------------------------------------------------------------------
+     **/
+    {
+        Simulator simulator;
+
+        int t1 = simulator.add_thread(ThreadSpec{"t1", KERNEL_THREAD_PRIORITY_MAIN, {period(50), compute(20)}, 50});
+        int t2 = simulator.add_thread(ThreadSpec{"t2", KERNEL_THREAD_PRIORITY_MAIN - 1, {period(100), compute(40)}, 100});
+
+        simulator.run(10000);
+
+        EXPECT_EQ(simulator.thread_stats(t1).max_response, 60u);
+        EXPECT_GT(simulator.thread_stats(t1).deadline_misses, 0u);
+        EXPECT_EQ(simulator.thread_stats(t2).max_response, 40u);
+    }
+}
+
+TEST_F(TestSim, irqTest)
+{
+    Simulator simulator;
+
+    int handler = simulator.add_thread(ThreadSpec{"handler", KERNEL_THREAD_PRIORITY_MAIN - 1, {msg_receive(), compute(50)}, 0});
+    int waiter = simulator.add_thread(ThreadSpec{"waiter", KERNEL_THREAD_PRIORITY_MAIN, {flags_wait(0x2), compute(30)}, 0});
+
+    EXPECT_EQ(simulator.add_irq(IrqSpec{"bad", 0, 100, 0, 0, IRQ_MSG_SEND, 5, 0}), -1);
+
+    int rx = simulator.add_irq(IrqSpec{"rx", 100, 1000, 0, 5, IRQ_MSG_SEND, handler, 0});
+    int tick = simulator.add_irq(IrqSpec{"tick", 100, 1000, 0, 0, IRQ_FLAGS_SET, waiter, 0x2});
+
+    simulator.run(100000);
+
+    EXPECT_EQ(simulator.irq_stats(rx).count, 100u);
+    EXPECT_EQ(simulator.irq_stats(rx).dropped, 0u);
+    EXPECT_EQ(simulator.irq_stats(tick).count, 100u);
+
+    // response counts from the arrival, including the isr
+
+    EXPECT_EQ(simulator.thread_stats(handler).jobs, 100u);
+    EXPECT_EQ(simulator.thread_stats(handler).min_response, 55u);
+    EXPECT_EQ(simulator.thread_stats(handler).max_response, 55u);
+
+    // both arrive at the same time, the waiter also waits for the handler
+
+    EXPECT_EQ(simulator.thread_stats(waiter).jobs, 100u);
+    EXPECT_EQ(simulator.thread_stats(waiter).max_response, 85u);
+}
+
+TEST_F(TestSim, mutexTest)
+{
+    Simulator simulator;
+
+    int lock = simulator.add_mutex();
+
+    // low priority thread holds the lock when the high one wants it
+
+    int high = simulator.add_thread(ThreadSpec{"high", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                               {period(1000), delay(10), mutex_lock(lock), compute(5), mutex_unlock(lock)}, 0});
+    int low = simulator.add_thread(ThreadSpec{"low", KERNEL_THREAD_PRIORITY_MAIN,
+                                              {period(1000), mutex_lock(lock), compute(100), mutex_unlock(lock)}, 0});
+
+    simulator.run(10000);
+
+    EXPECT_EQ(simulator.thread_stats(low).jobs, 10u);
+    EXPECT_EQ(simulator.thread_stats(low).max_response, 100u);
+
+    // delay ends at 10, blocked until 100, then 5 more
+
+    EXPECT_EQ(simulator.thread_stats(high).jobs, 10u);
+    EXPECT_EQ(simulator.thread_stats(high).max_response, 95u);
+}
+
+TEST_F(TestSim, deterministicTest)
+{
+    uint64_t result[2][3];
+
+    for (int i = 0; i < 2; i++)
+    {
+        Simulator simulator(1234);
+
+        int handler = simulator.add_thread(ThreadSpec{"handler", KERNEL_THREAD_PRIORITY_MAIN - 1, {msg_receive(), compute(10, 200)}, 0});
+        int worker = simulator.add_thread(ThreadSpec{"worker", KERNEL_THREAD_PRIORITY_MAIN, {compute(100, 1000)}, 0});
+
+        simulator.add_irq(IrqSpec{"rx", 0, 300, 150, 3, IRQ_MSG_SEND, handler, 0});
+
+        simulator.run(1000000);
+
+        result[i][0] = simulator.thread_stats(handler).total_response;
+        result[i][1] = simulator.thread_stats(worker).total_response;
+        result[i][2] = simulator.events();
+    }
+
+    EXPECT_EQ(result[0][0], result[1][0]);
+    EXPECT_EQ(result[0][1], result[1][1]);
+    EXPECT_EQ(result[0][2], result[1][2]);
+    EXPECT_GT(result[0][2], 0u);
+}
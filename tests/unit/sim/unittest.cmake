@@ -0,0 +1,21 @@
+set(unittest-includes ${unittest-includes}
+    ../sim
+)
+
+set(unittest-sources
+    ../../source/core/thread.cpp
+    ../../source/core/msg.cpp
+    ../../source/core/mutex.cpp
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
+    ../../source/core/assert_failure.c
+    ../sim/sim.cpp
+    ../sim/sim_port.cpp
+)
+
+set(unittest-test-sources
+    sim/test_sim.cpp
+)
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DVCRTOS_PROJECT_CONFIG_FILE='\"vcrtos-unittest-config.h\"'")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DVCRTOS_PROJECT_CONFIG_FILE='\"vcrtos-unittest-config.h\"'")
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "cli/cli.hpp"
+#include "cli/cli_server.hpp"
+
+#include "core/code_utils.h"
+
+using namespace vc;
+using namespace cli;
+
+class TestServer : public Server
+{
+public:
+    TestServer() { clear(); }
+
+    virtual int output(const char *buf, uint16_t length)
+    {
+        strncat(_output, buf, length);
+        output_calls++;
+        return length;
+    }
+
+    virtual int output_format(const char *fmt, ...)
+    {
+        int res;
+        va_list ap;
+        va_start(ap, fmt);
+        res = output_vformat(fmt, ap);
+        va_end(ap);
+        return res;
+    }
+
+    virtual int output_vformat(const char *fmt, va_list ap)
+    {
+        char buf[128];
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        return output(buf, static_cast<uint16_t>(strlen(buf)));
+    }
+
+    void clear()
+    {
+        _output[0] = '\0';
+        output_calls = 0;
+    }
+
+    int output_calls;
+    const char *get_output() { return _output; }
+
+private:
+    char _output[512];
+};
+
+static int last_handler;
+static int last_argc;
+static char last_argv0[16];
+
+static void handler_reset(int argc, char *argv[])
+{
+    last_handler = 1;
+    last_argc = argc;
+    strncpy(last_argv0, (argc > 0) ? argv[0] : "", sizeof(last_argv0) - 1);
+}
+
+static void handler_read(int argc, char *argv[])
+{
+    last_handler = 2;
+    last_argc = argc;
+    strncpy(last_argv0, (argc > 0) ? argv[0] : "", sizeof(last_argv0) - 1);
+}
+
+static void handler_ps(int argc, char *argv[])
+{
+    (void)argv;
+    last_handler = 3;
+    last_argc = argc;
+}
+
+static void handler_other(int argc, char *argv[])
+{
+    (void)argv;
+    last_handler = 4;
+    last_argc = argc;
+}
+
+static const cli_command_t module1_commands[] = {
+    {"reset", handler_reset, 0},
+    {"read", handler_read, 0},
+    {"readall", handler_read, 0},
+};
+
+static const cli_command_t module2_commands[] = {
+    {"ps", handler_ps, 0},
+    {"reset", handler_other, 0},
+};
+
+class TestCliInterpreter : public testing::Test
+{
+protected:
+    Interpreter *interpreter;
+    TestServer server;
+
+    virtual void SetUp()
+    {
+        interpreter = new Interpreter();
+        last_handler = 0;
+        last_argc = -1;
+        last_argv0[0] = '\0';
+    }
+
+    virtual void TearDown()
+    {
+        delete interpreter;
+    }
+};
+
+TEST_F(TestCliInterpreter, registerCommandsTest)
+{
+    EXPECT_EQ(interpreter->get_numof_commands(), 0);
+    EXPECT_EQ(interpreter->find_command("reset"), nullptr);
+
+    EXPECT_EQ(interpreter->add_commands(module1_commands, ARRAY_LENGTH(module1_commands)), 3);
+
+    // duplicated name is ignored, first registration wins
+
+    EXPECT_EQ(interpreter->add_commands(module2_commands, ARRAY_LENGTH(module2_commands)), 1);
+
+    EXPECT_EQ(interpreter->get_numof_commands(), 4);
+
+    // commands from all tables are kept sorted by name
+
+    EXPECT_STREQ(interpreter->get_command(0)->name, "ps");
+    EXPECT_STREQ(interpreter->get_command(1)->name, "read");
+    EXPECT_STREQ(interpreter->get_command(2)->name, "readall");
+    EXPECT_STREQ(interpreter->get_command(3)->name, "reset");
+
+    EXPECT_EQ(interpreter->find_command("reset"), &module1_commands[0]);
+    EXPECT_EQ(interpreter->find_command("ps"), &module2_commands[0]);
+    EXPECT_EQ(interpreter->find_command("rea"), nullptr);
+    EXPECT_EQ(interpreter->find_command("zzz"), nullptr);
+    EXPECT_EQ(interpreter->find_command(""), nullptr);
+}
+
+TEST_F(TestCliInterpreter, prefixLookupTest)
+{
+    uint16_t first;
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("r", first), 0);
+
+    interpreter->add_commands(module1_commands, ARRAY_LENGTH(module1_commands));
+    interpreter->add_commands(module2_commands, ARRAY_LENGTH(module2_commands));
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("r", first), 3);
+    EXPECT_EQ(first, 1);
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("read", first), 2);
+    EXPECT_EQ(first, 1);
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("res", first), 1);
+    EXPECT_STREQ(interpreter->get_command(first)->name, "reset");
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("x", first), 0);
+
+    EXPECT_EQ(interpreter->find_commands_by_prefix("", first), 4);
+    EXPECT_EQ(first, 0);
+}
+
+TEST_F(TestCliInterpreter, processLineTest)
+{
+    interpreter->add_commands(module1_commands, ARRAY_LENGTH(module1_commands));
+    interpreter->add_commands(module2_commands, ARRAY_LENGTH(module2_commands));
+
+    char line1[] = "read 0x100 16";
+
+    interpreter->process_line(line1, static_cast<uint16_t>(strlen(line1)), server);
+
+    EXPECT_EQ(last_handler, 2);
+    EXPECT_EQ(last_argc, 2);
+    EXPECT_STREQ(last_argv0, "0x100");
+    EXPECT_STREQ(server.get_output(), "Done\r\n");
+
+    server.clear();
+
+    char line2[] = "  ps";
+
+    interpreter->process_line(line2, static_cast<uint16_t>(strlen(line2)), server);
+
+    EXPECT_EQ(last_handler, 3);
+    EXPECT_EQ(last_argc, 0);
+    EXPECT_STREQ(server.get_output(), "Done\r\n");
+
+    server.clear();
+    last_handler = 0;
+
+    char line3[] = "unknown arg";
+
+    interpreter->process_line(line3, static_cast<uint16_t>(strlen(line3)), server);
+
+    EXPECT_EQ(last_handler, 0);
+    EXPECT_STREQ(server.get_output(), "Unknown command: unknown\r\n");
+}
+
+TEST_F(TestCliInterpreter, tableFullTest)
+{
+    static cli_command_t commands[VCRTOS_CONFIG_CLI_MAX_COMMANDS + 4];
+    static char names[VCRTOS_CONFIG_CLI_MAX_COMMANDS + 4][8];
+
+    for (unsigned i = 0; i < ARRAY_LENGTH(commands); i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "c%03u", i);
+        commands[i].name = names[i];
+        commands[i].command_handler_func = handler_other;
+    }
+
+    EXPECT_EQ(interpreter->add_commands(commands, ARRAY_LENGTH(commands)), -1);
+    EXPECT_EQ(interpreter->get_numof_commands(), VCRTOS_CONFIG_CLI_MAX_COMMANDS);
+    EXPECT_EQ(interpreter->find_command("c000"), &commands[0]);
+    EXPECT_EQ(interpreter->find_command(names[VCRTOS_CONFIG_CLI_MAX_COMMANDS - 1]),
+              &commands[VCRTOS_CONFIG_CLI_MAX_COMMANDS - 1]);
+    EXPECT_EQ(interpreter->find_command(names[VCRTOS_CONFIG_CLI_MAX_COMMANDS]), nullptr);
+}
+
+TEST_F(TestCliInterpreter, setUserCommandsTest)
+{
+    interpreter->add_commands(module2_commands, ARRAY_LENGTH(module2_commands));
+    interpreter->set_user_commands(module1_commands, ARRAY_LENGTH(module1_commands));
+
+    EXPECT_EQ(interpreter->get_numof_commands(), 4);
+    EXPECT_EQ(interpreter->find_command("read"), &module1_commands[1]);
+
+    // the previous user table is replaced, added tables are kept
+
+    interpreter->set_user_commands(&module1_commands[2], 1);
+
+    EXPECT_EQ(interpreter->get_numof_commands(), 3);
+    EXPECT_EQ(interpreter->find_command("read"), nullptr);
+    EXPECT_EQ(interpreter->find_command("readall"), &module1_commands[2]);
+    EXPECT_EQ(interpreter->find_command("reset"), &module2_commands[1]);
+    EXPECT_EQ(interpreter->find_command("ps"), &module2_commands[0]);
+
+    interpreter->set_user_commands(NULL, 0);
+
+    EXPECT_EQ(interpreter->get_numof_commands(), 2);
+}
+
+TEST_F(TestCliInterpreter, outputBytesTest)
+{
+    uint8_t bytes[48];
+
+    for (unsigned i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = static_cast<uint8_t>(i * 0x11);
+    }
+
+    interpreter->set_server(server);
+
+    interpreter->output_bytes(bytes, 4);
+
+    EXPECT_STREQ(server.get_output(), "00112233");
+    EXPECT_EQ(server.output_calls, 1);
+
+    server.clear();
+
+    // hex digits are written in chunks rather than one call per byte
+
+    interpreter->output_bytes(bytes, sizeof(bytes));
+
+    EXPECT_EQ(strlen(server.get_output()), sizeof(bytes) * 2);
+    EXPECT_EQ(strncmp(server.get_output() + 28, "eeff1021", 8), 0);
+    EXPECT_EQ(server.output_calls, 2);
+}
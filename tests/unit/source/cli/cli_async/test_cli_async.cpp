@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "cli/cli.hpp"
+#include "cli/cli_async.hpp"
+#include "cli/cli_server.hpp"
+
+#include "core/code_utils.h"
+#include "core/thread.hpp"
+
+using namespace vc;
+using namespace cli;
+
+extern "C" void *thread_cli_async_handler(void *arg);
+
+class TestServer : public Server
+{
+public:
+    TestServer() { clear(); }
+
+    virtual int output(const char *buf, uint16_t length)
+    {
+        strncat(_output, buf, length);
+        return length;
+    }
+
+    virtual int output_format(const char *fmt, ...)
+    {
+        int res;
+        va_list ap;
+        va_start(ap, fmt);
+        res = output_vformat(fmt, ap);
+        va_end(ap);
+        return res;
+    }
+
+    virtual int output_vformat(const char *fmt, va_list ap)
+    {
+        char buf[128];
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        return output(buf, static_cast<uint16_t>(strlen(buf)));
+    }
+
+    void clear() { _output[0] = '\0'; }
+    const char *get_output() { return _output; }
+
+private:
+    char _output[512];
+};
+
+static int dump_calls;
+
+static void handler_dump(int argc, char *argv[])
+{
+    dump_calls++;
+    vccli_output_format("dump %d %s", argc, (argc > 0) ? argv[0] : "");
+    vccli_output_format(" end\r\n");
+}
+
+static void handler_sync(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    vccli_output_format("sync\r\n");
+}
+
+static const cli_command_t commands[] = {
+    {"dump", handler_dump, CLI_COMMAND_FLAG_ASYNC},
+    {"sync", handler_sync, 0},
+};
+
+class TestCliAsync : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestCliAsync, dispatchTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char idle_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+
+    EXPECT_NE(idle_thread, nullptr);
+
+    char stack1[128];
+
+    Thread *thread1 = Thread::init(stack1, sizeof(stack1), nullptr, "cli", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_NE(thread1, nullptr);
+
+    Async &async = Async::init();
+
+    EXPECT_EQ(Async::get(), &async);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    Interpreter &interpreter = Interpreter::init();
+    TestServer server;
+
+    interpreter.set_server(server);
+    interpreter.add_commands(commands, ARRAY_LENGTH(commands));
+
+    // async command is handed over to a worker and the cli thread returns
+
+    char line1[] = "dump flash";
+
+    interpreter.process_line(line1, static_cast<uint16_t>(strlen(line1)), server);
+
+    EXPECT_EQ(dump_calls, 0);
+    EXPECT_STREQ(server.get_output(), "Pending 1\r\n");
+    EXPECT_TRUE(async.get_worker(0).is_busy());
+
+    // next line reuses the same buffer while the job is still pending
+
+    memset(line1, 'x', sizeof(line1) - 1);
+
+    server.clear();
+
+    char line2[] = "dump ram";
+
+    interpreter.process_line(line2, static_cast<uint16_t>(strlen(line2)), server);
+
+    EXPECT_STREQ(server.get_output(), "Pending 2\r\n");
+    EXPECT_TRUE(async.get_worker(1).is_busy());
+
+    server.clear();
+
+    char line3[] = "dump otp";
+
+    interpreter.process_line(line3, static_cast<uint16_t>(strlen(line3)), server);
+
+    EXPECT_STREQ(server.get_output(), "Busy\r\n");
+
+    // synchronous commands still run inline
+
+    server.clear();
+
+    char line4[] = "sync";
+
+    interpreter.process_line(line4, static_cast<uint16_t>(strlen(line4)), server);
+
+    EXPECT_STREQ(server.get_output(), "sync\r\nDone\r\n");
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] worker runs the job and its output is tagged
+     * -------------------------------------------------------------------------
+     **/
+
+    server.clear();
+
+    scheduler->sleep();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_SLEEPING);
+
+    scheduler->run();
+
+    EXPECT_EQ(sched_active_pid, async.get_worker(0).get_pid());
+
+    (void)thread_cli_async_handler(&async.get_worker(0));
+
+    // arguments were copied before the line buffer got reused
+
+    EXPECT_EQ(dump_calls, 1);
+    EXPECT_STREQ(server.get_output(), "[1] dump 1 flash end\r\n[1] Done\r\n");
+    EXPECT_FALSE(async.get_worker(0).is_busy());
+    EXPECT_TRUE(async.get_worker(1).is_busy());
+
+    // worker goes back to wait for the next job
+
+    (void)thread_cli_async_handler(&async.get_worker(0));
+
+    EXPECT_EQ(dump_calls, 1);
+
+    EXPECT_EQ(scheduler->wakeup_thread(thread1->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    // a worker is free again
+
+    server.clear();
+
+    char line5[] = "dump otp";
+
+    interpreter.process_line(line5, static_cast<uint16_t>(strlen(line5)), server);
+
+    EXPECT_STREQ(server.get_output(), "Pending 3\r\n");
+}
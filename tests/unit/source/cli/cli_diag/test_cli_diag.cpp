@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/cli_diag.h>
+#include <vcrtos/heap.h>
+#include <vcrtos/trace.h>
+
+#include "cli/cli.hpp"
+#include "cli/cli_server.hpp"
+
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+using namespace cli;
+
+class TestServer : public Server
+{
+public:
+    TestServer() { clear(); }
+
+    virtual int output(const char *buf, uint16_t length)
+    {
+        strncat(_output, buf, length);
+        return length;
+    }
+
+    virtual int output_format(const char *fmt, ...)
+    {
+        int res;
+        va_list ap;
+        va_start(ap, fmt);
+        res = output_vformat(fmt, ap);
+        va_end(ap);
+        return res;
+    }
+
+    virtual int output_vformat(const char *fmt, va_list ap)
+    {
+        char buf[128];
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        return output(buf, static_cast<uint16_t>(strlen(buf)));
+    }
+
+    void clear() { _output[0] = '\0'; }
+    const char *get_output() { return _output; }
+
+private:
+    char _output[1024];
+};
+
+class TestCliDiag : public testing::Test
+{
+protected:
+    TestServer server;
+
+    void run(const char *command)
+    {
+        char line[32];
+        strncpy(line, command, sizeof(line) - 1);
+        line[sizeof(line) - 1] = '\0';
+        server.clear();
+        Interpreter::init().process_line(line, static_cast<uint16_t>(strlen(line)), server);
+    }
+
+    virtual void SetUp()
+    {
+        Interpreter::init().set_server(server);
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestCliDiag, diagCommandsTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    test_helper_set_cpu_timestamp(0);
+
+    char stack1[128];
+    char stack2[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread = Thread::init(stack2, sizeof(stack2), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_NE(idle_thread, nullptr);
+    EXPECT_NE(main_thread, nullptr);
+
+    scheduler->run();
+
+    EXPECT_GT(vccli_add_diag_commands(), 0);
+
+    // main runs 300 ticks, idle 100 ticks
+
+    test_helper_set_cpu_timestamp(300);
+    scheduler->sleep();
+    scheduler->run();
+    test_helper_set_cpu_timestamp(400);
+    scheduler->wakeup_thread(main_thread->get_pid());
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    run("ps");
+
+    EXPECT_NE(strstr(server.get_output(), "pid name"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), "idle"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), "running"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), " 75.0%"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), " 25.0%"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), "Done\r\n"), nullptr);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] top reports usage since its previous invocation
+     * -------------------------------------------------------------------------
+     **/
+
+    run("top");
+
+    EXPECT_NE(strstr(server.get_output(), " 75.0%"), nullptr);
+
+    test_helper_set_cpu_timestamp(500);
+    scheduler->sleep();
+    scheduler->run();
+    test_helper_set_cpu_timestamp(900);
+    scheduler->wakeup_thread(main_thread->get_pid());
+    scheduler->run();
+
+    run("top");
+
+    EXPECT_NE(strstr(server.get_output(), " 80.0%"), nullptr);
+    EXPECT_NE(strstr(server.get_output(), " 20.0%"), nullptr);
+    EXPECT_EQ(strstr(server.get_output(), " 75.0%"), nullptr);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] heap
+     * -------------------------------------------------------------------------
+     **/
+
+    run("heap");
+
+    EXPECT_NE(strstr(server.get_output(), "heap not initialized"), nullptr);
+
+    heap_init();
+
+    void *ptr = heap_malloc(16);
+
+    EXPECT_NE(ptr, nullptr);
+
+    run("heap");
+
+    EXPECT_NE(strstr(server.get_output(), "capacity"), nullptr);
+    EXPECT_EQ(strstr(server.get_output(), "clean"), nullptr);
+
+    heap_free(ptr);
+
+    run("heap");
+
+    EXPECT_NE(strstr(server.get_output(), "clean"), nullptr);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] registered mutex and event queue
+     * -------------------------------------------------------------------------
+     **/
+
+    Mutex mutex(MUTEX_INIT_UNLOCKED);
+
+    EXPECT_EQ(vccli_diag_register_mutex("cfg", &mutex), 0);
+
+    run("mutex");
+
+    EXPECT_NE(strstr(server.get_output(), "cfg              unlocked\r\n"), nullptr);
+
+    mutex.lock();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    run("mutex");
+
+    EXPECT_NE(strstr(server.get_output(), "cfg              locked\r\n"), nullptr);
+
+    // main thread blocks on the locked mutex and shows up as a waiter
+
+    mutex.lock();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_MUTEX_BLOCKED);
+
+    /* name field, "locked ", any int pid and "\r\n" */
+    char expected[17 + 7 + 11 + 2 + 1];
+    snprintf(expected, sizeof(expected), "cfg              locked %d\r\n", main_thread->get_pid());
+
+    run("mutex");
+
+    EXPECT_NE(strstr(server.get_output(), expected), nullptr);
+
+    EventQueue queue;
+    Event event;
+
+    EXPECT_EQ(vccli_diag_register_event_queue("events", &queue), 0);
+
+    run("evq");
+
+    EXPECT_NE(strstr(server.get_output(), "events           pending 0\r\n"), nullptr);
+
+    queue.event_post(&event, idle_thread);
+
+    run("evq");
+
+    EXPECT_NE(strstr(server.get_output(), "events           pending 1\r\n"), nullptr);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] trace dump as hex records
+     * -------------------------------------------------------------------------
+     **/
+
+    trace_clear();
+
+    trace_record(TRACE_EVENT_USER, 0x0102, 0xdeadbeef);
+
+    run("trace");
+
+    // timestamp 900, type 0x80, pid 0x0102, arg 0xdeadbeef, little endian
+
+    EXPECT_NE(strstr(server.get_output(), "trace dropped 0\r\n8403000080000201efbeadde\r\n"), nullptr);
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/cli_rpc.h>
+#include <vcrtos/vcstdio.h>
+
+#include "cli/cli_async.hpp"
+#include "cli/cli_rpc.hpp"
+
+#include "core/code_utils.h"
+
+using namespace vc;
+using namespace cli;
+
+static uint8_t last_argc;
+static cli_rpc_arg_t last_args[VCRTOS_CONFIG_CLI_RPC_MAX_ARGS];
+static char last_string[32];
+
+static int rpc_echo(const cli_rpc_arg_t *args, uint8_t argc, uint8_t *response, uint16_t size)
+{
+    uint16_t length = 0;
+
+    last_argc = argc;
+    memcpy(last_args, args, argc * sizeof(cli_rpc_arg_t));
+
+    for (uint8_t i = 0; i < argc; i++)
+    {
+        if (args[i].type == CLI_RPC_ARG_STRING)
+        {
+            strncpy(last_string, args[i].value.string, sizeof(last_string) - 1);
+        }
+
+        if (args[i].type == CLI_RPC_ARG_BYTES)
+        {
+            if (args[i].length > size - length)
+                return -CLI_RPC_STATUS_NO_BUFFER;
+
+            memcpy(&response[length], args[i].value.bytes, args[i].length);
+            length += args[i].length;
+        }
+    }
+
+    return length;
+}
+
+static int rpc_fail(const cli_rpc_arg_t *args, uint8_t argc, uint8_t *response, uint16_t size)
+{
+    (void)args;
+    (void)argc;
+    (void)response;
+    (void)size;
+    vccli_output("failing", 7);
+    return -CLI_RPC_STATUS_FAILED;
+}
+
+static const cli_rpc_command_t rpc_commands[] = {
+    {0x0001, rpc_echo},
+    {0x0010, rpc_fail},
+};
+
+static void text_hello(int argc, char *argv[])
+{
+    vccli_output_format("hello %s %d\r\n", (argc > 0) ? argv[0] : "", argc);
+}
+
+static const cli_command_t text_commands[] = {
+    {"hello", text_hello, 0},
+};
+
+static uint16_t build_frame(uint8_t *frame, const uint8_t *payload, uint16_t length)
+{
+    frame[0] = CLI_RPC_FRAME_SYNC;
+    frame[1] = static_cast<uint8_t>(length);
+    frame[2] = static_cast<uint8_t>(length >> 8);
+    memcpy(&frame[3], payload, length);
+    uint16_t crc = Rpc::crc16(0xffff, &frame[1], length + 2);
+    frame[3 + length] = static_cast<uint8_t>(crc);
+    frame[4 + length] = static_cast<uint8_t>(crc >> 8);
+    return length + 5;
+}
+
+/* reads the next frame written to vcstdio and returns its payload length */
+static int read_frame(uint8_t *payload)
+{
+    uint8_t header[3];
+    uint8_t crc[2];
+
+    if (vcstdio_isr_tx(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header))
+        return -1;
+
+    if (header[0] != CLI_RPC_FRAME_SYNC)
+        return -1;
+
+    uint16_t length = static_cast<uint16_t>(header[1] | (header[2] << 8));
+
+    if (vcstdio_isr_tx(reinterpret_cast<char *>(payload), length) != length)
+        return -1;
+
+    if (vcstdio_isr_tx(reinterpret_cast<char *>(crc), sizeof(crc)) != sizeof(crc))
+        return -1;
+
+    uint16_t expected = Rpc::crc16(Rpc::crc16(0xffff, &header[1], 2), payload, length);
+
+    if (expected != static_cast<uint16_t>(crc[0] | (crc[1] << 8)))
+        return -1;
+
+    return length;
+}
+
+class TestCliRpc : public testing::Test
+{
+protected:
+    Rpc *rpc;
+
+    virtual void SetUp()
+    {
+        vcstdio_init();
+        rpc = new Rpc();
+        rpc->get_interpreter().set_server(*rpc);
+        rpc->set_commands(rpc_commands, ARRAY_LENGTH(rpc_commands));
+        last_argc = 0;
+        last_string[0] = '\0';
+    }
+
+    virtual void TearDown()
+    {
+        delete rpc;
+    }
+};
+
+TEST_F(TestCliRpc, crcTest)
+{
+    const uint8_t check[] = "123456789";
+
+    // CRC-16/CCITT-FALSE check value
+
+    EXPECT_EQ(Rpc::crc16(0xffff, check, 9), 0x29b1);
+}
+
+TEST_F(TestCliRpc, requestTest)
+{
+    const uint8_t payload[] = {
+        CLI_RPC_FRAME_REQUEST, 0x42, 0x01, 0x00,
+        CLI_RPC_ARG_UINT, 0x04, 0x00, 0x78, 0x56, 0x34, 0x12,
+        CLI_RPC_ARG_INT, 0x02, 0x00, 0xfe, 0xff,
+        CLI_RPC_ARG_STRING, 0x03, 0x00, 'c', 'a', 'l',
+        CLI_RPC_ARG_BYTES, 0x03, 0x00, 0xde, 0xad, 0xbe,
+    };
+
+    uint8_t frame[64];
+    uint16_t length = build_frame(frame, payload, sizeof(payload));
+
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(last_argc, 4);
+    EXPECT_EQ(last_args[0].type, CLI_RPC_ARG_UINT);
+    EXPECT_EQ(last_args[0].value.u32, 0x12345678u);
+    EXPECT_EQ(last_args[1].type, CLI_RPC_ARG_INT);
+    EXPECT_EQ(last_args[1].value.i32, -2);
+    EXPECT_EQ(last_args[2].type, CLI_RPC_ARG_STRING);
+    EXPECT_EQ(last_args[2].length, 3);
+    EXPECT_STREQ(last_string, "cal");
+    EXPECT_EQ(last_args[3].type, CLI_RPC_ARG_BYTES);
+    EXPECT_EQ(last_args[3].length, 3);
+
+    uint8_t response[VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE];
+
+    EXPECT_EQ(read_frame(response), 6);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_RESPONSE);
+    EXPECT_EQ(response[1], 0x42);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_OK);
+    EXPECT_EQ(response[3], 0xde);
+    EXPECT_EQ(response[4], 0xad);
+    EXPECT_EQ(response[5], 0xbe);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] same frame delivered one byte at a time
+     * -------------------------------------------------------------------------
+     **/
+
+    last_argc = 0;
+
+    frame[4] = 0x43;
+    length = build_frame(frame, &frame[3], sizeof(payload));
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        rpc->receive_task(&frame[i], 1);
+    }
+
+    EXPECT_EQ(last_argc, 4);
+    EXPECT_EQ(read_frame(response), 6);
+    EXPECT_EQ(response[1], 0x43);
+    EXPECT_EQ(rpc->get_rx_errors(), 0u);
+}
+
+TEST_F(TestCliRpc, errorTest)
+{
+    uint8_t frame[32];
+    uint8_t response[VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE];
+    uint16_t length;
+
+    // unknown command id
+
+    const uint8_t unknown[] = {CLI_RPC_FRAME_REQUEST, 0x01, 0x02, 0x00};
+
+    length = build_frame(frame, unknown, sizeof(unknown));
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(read_frame(response), 3);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_UNKNOWN_COMMAND);
+
+    // truncated argument
+
+    const uint8_t truncated[] = {CLI_RPC_FRAME_REQUEST, 0x02, 0x01, 0x00, CLI_RPC_ARG_UINT, 0x04, 0x00, 0x01};
+
+    length = build_frame(frame, truncated, sizeof(truncated));
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(read_frame(response), 3);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_INVALID_ARGS);
+
+    // handler failure, text output goes out as a log frame before the response
+
+    const uint8_t failing[] = {CLI_RPC_FRAME_REQUEST, 0x03, 0x10, 0x00};
+
+    length = build_frame(frame, failing, sizeof(failing));
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(read_frame(response), 9);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_LOG);
+    EXPECT_EQ(response[1], 0x03);
+    EXPECT_EQ(memcmp(&response[2], "failing", 7), 0);
+
+    EXPECT_EQ(read_frame(response), 3);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_RESPONSE);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_FAILED);
+
+    // corrupted frame is dropped without a response
+
+    length = build_frame(frame, failing, sizeof(failing));
+    frame[4] ^= 0xff;
+
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(rpc->get_rx_errors(), 1u);
+    EXPECT_EQ(read_frame(response), -1);
+
+    // receiver resynchronizes on the next frame
+
+    length = build_frame(frame, unknown, sizeof(unknown));
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(read_frame(response), 3);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_UNKNOWN_COMMAND);
+}
+
+TEST_F(TestCliRpc, textTest)
+{
+    rpc->get_interpreter().add_commands(text_commands, ARRAY_LENGTH(text_commands));
+
+    const uint8_t text[] = {CLI_RPC_FRAME_TEXT, 0x07, 'h', 'e', 'l', 'l', 'o', ' ', 'x'};
+
+    uint8_t frame[32];
+    uint8_t response[VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE];
+    uint16_t length = build_frame(frame, text, sizeof(text));
+
+    rpc->receive_task(frame, length);
+
+    EXPECT_EQ(read_frame(response), 2 + 11);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_LOG);
+    EXPECT_EQ(response[1], 0x07);
+    EXPECT_EQ(memcmp(&response[2], "hello x 1\r\n", 11), 0);
+
+    EXPECT_EQ(read_frame(response), 2 + 6);
+    EXPECT_EQ(memcmp(&response[2], "Done\r\n", 6), 0);
+
+    EXPECT_EQ(read_frame(response), 3);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_RESPONSE);
+    EXPECT_EQ(response[2], CLI_RPC_STATUS_OK);
+}
+
+TEST_F(TestCliRpc, asyncOutputSeqTest)
+{
+    rpc->get_interpreter().add_commands(text_commands, ARRAY_LENGTH(text_commands));
+
+    uint8_t text[] = {CLI_RPC_FRAME_TEXT, 0x21, 'h', 'e', 'l', 'l', 'o'};
+
+    uint8_t frame[32];
+    uint8_t response[VCRTOS_CONFIG_CLI_RPC_MAX_PAYLOAD_SIZE];
+    uint16_t length = build_frame(frame, text, sizeof(text));
+
+    rpc->receive_task(frame, length);
+
+    while (read_frame(response) > 0);
+
+    // a job dispatched for request 0x21 still runs when request 0x22 comes in
+
+    AsyncChannel channel;
+
+    channel.open(*rpc, 5);
+
+    text[1] = 0x22;
+    length = build_frame(frame, text, sizeof(text));
+    rpc->receive_task(frame, length);
+
+    while (read_frame(response) > 0);
+
+    channel.output("late\r\n", 6);
+
+    EXPECT_EQ(read_frame(response), 2 + 10);
+    EXPECT_EQ(response[0], CLI_RPC_FRAME_LOG);
+    EXPECT_EQ(response[1], 0x21);
+    EXPECT_EQ(memcmp(&response[2], "[5] late\r\n", 10), 0);
+
+    channel.close();
+}
@@ -0,0 +1,26 @@
+set(unittest-includes ${unittest-includes}
+)
+
+set(unittest-sources
+    ../../source/core/thread.cpp
+    ../../source/core/mutex.cpp
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
+    ../../source/core/assert_failure.c
+    ../../source/core/api/thread_api.cpp
+    ../../source/utils/isrpipe.cpp
+    ../../source/utils/vcstdio.cpp
+    ../../source/cli/cli.cpp
+    ../../source/cli/cli_async.cpp
+    ../../source/cli/cli_rpc.cpp
+    stubs/cpu_stub.c
+    stubs/thread_arch_stub.c
+    stubs/vcstdio_arch_stub.c
+)
+
+set(unittest-test-sources
+    source/cli/cli_rpc/test_cli_rpc.cpp
+)
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DVCRTOS_PROJECT_CONFIG_FILE='\"vcrtos-unittest-config.h\"'")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DVCRTOS_PROJECT_CONFIG_FILE='\"vcrtos-unittest-config.h\"'")
@@ -4,7 +4,12 @@ set(unittest-includes ${unittest-includes}
 set(unittest-sources
     ../../source/utils/heap.cpp
     ../../source/core/api/heap_api.cpp
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
     ../../source/core/assert_failure.c
+    ../../source/core/thread.cpp
+    stubs/cpu_stub.c
+    stubs/thread_arch_stub.c
 )
 
 set(unittest-test-sources
@@ -906,3 +906,313 @@ TEST_F(TestMsgApi, multipleMsgApiTest)
     EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
     EXPECT_EQ(thread1->get_status(), THREAD_STATUS_SLEEPING);
 }
+
+TEST_F(TestMsgApi, replyAndReceiveMsgApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg server_msgqueue[4];
+    Msg client_msgqueue[4];
+
+    char idle_stack[128];
+    char server_stack[128];
+    char client_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *server = Thread::init(server_stack, sizeof(server_stack), nullptr, "server", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *client = Thread::init(client_stack, sizeof(client_stack), nullptr, "client", KERNEL_THREAD_PRIORITY_MAIN);
+
+    server->init_msg_queue(server_msgqueue, ARRAY_LENGTH(server_msgqueue));
+    client->init_msg_queue(client_msgqueue, ARRAY_LENGTH(client_msgqueue));
+
+    scheduler->run();
+
+    msg_t request;
+
+    msg_init(&request);
+
+    EXPECT_EQ(msg_receive(&request), 1);
+
+    scheduler->run();
+
+    msg_t call;
+    msg_t answer;
+
+    msg_init(&call);
+    call.type = 0x41;
+
+    EXPECT_EQ(msg_send_receive(&call, &answer, server->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(request.type, 0x41);
+
+    msg_t response;
+
+    msg_init(&response);
+    response.type = 0x42;
+
+    EXPECT_EQ(msg_reply_and_receive(&request, &response), 1);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(msg_reply_and_receive(&request, &response), -1);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(answer.type, 0x42);
+}
+
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+TEST_F(TestMsgApi, priorityInheritanceMsgApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg server_msgqueue[4];
+    Msg client_msgqueue[4];
+
+    char idle_stack[128];
+    char server_stack[128];
+    char medium_stack[128];
+    char client_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *server = Thread::init(server_stack, sizeof(server_stack), nullptr, "server", KERNEL_THREAD_PRIORITY_MAIN + 1);
+    Thread *medium = Thread::init(medium_stack, sizeof(medium_stack), nullptr, "medium", KERNEL_THREAD_PRIORITY_MAIN,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+    Thread *client = Thread::init(client_stack, sizeof(client_stack), nullptr, "client", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    server->init_msg_queue(server_msgqueue, ARRAY_LENGTH(server_msgqueue));
+    client->init_msg_queue(client_msgqueue, ARRAY_LENGTH(client_msgqueue));
+
+    scheduler->run();
+
+    msg_t request;
+
+    msg_init(&request);
+
+    EXPECT_EQ(msg_receive(&request), 1);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    EXPECT_EQ(scheduler->wakeup_thread(medium->get_pid()), 1);
+    EXPECT_EQ(scheduler->wakeup_thread(client->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+
+    msg_t call;
+    msg_t answer;
+
+    msg_init(&call);
+    call.type = 0x51;
+
+    /* the waiting server is handed the core at the priority of the client */
+    EXPECT_EQ(msg_send_receive(&call, &answer, server->get_pid()), 1);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(medium->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(request.type, 0x51);
+
+    msg_t response;
+
+    msg_init(&response);
+    response.type = 0x52;
+
+    EXPECT_EQ(msg_reply_and_receive(&request, &response), 1);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(answer.type, 0x52);
+}
+#endif
+
+TEST_F(TestMsgApi, batchMsgApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg receiver_msgqueue[8];
+
+    char idle_stack[128];
+    char receiver_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *receiver = Thread::init(receiver_stack, sizeof(receiver_stack), nullptr, "receiver", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->run();
+
+    msg_t burst[4];
+    msg_t buffer[4];
+
+    EXPECT_EQ(msg_receive_batch(buffer, ARRAY_LENGTH(buffer), 0), -1);
+
+    receiver->init_msg_queue(receiver_msgqueue, ARRAY_LENGTH(receiver_msgqueue));
+
+    for (unsigned i = 0; i < ARRAY_LENGTH(burst); i++)
+    {
+        msg_init(&burst[i]);
+        burst[i].content.value = i;
+    }
+
+    EXPECT_EQ(msg_send_batch(burst, ARRAY_LENGTH(burst), receiver->get_pid()), 4);
+    EXPECT_EQ(msg_receive_batch(buffer, 3, 0), 3);
+    EXPECT_EQ(buffer[2].content.value, 2u);
+    EXPECT_EQ(buffer[2].sender_pid, receiver->get_pid());
+    EXPECT_EQ(msg_receive_batch(buffer, ARRAY_LENGTH(buffer), 1), 1);
+    EXPECT_EQ(buffer[0].content.value, 3u);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RUNNING);
+}
+
+TEST_F(TestMsgApi, receiveTypeMsgApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg receiver_msgqueue[4];
+
+    char idle_stack[128];
+    char receiver_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *receiver = Thread::init(receiver_stack, sizeof(receiver_stack), nullptr, "receiver", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->run();
+
+    msg_t burst[3];
+    msg_t msg;
+
+    msg_init(&msg);
+    msg.type = 0x02;
+
+    EXPECT_EQ(msg_receive_type(&msg, 0xffff, 0), -1);
+
+    receiver->init_msg_queue(receiver_msgqueue, ARRAY_LENGTH(receiver_msgqueue));
+
+    for (unsigned i = 0; i < ARRAY_LENGTH(burst); i++)
+    {
+        msg_init(&burst[i]);
+        burst[i].type = (uint16_t)(i + 1);
+        burst[i].content.value = i;
+    }
+
+    EXPECT_EQ(msg_send_batch(burst, ARRAY_LENGTH(burst), receiver->get_pid()), 3);
+
+    EXPECT_EQ(msg_receive_type(&msg, 0xffff, 0), 1);
+    EXPECT_EQ(msg.content.value, 1u);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 2);
+
+    msg.type = 0x04;
+
+    EXPECT_EQ(msg_receive_type(&msg, 0xffff, 0), 0);
+    EXPECT_EQ(msg_receive_type(&msg, 0x00, MSG_TIMEOUT_FOREVER), 1);
+    EXPECT_EQ(msg.type, 0x01);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RUNNING);
+
+    test_helper_set_cpu_timestamp(0);
+    msg.type = 0x04;
+
+    EXPECT_EQ(msg_receive_type(&msg, 0xffff, 10), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 1);
+
+    test_helper_set_cpu_timestamp(10);
+    thread_scheduler_msg_timeout_expired();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->wait_data, nullptr);
+}
+
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+TEST_F(TestMsgApi, msgBufApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg main_msgqueue[4];
+    Msg worker_msgqueue[4];
+
+    char idle_stack[128];
+    char main_stack[128];
+    char worker_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread = Thread::init(main_stack, sizeof(main_stack), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+
+    Thread *worker = Thread::init(worker_stack, sizeof(worker_stack), nullptr, "worker", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    main_thread->init_msg_queue(main_msgqueue, ARRAY_LENGTH(main_msgqueue));
+    worker->init_msg_queue(worker_msgqueue, ARRAY_LENGTH(worker_msgqueue));
+
+    scheduler->run();
+
+    unsigned numof_free = msgbuf_get_numof_free();
+
+    test_helper_set_cpu_in_isr(1);
+    void *buf = msgbuf_alloc(32);
+    test_helper_set_cpu_in_isr(0);
+
+    ASSERT_NE(buf, nullptr);
+    EXPECT_EQ(msgbuf_get_owner(buf), KERNEL_PID_UNDEF);
+    EXPECT_EQ(msgbuf_get_numof_free(), numof_free - 1);
+
+    msg_t msg;
+
+    msg_init(&msg);
+
+    EXPECT_EQ(msgbuf_send(&msg, buf, main_thread->get_pid()), 1);
+    EXPECT_EQ(msgbuf_get_owner(buf), main_thread->get_pid());
+
+    msg_t received;
+
+    EXPECT_EQ(msg_receive(&received), 1);
+    EXPECT_EQ(received.content.ptr, buf);
+
+    msgbuf_retain(buf);
+    msgbuf_release(buf);
+    msgbuf_release(buf);
+
+    EXPECT_EQ(msgbuf_get_numof_free(), numof_free);
+    EXPECT_EQ(msgbuf_get_leaks(), 0u);
+
+    /* the owner gave its reference back before it exits, the one the sender
+     * kept is not dropped for it */
+    buf = msgbuf_alloc(32);
+
+    ASSERT_NE(buf, nullptr);
+
+    msgbuf_retain(buf);
+
+    EXPECT_EQ(msgbuf_send(&msg, buf, worker->get_pid()), 1);
+
+    EXPECT_EQ(scheduler->wakeup_thread(worker->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(worker->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(msg_receive(&received), 1);
+
+    msgbuf_release(received.content.ptr);
+
+    EXPECT_EQ(msgbuf_get_owner(buf), KERNEL_PID_UNDEF);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->terminate(worker->get_pid());
+
+    EXPECT_EQ(msgbuf_get_numof_free(), numof_free - 1);
+    EXPECT_EQ(msgbuf_get_leaks(), 0u);
+
+    msgbuf_release(buf);
+
+    EXPECT_EQ(msgbuf_get_numof_free(), numof_free);
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/thread.h>
+#include <vcrtos/msg.h>
+#include <vcrtos/msg_bus.h>
+
+#include "core/code_utils.h"
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+
+class TestMsgBusApi : public testing::Test
+{
+    protected:
+
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestMsgBusApi, msgBusApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg subscriber_msgqueue[4];
+
+    char idle_stack[128];
+    char subscriber_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *subscriber = Thread::init(subscriber_stack, sizeof(subscriber_stack), nullptr, "subscriber",
+                                      KERNEL_THREAD_PRIORITY_MAIN);
+
+    subscriber->init_msg_queue(subscriber_msgqueue, ARRAY_LENGTH(subscriber_msgqueue));
+
+    scheduler->run();
+
+    msg_bus_t bus;
+    msg_bus_entry_t entry;
+
+    msg_bus_init(&bus, MSG_BUS_ID_MAX);
+    msg_bus_attach(&bus, &entry);
+
+    EXPECT_EQ(entry.pid, subscriber->get_pid());
+    EXPECT_EQ(msg_bus_post(&bus, 31, nullptr), 0);
+
+    msg_bus_subscribe(&entry, 31);
+
+    msg_t received;
+
+    msg_init(&received);
+
+    EXPECT_EQ(msg_receive(&received), 1);
+    EXPECT_EQ(subscriber->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    scheduler->run();
+
+    /* from an isr the switch is left to the end of the isr */
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(msg_bus_post(&bus, 31, &entry), 1);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(scheduler->requested_context_switch(), 1);
+    EXPECT_EQ(subscriber->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(received.sender_pid, KERNEL_PID_ISR);
+    EXPECT_TRUE(msg_is_from_bus(&bus, &received));
+    EXPECT_EQ(msg_bus_get_type(&received), 31);
+    EXPECT_EQ(received.content.ptr, &entry);
+
+    scheduler->run();
+
+    msg_bus_unsubscribe(&entry, 31);
+
+    EXPECT_EQ(msg_bus_post(&bus, 31, nullptr), 0);
+
+    msg_bus_subscribe(&entry, 31);
+    msg_bus_detach(&bus, &entry);
+
+    EXPECT_EQ(msg_bus_post(&bus, 31, nullptr), 0);
+    EXPECT_EQ(entry.drops, 0u);
+}
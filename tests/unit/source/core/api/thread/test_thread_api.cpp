@@ -15,6 +15,8 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <string.h>
+
 #include "gtest/gtest.h"
 
 #include <vcrtos/thread.h>
@@ -536,3 +538,42 @@ TEST_F(TestThreadApi, multipleThreadApiTest)
     EXPECT_EQ(thread1->status, THREAD_STATUS_PENDING);
     EXPECT_EQ(thread2->status, THREAD_STATUS_RUNNING);
 }
+
+TEST_F(TestThreadApi, stackMonitorApiTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    EXPECT_NE(scheduler, nullptr);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the sampler thread measures every thread, including itself
+     * -------------------------------------------------------------------------
+     **/
+
+    alignas(8) char stack1[512];
+    alignas(8) char stack2[512];
+
+    kernel_pid_t main_pid = thread_create(stack1, sizeof(stack1), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN,
+                                          nullptr, THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_STACKMARKER);
+    kernel_pid_t monitor_pid = thread_stack_monitor_start(stack2, sizeof(stack2), KERNEL_THREAD_PRIORITY_IDLE);
+
+    EXPECT_NE(main_pid, KERNEL_PID_UNDEF);
+    EXPECT_NE(monitor_pid, KERNEL_PID_UNDEF);
+
+    thread_t *main_thread = thread_get_from_scheduler(main_pid);
+    int usable = reinterpret_cast<char *>(main_thread) - main_thread->stack_start;
+
+    EXPECT_EQ(thread_measure_stack_free(main_thread->stack_start), static_cast<uintptr_t>(usable));
+    EXPECT_EQ(thread_get_stack_peak(main_pid), 0);
+
+    memset(main_thread->stack_start + usable - 64, 0, 64);
+
+    EXPECT_EQ(thread_measure_stack_free(main_thread->stack_start), static_cast<uintptr_t>(usable - 64));
+    EXPECT_EQ(thread_measure_stack_free_bounded(main_thread->stack_start, usable), static_cast<uintptr_t>(usable - 64));
+
+    thread_stack_monitor_sample();
+
+    EXPECT_EQ(thread_get_stack_peak(main_pid), 64);
+    EXPECT_EQ(thread_get_stack_peak(monitor_pid), 0);
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/cpu.h>
+#include <vcrtos/irq_profile.h>
+
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+
+class TestIrqProfile : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        irq_profile_reset();
+        test_helper_set_cpu_timestamp(0);
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestIrqProfile, sectionTest)
+{
+    irq_profile_site_t sites[4];
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 4), 0);
+
+    test_helper_set_cpu_timestamp(100);
+
+    unsigned outer_line = __LINE__ + 1;
+    unsigned state = cpu_irq_disable();
+
+    test_helper_set_cpu_timestamp(150);
+
+    // nested section is part of the outer one
+
+    unsigned nested_state = cpu_irq_disable();
+    cpu_irq_restore(nested_state);
+
+    test_helper_set_cpu_timestamp(400);
+
+    cpu_irq_restore(state);
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 4), 1);
+    EXPECT_STREQ(sites[0].file, __FILE__);
+    EXPECT_EQ(sites[0].line, outer_line);
+    EXPECT_EQ(sites[0].count, 1u);
+    EXPECT_EQ(sites[0].max_ticks, 300u);
+    EXPECT_EQ(sites[0].total_ticks, 300u);
+
+    // 300 ticks fall in [256, 512)
+
+    EXPECT_EQ(sites[0].histogram[8], 1u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] same site again, max and total are kept
+     * -------------------------------------------------------------------------
+     **/
+
+    for (int i = 0; i < 2; i++)
+    {
+        test_helper_set_cpu_timestamp(1000);
+        unsigned loop_state = cpu_irq_disable();
+        test_helper_set_cpu_timestamp(1000 + (i + 1) * 10);
+        cpu_irq_restore(loop_state);
+    }
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 4), 2);
+
+    // sorted by worst case
+
+    EXPECT_EQ(sites[0].max_ticks, 300u);
+    EXPECT_EQ(sites[1].count, 2u);
+    EXPECT_EQ(sites[1].max_ticks, 20u);
+    EXPECT_EQ(sites[1].total_ticks, 30u);
+
+    // only the worst one fits
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 1), 1);
+    EXPECT_EQ(sites[0].max_ticks, 300u);
+
+    irq_profile_reset();
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 4), 0);
+}
+
+TEST_F(TestIrqProfile, kernelSiteTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+
+    Thread *thread1 = Thread::init(stack1, sizeof(stack1), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_NE(thread1, nullptr);
+
+    scheduler->run();
+
+    irq_profile_reset();
+
+    Mutex mutex(MUTEX_INIT_UNLOCKED);
+
+    mutex.lock();
+    mutex.unlock();
+
+    irq_profile_site_t sites[4];
+
+    EXPECT_EQ(irq_profile_get_worst(sites, 4), 2);
+
+    EXPECT_NE(strstr(sites[0].file, "mutex.cpp"), nullptr);
+    EXPECT_NE(strstr(sites[1].file, "mutex.cpp"), nullptr);
+    EXPECT_NE(sites[0].line, sites[1].line);
+    EXPECT_EQ(irq_profile_get_overflow(), 0u);
+}
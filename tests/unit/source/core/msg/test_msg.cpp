@@ -871,3 +871,791 @@ TEST_F(TestMsg, multipleMsgTest)
     EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
     EXPECT_EQ(thread1->get_status(), THREAD_STATUS_SLEEPING);
 }
+
+TEST_F(TestMsg, handoffMsgTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg server_msgqueue[4];
+    Msg client_msgqueue[4];
+
+    char idle_stack[128];
+    char server_stack[128];
+    char client_stack[128];
+    char urgent_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *server = Thread::init(server_stack, sizeof(server_stack), nullptr, "server", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *client = Thread::init(client_stack, sizeof(client_stack), nullptr, "client", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *urgent = Thread::init(urgent_stack, sizeof(urgent_stack), nullptr, "urgent", KERNEL_THREAD_PRIORITY_MAIN - 2,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    server->init_msg_queue(server_msgqueue, ARRAY_LENGTH(server_msgqueue));
+    client->init_msg_queue(client_msgqueue, ARRAY_LENGTH(client_msgqueue));
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg request;
+
+    EXPECT_EQ(request.receive(), 1);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a call to a waiting server goes straight into its buffer
+     * and the server runs next
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg call;
+    Msg answer;
+
+    call.type = 0x31;
+    call.content.value = 0x1234;
+
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(call.send_receive(&answer, server->get_pid()), 1);
+
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 1);
+    EXPECT_EQ(server->numof_msg_in_queue(), 0);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_REPLY_BLOCKED);
+    EXPECT_EQ(request.type, 0x31);
+    EXPECT_EQ(request.content.value, 0x1234u);
+    EXPECT_EQ(request.sender_pid, client->get_pid());
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] reply and receive blocks the server and hands the core back
+     * to the client in one switch
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg response;
+
+    response.type = 0x32;
+    response.content.value = 0x5678;
+
+    EXPECT_EQ(request.reply_and_receive(&response), 1);
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(answer.type, 0x32);
+    EXPECT_EQ(answer.content.value, 0x5678u);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+
+    /* not waiting for a reply anymore */
+    EXPECT_EQ(request.reply_and_receive(&response), -1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a thread woken before the switch takes precedence over
+     * the handoff
+     * -------------------------------------------------------------------------
+     **/
+
+    call.type = 0x33;
+
+    EXPECT_EQ(call.send_receive(&answer, server->get_pid()), 1);
+    EXPECT_EQ(scheduler->wakeup_thread(urgent->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(urgent->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_PENDING);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(request.type, 0x33);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] with a request queued already reply and receive returns it
+     * right away
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg queued;
+
+    queued.type = 0x34;
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(queued.send(server->get_pid()), 1);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(server->numof_msg_in_queue(), 1);
+    EXPECT_EQ(request.reply_and_receive(&response), 1);
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(request.type, 0x34);
+    EXPECT_EQ(request.sender_pid, KERNEL_PID_ISR);
+    EXPECT_EQ(server->numof_msg_in_queue(), 0);
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_PENDING);
+}
+
+#if VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE
+TEST_F(TestMsg, priorityInheritanceMsgTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg server_msgqueue[1];
+    Msg client_msgqueue[4];
+    Msg sender_msgqueue[1];
+
+    char idle_stack[128];
+    char server_stack[128];
+    char medium_stack[128];
+    char client_stack[128];
+    char sender_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *server = Thread::init(server_stack, sizeof(server_stack), nullptr, "server", KERNEL_THREAD_PRIORITY_MAIN + 1);
+    Thread *medium = Thread::init(medium_stack, sizeof(medium_stack), nullptr, "medium", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *client = Thread::init(client_stack, sizeof(client_stack), nullptr, "client", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *sender = Thread::init(sender_stack, sizeof(sender_stack), nullptr, "sender", KERNEL_THREAD_PRIORITY_MAIN - 2,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    server->init_msg_queue(server_msgqueue, ARRAY_LENGTH(server_msgqueue));
+    client->init_msg_queue(client_msgqueue, ARRAY_LENGTH(client_msgqueue));
+    sender->init_msg_queue(sender_msgqueue, ARRAY_LENGTH(sender_msgqueue));
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a call queued at a low priority server lifts it above the
+     * medium thread until the reply
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg call;
+    Msg answer;
+
+    call.type = 0x41;
+
+    EXPECT_EQ(call.send_receive(&answer, server->get_pid()), 1);
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_REPLY_BLOCKED);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(medium->get_status(), THREAD_STATUS_PENDING);
+
+    Msg request;
+
+    EXPECT_EQ(request.receive(), 1);
+    EXPECT_EQ(request.type, 0x41);
+
+    /* received, but the client still waits for the reply */
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a sender blocked on the full queue lends its priority until
+     * its message is taken
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg event;
+
+    event.type = 0x42;
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(event.send(server->get_pid()), 1);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(scheduler->wakeup_thread(sender->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg notify;
+
+    notify.type = 0x43;
+
+    EXPECT_EQ(notify.send(server->get_pid()), 1);
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_SEND_BLOCKED);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 2);
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg received;
+
+    EXPECT_EQ(received.receive(), 1);
+    EXPECT_EQ(received.type, 0x42);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 2);
+
+    EXPECT_EQ(received.receive(), 1);
+    EXPECT_EQ(received.type, 0x43);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_PENDING);
+
+    /* back to what the waiting client lends */
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] with two clients waiting for replies the server runs at the
+     * highest one, and falls to the next one after the first reply
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg second_call;
+    Msg second_answer;
+
+    second_call.type = 0x45;
+
+    EXPECT_EQ(second_call.send_receive(&second_answer, server->get_pid()), 1);
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_REPLY_BLOCKED);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 2);
+
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg second_request;
+
+    EXPECT_EQ(second_request.receive(), 1);
+    EXPECT_EQ(second_request.type, 0x45);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 2);
+
+    Msg second_response;
+
+    second_response.type = 0x46;
+
+    EXPECT_EQ(second_request.reply(&second_response), 1);
+
+    EXPECT_EQ(second_answer.type, 0x46);
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the reply drops the server back to its own priority
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg response;
+
+    response.type = 0x44;
+
+    EXPECT_EQ(request.reply(&response), 1);
+
+    EXPECT_EQ(server->get_priority(), KERNEL_THREAD_PRIORITY_MAIN + 1);
+    EXPECT_EQ(answer.type, 0x44);
+
+    scheduler->run();
+
+    EXPECT_EQ(client->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(medium->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(server->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_PENDING);
+}
+#endif
+
+TEST_F(TestMsg, batchMsgTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg receiver_msgqueue[4];
+
+    char idle_stack[128];
+    char receiver_stack[128];
+    char sender_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *receiver = Thread::init(receiver_stack, sizeof(receiver_stack), nullptr, "receiver", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *sender = Thread::init(sender_stack, sizeof(sender_stack), nullptr, "sender", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    receiver->init_msg_queue(receiver_msgqueue, ARRAY_LENGTH(receiver_msgqueue));
+
+    scheduler->run();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg burst[6];
+    Msg buffer[8];
+
+    for (unsigned i = 0; i < ARRAY_LENGTH(burst); i++)
+        burst[i].type = 0x60 + i;
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] nothing to take without blocking, no queue at the target
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(Msg::receive_batch(buffer, ARRAY_LENGTH(buffer), 0), 0);
+    EXPECT_EQ(Msg::send_batch(burst, 2, sender->get_pid()), -1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] messages queued from an isr come out in one call, in order
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(Msg::send_batch(burst, 3, receiver->get_pid()), 3);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 3);
+    EXPECT_EQ(Msg::receive_batch(buffer, ARRAY_LENGTH(buffer), 0), 3);
+
+    for (unsigned i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(buffer[i].type, 0x60 + i);
+        EXPECT_EQ(buffer[i].sender_pid, KERNEL_PID_ISR);
+    }
+
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 0);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a blocked receiver gets the first message, the rest is
+     * queued as far as it fits and it is woken once
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(Msg::receive_batch(buffer, ARRAY_LENGTH(buffer), 1), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    EXPECT_EQ(scheduler->wakeup_thread(sender->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(Msg::send_batch(burst, ARRAY_LENGTH(burst), receiver->get_pid()), 5);
+
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 0);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 4);
+    EXPECT_EQ(buffer[0].type, 0x60);
+    EXPECT_EQ(buffer[0].sender_pid, sender->get_pid());
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a sender blocked on the full queue moves into the space the
+     * batch freed and is woken
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(burst[5].send(receiver->get_pid()), 1);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_SEND_BLOCKED);
+
+    scheduler->run();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(Msg::receive_batch(buffer, 2, 0), 2);
+    EXPECT_EQ(buffer[0].type, 0x61);
+    EXPECT_EQ(buffer[1].type, 0x62);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 3);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(Msg::receive_batch(buffer, ARRAY_LENGTH(buffer), 0), 3);
+    EXPECT_EQ(buffer[0].type, 0x63);
+    EXPECT_EQ(buffer[1].type, 0x64);
+    EXPECT_EQ(buffer[2].type, 0x65);
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_PENDING);
+}
+
+#if VCRTOS_CONFIG_MSGBUF_ENABLE
+TEST_F(TestMsg, msgBufTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+    MsgBufPool &pool = scheduler->get_msgbuf_pool();
+
+    Msg consumer_msgqueue[4];
+
+    char idle_stack[128];
+    char producer_stack[128];
+    char consumer_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *producer = Thread::init(producer_stack, sizeof(producer_stack), nullptr, "producer", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *consumer = Thread::init(consumer_stack, sizeof(consumer_stack), nullptr, "consumer", KERNEL_THREAD_PRIORITY_MAIN);
+
+    consumer->init_msg_queue(consumer_msgqueue, ARRAY_LENGTH(consumer_msgqueue));
+
+    scheduler->run();
+
+    EXPECT_EQ(producer->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the receiver gets the very buffer the sender filled and
+     * owns it from the send on
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(pool.alloc(VCRTOS_CONFIG_MSGBUF_SIZE + 1, producer->get_pid()), nullptr);
+
+    char *frame = static_cast<char *>(pool.alloc(VCRTOS_CONFIG_MSGBUF_SIZE, producer->get_pid()));
+
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(pool.get_owner(frame), producer->get_pid());
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF - 1);
+
+    frame[0] = 0x5a;
+    frame[VCRTOS_CONFIG_MSGBUF_SIZE - 1] = 0x5b;
+
+    Msg msg;
+
+    EXPECT_EQ(msg.send_buf(frame, consumer->get_pid()), 1);
+    EXPECT_EQ(pool.get_owner(frame), consumer->get_pid());
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(consumer->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg received;
+
+    EXPECT_EQ(received.receive(), 1);
+    EXPECT_EQ(received.content.ptr, frame);
+    EXPECT_EQ(static_cast<char *>(received.content.ptr)[0], 0x5a);
+    EXPECT_EQ(static_cast<char *>(received.content.ptr)[VCRTOS_CONFIG_MSGBUF_SIZE - 1], 0x5b);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the buffer goes back with the last reference
+     * -------------------------------------------------------------------------
+     **/
+
+    pool.retain(frame);
+    pool.release(frame, consumer->get_pid());
+
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF - 1);
+    EXPECT_EQ(pool.get_owner(frame), KERNEL_PID_UNDEF);
+
+    pool.release(frame, consumer->get_pid());
+
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a buffer that is not delivered stays with the sender
+     * -------------------------------------------------------------------------
+     **/
+
+    void *buf = pool.alloc(16, consumer->get_pid());
+
+    EXPECT_EQ(msg.send_buf(buf, idle_thread->get_pid()), -1);
+    EXPECT_EQ(pool.get_owner(buf), consumer->get_pid());
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] buffers of a thread that is gone are dropped and counted as
+     * leaks, the pool runs dry without them
+     * -------------------------------------------------------------------------
+     **/
+
+    for (unsigned i = 1; i < VCRTOS_CONFIG_MSGBUF_NUMOF; i++)
+        EXPECT_NE(pool.alloc(16, consumer->get_pid()), nullptr);
+
+    EXPECT_EQ(pool.get_numof_free(), 0u);
+    EXPECT_EQ(pool.alloc(16, consumer->get_pid()), nullptr);
+
+    pool.retain(buf);
+
+    EXPECT_EQ(scheduler->wakeup_thread(producer->get_pid()), 1);
+
+    scheduler->run();
+    scheduler->terminate(consumer->get_pid());
+
+    EXPECT_EQ(pool.get_leaks(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF);
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF - 1);
+    EXPECT_EQ(pool.get_owner(buf), KERNEL_PID_UNDEF);
+
+    pool.release(buf, producer->get_pid());
+
+    EXPECT_EQ(pool.get_numof_free(), (unsigned)VCRTOS_CONFIG_MSGBUF_NUMOF);
+}
+#endif
+
+TEST_F(TestMsg, receiveTypeMsgTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg receiver_msgqueue[4];
+
+    char idle_stack[128];
+    char receiver_stack[128];
+    char sender_stack[128];
+
+    Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *receiver = Thread::init(receiver_stack, sizeof(receiver_stack), nullptr, "receiver", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *sender = Thread::init(sender_stack, sizeof(sender_stack), nullptr, "sender", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    receiver->init_msg_queue(receiver_msgqueue, ARRAY_LENGTH(receiver_msgqueue));
+
+    scheduler->run();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg burst[3];
+
+    burst[0].type = 0x11;
+    burst[1].type = 0x22;
+    burst[2].type = 0x13;
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(Msg::send_batch(burst, ARRAY_LENGTH(burst), receiver->get_pid()), 3);
+    test_helper_set_cpu_in_isr(0);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a matching message is taken from the middle of the queue,
+     * the others keep their order
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg msg;
+
+    msg.type = 0x20;
+
+    EXPECT_EQ(msg.receive_type(0xf0, 0), 1);
+    EXPECT_EQ(msg.type, 0x22);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 2);
+
+    msg.type = 0x99;
+
+    EXPECT_EQ(msg.receive_type(0xffff, 0), 0);
+    EXPECT_EQ(msg.type, 0x99);
+
+    EXPECT_EQ(msg.receive(), 1);
+    EXPECT_EQ(msg.type, 0x11);
+    EXPECT_EQ(msg.receive(), 1);
+    EXPECT_EQ(msg.type, 0x13);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] while waiting, other types are queued and the one waited
+     * for is handed over
+     * -------------------------------------------------------------------------
+     **/
+
+    Msg other;
+    Msg wanted;
+
+    other.type = 0x04;
+    wanted.type = 0x05;
+    msg.type = 0x05;
+
+    EXPECT_EQ(msg.receive_type(0xffff, MSG_TIMEOUT_FOREVER), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(other.send(receiver->get_pid()), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 1);
+    EXPECT_EQ(wanted.send(receiver->get_pid()), 1);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(msg.type, 0x05);
+    EXPECT_EQ(msg.sender_pid, KERNEL_PID_ISR);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] blocked senders are searched as well, one of them moves
+     * into the queue space a match frees
+     * -------------------------------------------------------------------------
+     **/
+
+    burst[0].type = 0x07;
+    burst[1].type = 0x07;
+    burst[2].type = 0x07;
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(Msg::send_batch(burst, ARRAY_LENGTH(burst), receiver->get_pid()), 3);
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 4);
+    EXPECT_EQ(scheduler->wakeup_thread(sender->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg blocked;
+
+    blocked.type = 0x08;
+
+    EXPECT_EQ(blocked.send(receiver->get_pid()), 1);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_SEND_BLOCKED);
+
+    scheduler->run();
+
+    msg.type = 0x08;
+
+    EXPECT_EQ(msg.receive_type(0xffff, 0), 1);
+    EXPECT_EQ(msg.sender_pid, sender->get_pid());
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 4);
+
+    scheduler->run();
+
+    blocked.type = 0x09;
+
+    EXPECT_EQ(blocked.send(receiver->get_pid()), 1);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_SEND_BLOCKED);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    msg.type = 0x07;
+
+    EXPECT_EQ(msg.receive_type(0xffff, 0), 1);
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->numof_msg_in_queue(), 4);
+
+    uint16_t expected[] = { 0x04, 0x07, 0x07, 0x09 };
+
+    for (unsigned i = 0; i < ARRAY_LENGTH(expected); i++)
+    {
+        EXPECT_EQ(msg.receive(), 1);
+        EXPECT_EQ(msg.type, expected[i]);
+    }
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a timed wait ends at its deadline without a message
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(1000);
+
+    msg.type = 0x30;
+    msg.content.value = 0xabcd;
+
+    EXPECT_EQ(msg.receive_type(0xffff, 100), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(test_helper_get_msg_timer(), 100u);
+
+    test_helper_set_cpu_timestamp(1060);
+    scheduler->msg_timeout_expired();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(test_helper_get_msg_timer(), 40u);
+
+    scheduler->set_context_switch_request(0);
+    test_helper_set_cpu_timestamp(1100);
+    scheduler->msg_timeout_expired();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(receiver->wait_data, nullptr);
+    EXPECT_EQ(scheduler->requested_context_switch(), 1);
+    EXPECT_EQ(test_helper_get_msg_timer(), 0u);
+    EXPECT_EQ(msg.content.value, 0xabcdu);
+
+    scheduler->run();
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a timeout left over from an answered wait does not end a
+     * later plain receive
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(sender->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    wanted.type = 0x30;
+
+    EXPECT_EQ(msg.receive_type(0xffff, 100), 1);
+    EXPECT_EQ(test_helper_get_msg_timer(), 100u);
+
+    test_helper_set_cpu_in_isr(1);
+    EXPECT_EQ(wanted.send(receiver->get_pid()), 1);
+    test_helper_set_cpu_in_isr(0);
+
+    /* answered, nothing is left for the timer */
+    EXPECT_EQ(test_helper_get_msg_timer(), 0u);
+    EXPECT_EQ(msg.type, 0x30);
+    EXPECT_EQ(sched_active_pid, receiver->get_pid());
+    EXPECT_EQ(msg.receive(), 1);
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    test_helper_set_cpu_timestamp(1300);
+    scheduler->msg_timeout_expired();
+
+    EXPECT_EQ(receiver->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+    EXPECT_EQ(test_helper_get_msg_timer(), 0u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the timer runs for the earliest deadline and moves on to
+     * the next one when that wait is over
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->msg_timeout_start(receiver, 100);
+    scheduler->msg_timeout_start(sender, 30);
+
+    EXPECT_EQ(test_helper_get_msg_timer(), 30u);
+
+    test_helper_set_cpu_timestamp(1310);
+    scheduler->msg_timeout_stop(sender);
+
+    EXPECT_EQ(test_helper_get_msg_timer(), 90u);
+
+    scheduler->msg_timeout_stop(receiver);
+
+    EXPECT_EQ(test_helper_get_msg_timer(), 0u);
+}
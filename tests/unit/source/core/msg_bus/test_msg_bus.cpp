@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "gtest/gtest.h"
+
+#include "core/code_utils.h"
+#include "core/thread.hpp"
+#include "core/msg.hpp"
+#include "core/msg_bus.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+
+class TestMsgBus : public testing::Test
+{
+    protected:
+
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestMsgBus, postMsgBusTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    Msg a_msgqueue[2];
+    Msg b_msgqueue[2];
+
+    char idle_stack[128];
+    char a_stack[128];
+    char b_stack[128];
+    char poster_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *a = Thread::init(a_stack, sizeof(a_stack), nullptr, "a", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *b = Thread::init(b_stack, sizeof(b_stack), nullptr, "b", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *poster = Thread::init(poster_stack, sizeof(poster_stack), nullptr, "poster", KERNEL_THREAD_PRIORITY_MAIN - 2,
+                                  nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    a->init_msg_queue(a_msgqueue, ARRAY_LENGTH(a_msgqueue));
+    b->init_msg_queue(b_msgqueue, ARRAY_LENGTH(b_msgqueue));
+
+    MsgBus bus(3);
+    MsgBusEntry a_entry;
+    MsgBusEntry b_entry;
+    MsgBusEntry idle_entry;
+
+    bus.attach(&a_entry, a->get_pid());
+    bus.attach(&b_entry, b->get_pid());
+    bus.attach(&idle_entry, idle_thread->get_pid());
+
+    a_entry.subscribe(1);
+    a_entry.subscribe(2);
+    b_entry.subscribe(1);
+    idle_entry.subscribe(1);
+
+    scheduler->run();
+
+    EXPECT_EQ(a->get_status(), THREAD_STATUS_RUNNING);
+
+    Msg received;
+
+    EXPECT_EQ(received.receive(), 1);
+    EXPECT_EQ(a->get_status(), THREAD_STATUS_RECEIVE_BLOCKED);
+
+    EXPECT_EQ(scheduler->wakeup_thread(poster->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(poster->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] one post reaches every subscriber of the type, a waiting
+     * one directly, a thread without a queue counts a drop
+     * -------------------------------------------------------------------------
+     **/
+
+    int value = 0x77;
+
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(bus.post(1, &value), 2);
+
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 0);
+    EXPECT_EQ(a->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(received.type, (3 << 5) | 1);
+    EXPECT_EQ(received.content.ptr, &value);
+    EXPECT_EQ(received.sender_pid, poster->get_pid());
+    EXPECT_TRUE(msg_is_from_bus(&bus, &received));
+    EXPECT_EQ(msg_bus_get_type(&received), 1);
+    EXPECT_EQ(b->numof_msg_in_queue(), 1);
+    EXPECT_EQ(idle_entry.drops, 1u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] only the subscribers of the type get it, full queues count
+     * drops per subscriber
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(bus.post(2, nullptr), 1);
+    EXPECT_EQ(a->numof_msg_in_queue(), 1);
+    EXPECT_EQ(b->numof_msg_in_queue(), 1);
+
+    EXPECT_EQ(bus.post(1, nullptr), 2);
+    EXPECT_EQ(bus.post(1, nullptr), 0);
+
+    EXPECT_EQ(a_entry.drops, 1u);
+    EXPECT_EQ(b_entry.drops, 1u);
+    EXPECT_EQ(idle_entry.drops, 3u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] unsubscribed and detached threads are left out
+     * -------------------------------------------------------------------------
+     **/
+
+    idle_entry.unsubscribe(1);
+    bus.detach(&b_entry);
+
+    EXPECT_EQ(bus.post(1, nullptr), 0);
+
+    EXPECT_EQ(a_entry.drops, 2u);
+    EXPECT_EQ(b_entry.drops, 1u);
+    EXPECT_EQ(idle_entry.drops, 3u);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(a->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(received.receive(), 1);
+    EXPECT_EQ(msg_bus_get_type(&received), 2);
+}
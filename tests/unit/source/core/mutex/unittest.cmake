@@ -6,6 +6,8 @@ set(unittest-sources
     ../../source/core/mutex.cpp
     ../../source/core/rmutex.c
     ../../source/core/sema.c
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
     ../../source/core/assert_failure.c
     stubs/cpu_stub.c
     stubs/thread_arch_stub.c
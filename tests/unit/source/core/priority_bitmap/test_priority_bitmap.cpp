@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "gtest/gtest.h"
+
+#include "core/priority_bitmap.hpp"
+
+using namespace vc;
+
+class TestPriorityBitmap : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestPriorityBitmap, lsbTest)
+{
+    for (unsigned bit = 0; bit < 32; bit++)
+    {
+        EXPECT_EQ(bitmap_lsb(1u << bit), bit);
+        EXPECT_EQ(bitmap_lsb(0x80000000u | (1u << bit)), bit);
+    }
+}
+
+TEST_F(TestPriorityBitmap, singleWordTest)
+{
+    PriorityBitmap<32> bitmap;
+
+    EXPECT_EQ(sizeof(bitmap), sizeof(uint32_t));
+    EXPECT_TRUE(bitmap.empty());
+    EXPECT_EQ(bitmap.next(0), 32u);
+
+    bitmap.set(31);
+    bitmap.set(7);
+
+    EXPECT_FALSE(bitmap.empty());
+    EXPECT_TRUE(bitmap.test(7));
+    EXPECT_FALSE(bitmap.test(8));
+    EXPECT_EQ(bitmap.lowest(), 7u);
+    EXPECT_EQ(bitmap.next(0), 7u);
+    EXPECT_EQ(bitmap.next(7), 7u);
+    EXPECT_EQ(bitmap.next(8), 31u);
+    EXPECT_EQ(bitmap.next(32), 32u);
+
+    bitmap.clear(7);
+
+    EXPECT_EQ(bitmap.lowest(), 31u);
+
+    bitmap.clear(31);
+
+    EXPECT_TRUE(bitmap.empty());
+}
+
+TEST_F(TestPriorityBitmap, twoLevelTest)
+{
+    PriorityBitmap<256> bitmap;
+
+    EXPECT_TRUE(bitmap.empty());
+    EXPECT_EQ(bitmap.next(0), 256u);
+
+    /* every level on its own */
+    for (unsigned level = 0; level < 256; level++)
+    {
+        bitmap.set(level);
+
+        EXPECT_EQ(bitmap.lowest(), level);
+        EXPECT_EQ(bitmap.next(0), level);
+        EXPECT_EQ(bitmap.next(level + 1), 256u);
+
+        bitmap.clear(level);
+
+        EXPECT_TRUE(bitmap.empty());
+    }
+
+    /* levels spread over several words */
+    bitmap.set(255);
+    bitmap.set(100);
+    bitmap.set(33);
+    bitmap.set(32);
+
+    EXPECT_EQ(bitmap.lowest(), 32u);
+    EXPECT_EQ(bitmap.next(33), 33u);
+    EXPECT_EQ(bitmap.next(34), 100u);
+    EXPECT_EQ(bitmap.next(101), 255u);
+    EXPECT_EQ(bitmap.next(256), 256u);
+
+    /* the summary bit stays while a word has other levels */
+    bitmap.clear(32);
+
+    EXPECT_EQ(bitmap.lowest(), 33u);
+
+    bitmap.clear(33);
+
+    EXPECT_EQ(bitmap.lowest(), 100u);
+
+    bitmap.clear(100);
+    bitmap.clear(255);
+
+    EXPECT_TRUE(bitmap.empty());
+}
+
+TEST_F(TestPriorityBitmap, unevenLevelsTest)
+{
+    PriorityBitmap<40> bitmap;
+
+    bitmap.set(39);
+
+    EXPECT_EQ(bitmap.lowest(), 39u);
+    EXPECT_EQ(bitmap.next(0), 39u);
+    EXPECT_EQ(bitmap.next(40), 40u);
+
+    bitmap.reset();
+
+    EXPECT_TRUE(bitmap.empty());
+}
@@ -15,6 +15,10 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <string.h>
+
+#include <thread>
+
 #include "gtest/gtest.h"
 
 #include "core/thread.hpp"
@@ -1286,3 +1290,1076 @@ TEST_F(TestThread, threadEventTest)
 
     EXPECT_EQ(sizeof(struct process), sizeof(thread_t));
 }
+
+TEST_F(TestThread, threadSnapshotTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    test_helper_set_cpu_timestamp(0);
+
+    char stack1[128];
+    char stack2[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread = Thread::init(stack2, sizeof(stack2), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+
+    Msg msg_array[4];
+
+    main_thread->init_msg_queue(msg_array, 4);
+
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] runtime is charged to the thread switched away from
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(100);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    test_helper_set_cpu_timestamp(130);
+
+    EXPECT_EQ(scheduler->wakeup_thread(main_thread->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(scheduler->get_thread_runtime_ticks(main_thread->get_pid()), 100u);
+    EXPECT_EQ(scheduler->get_thread_runtime_ticks(idle_thread->get_pid()), 30u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] snapshot of every thread
+     * -------------------------------------------------------------------------
+     **/
+
+    thread_snapshot_t snapshot[KERNEL_MAXTHREADS];
+
+    EXPECT_EQ(scheduler->get_snapshot(snapshot, KERNEL_MAXTHREADS), 2);
+
+    EXPECT_EQ(snapshot[0].pid, idle_thread->get_pid());
+    EXPECT_STREQ(snapshot[0].name, "idle");
+    EXPECT_EQ(snapshot[0].status, THREAD_STATUS_PENDING);
+    EXPECT_EQ(snapshot[0].priority, KERNEL_THREAD_PRIORITY_IDLE);
+    EXPECT_EQ(snapshot[0].msg_queue_depth, -1);
+    EXPECT_EQ(snapshot[0].schedules, 1u);
+    EXPECT_EQ(snapshot[0].runtime_ticks, 30u);
+
+    EXPECT_EQ(snapshot[1].pid, main_thread->get_pid());
+    EXPECT_STREQ(snapshot[1].name, "main");
+    EXPECT_EQ(snapshot[1].status, THREAD_STATUS_RUNNING);
+    EXPECT_EQ(snapshot[1].msg_queue_depth, 0);
+    EXPECT_EQ(snapshot[1].schedules, 2u);
+    EXPECT_EQ(snapshot[1].runtime_ticks, 100u);
+    EXPECT_NE(snapshot[1].stack_start, nullptr);
+    EXPECT_GT(snapshot[1].stack_size, 0);
+    EXPECT_EQ(snapshot[1].stack_free, main_thread->get_stack_free());
+
+    // snapshot is limited by the given size
+
+    EXPECT_EQ(scheduler->get_snapshot(snapshot, 1), 1);
+    EXPECT_EQ(snapshot[0].pid, idle_thread->get_pid());
+}
+
+TEST_F(TestThread, terminatePendingThreadTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+    char stack3[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *thread1 = Thread::init(stack2, sizeof(stack2), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *thread2 = Thread::init(stack3, sizeof(stack3), nullptr, "thread2", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_PENDING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] terminating a pending thread leaves the running head of the
+     * same runqueue in place
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->terminate(thread2->get_pid());
+
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_STOPPED);
+    EXPECT_EQ(scheduler->get_thread_from_container(thread2->get_pid()), nullptr);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(sched_active_thread, thread1);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+}
+
+TEST_F(TestThread, timeSliceTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+    char stack3[128];
+    char stack4[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *thread1 = Thread::init(stack2, sizeof(stack2), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->set_time_slice(KERNEL_THREAD_PRIORITY_MAIN, 10);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] no timer for a thread alone at its priority
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_time_slice(), 0u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a peer becoming runnable arms the timer once
+     * -------------------------------------------------------------------------
+     **/
+
+    Thread *thread2 = Thread::init(stack3, sizeof(stack3), nullptr, "thread2", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_EQ(test_helper_get_time_slice(), 10u);
+
+    int starts = test_helper_get_time_slice_starts();
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_time_slice_starts(), starts);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] expiry rotates the runqueue from the isr
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->time_slice_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(scheduler->requested_context_switch(), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(test_helper_get_time_slice(), 10u);
+    EXPECT_EQ(test_helper_get_time_slice_starts(), starts + 1);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->time_slice_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_PENDING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a higher priority thread alone stops the timer, the lower
+     * priority peers get a fresh quantum when they are back
+     * -------------------------------------------------------------------------
+     **/
+
+    Thread *thread3 = Thread::init(stack4, sizeof(stack4), nullptr, "thread3", KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_time_slice(), 0u);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_time_slice(), 10u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the timer stops when the peer blocks
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->set_thread_status(thread2, THREAD_STATUS_SLEEPING);
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_time_slice(), 0u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] expiry without a peer does not request a switch
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->set_context_switch_request(0);
+    scheduler->time_slice_expired();
+
+    EXPECT_EQ(scheduler->requested_context_switch(), 0);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a quantum of 0 disables slicing for the level
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->set_time_slice(KERNEL_THREAD_PRIORITY_MAIN, 0);
+
+    EXPECT_EQ(scheduler->wakeup_thread(thread2->get_pid()), 1);
+    scheduler->run();
+
+    EXPECT_EQ(test_helper_get_time_slice(), 0u);
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_PENDING);
+}
+
+TEST_F(TestThread, edfTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+    char stack3[128];
+    char stack4[128];
+
+    test_helper_set_cpu_timestamp(1000);
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *thread1 = Thread::init(stack2, sizeof(stack2), nullptr, "thread1", VCRTOS_CONFIG_EDF_PRIORITY,
+                                   nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+    Thread *thread2 = Thread::init(stack3, sizeof(stack3), nullptr, "thread2", VCRTOS_CONFIG_EDF_PRIORITY,
+                                   nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+    Thread *thread3 = Thread::init(stack4, sizeof(stack4), nullptr, "thread3", VCRTOS_CONFIG_EDF_PRIORITY,
+                                   nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the earliest deadline runs first, whatever the wake order
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->set_deadline(thread1->get_pid(), 1500), 1);
+    EXPECT_EQ(scheduler->set_deadline(thread2->get_pid(), 1200), 1);
+    EXPECT_EQ(scheduler->set_deadline(thread3->get_pid(), 1800), 1);
+
+    EXPECT_EQ(scheduler->wakeup_thread(thread1->get_pid()), 1);
+    EXPECT_EQ(scheduler->wakeup_thread(thread2->get_pid()), 1);
+    EXPECT_EQ(scheduler->wakeup_thread(thread3->get_pid()), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_PENDING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a ready thread moved ahead of the running one preempts it
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(scheduler->set_deadline(thread1->get_pid(), 1100), 1);
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_PENDING);
+
+    /* a later deadline behind the running thread does not */
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(scheduler->set_deadline(thread3->get_pid(), 1700), 1);
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 0);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a job renewing in time is not counted as a miss, the next
+     * deadline is relative to the previous one
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(1050);
+
+    EXPECT_EQ(scheduler->renew_deadline(1000), 0);
+    EXPECT_EQ(thread1->deadline, 2100u);
+    EXPECT_EQ(scheduler->get_deadline_misses(thread1->get_pid()), 0u);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread2->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a job renewing after its deadline is counted as a miss
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(1300);
+
+    EXPECT_EQ(scheduler->renew_deadline(1000), 1);
+    EXPECT_EQ(thread2->deadline, 2200u);
+    EXPECT_EQ(scheduler->get_deadline_misses(thread2->get_pid()), 1u);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a blocked thread leaves the heap, the next deadline runs
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_SLEEPING);
+    EXPECT_EQ(thread3->deadline_slot, -1);
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] deadlines are compared across the timestamp wrap, a woken
+     * thread with an earlier deadline preempts
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->set_deadline(thread3->get_pid(), 0xffffff00), 1);
+
+    test_helper_reset_pendsv_trigger();
+
+    EXPECT_EQ(scheduler->wakeup_thread(thread3->get_pid()), 1);
+    EXPECT_EQ(test_helper_is_pendsv_interrupt_triggered(), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_PENDING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] unknown threads are rejected
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->set_deadline(KERNEL_PID_LAST, 0), -1);
+}
+
+TEST_F(TestThread, cpuBudgetTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+    char stack3[128];
+
+    test_helper_set_cpu_timestamp(0);
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *app_thread = Thread::init(stack2, sizeof(stack2), nullptr, "app", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *log_thread = Thread::init(stack3, sizeof(stack3), nullptr, "log", KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] invalid groups are rejected
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->budget_group_init(VCRTOS_CONFIG_CPU_BUDGET_NUMOF_GROUPS, 100, 1000,
+                                           KERNEL_THREAD_PRIORITY_MAIN + 1), -1);
+    EXPECT_EQ(scheduler->budget_group_init(0, 1000, 100, KERNEL_THREAD_PRIORITY_MAIN + 1), -1);
+    EXPECT_EQ(scheduler->budget_group_join(log_thread->get_pid(), 0), -1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the timer is armed with the budget of the running group
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->budget_group_init(0, 100, 1000, KERNEL_THREAD_PRIORITY_MAIN + 1), 1);
+    EXPECT_EQ(scheduler->budget_group_join(log_thread->get_pid(), 0), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 100u);
+
+    /* a switch to a thread outside of any group stops it */
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(app_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 0u);
+
+    EXPECT_EQ(scheduler->wakeup_thread(log_thread->get_pid()), 1);
+    scheduler->run();
+
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    /* only the time actually run is charged */
+    test_helper_set_cpu_timestamp(60);
+    scheduler->run();
+
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 40u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] an exhausted group drops to its background priority until
+     * the next period
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(100);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(scheduler->requested_context_switch(), 1);
+    EXPECT_EQ(log_thread->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN + 1);
+    EXPECT_EQ(scheduler->budget_group_get_throttles(0), 1u);
+
+    scheduler->run();
+
+    EXPECT_EQ(app_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_PENDING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 900u);
+
+    /* it still runs in the background, for free */
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    test_helper_set_cpu_timestamp(600);
+    EXPECT_EQ(scheduler->wakeup_thread(app_thread->get_pid()), 1);
+    scheduler->run();
+
+    EXPECT_EQ(app_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 400u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the replenished group gets its priority back
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(1000);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(log_thread->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(log_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_budget_timer(), 100u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] an overrun seen late costs one throttle, the periods in
+     * between do not add up to a larger budget
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(5050);
+    scheduler->run();
+
+    EXPECT_EQ(scheduler->budget_group_get_throttles(0), 2u);
+    EXPECT_EQ(log_thread->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+    EXPECT_EQ(test_helper_get_budget_timer(), 100u);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] leaving the group removes the limit
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->budget_group_join(log_thread->get_pid(), THREAD_BUDGET_GROUP_NONE), 1);
+    EXPECT_EQ(test_helper_get_budget_timer(), 0u);
+    EXPECT_EQ(log_thread->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    scheduler->sleep();
+    scheduler->run();
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+}
+
+TEST_F(TestThread, cpuBudgetMembersTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+    char stack3[128];
+    char stack4[128];
+
+    test_helper_set_cpu_timestamp(0);
+
+    Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *thread1 = Thread::init(stack2, sizeof(stack2), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN - 1);
+    Thread *thread2 = Thread::init(stack3, sizeof(stack3), nullptr, "thread2", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                   nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+    Thread *thread3 = Thread::init(stack4, sizeof(stack4), nullptr, "thread3", KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                   nullptr, THREAD_FLAGS_CREATE_SLEEPING);
+
+    EXPECT_EQ(scheduler->budget_group_init(0, 100, 1000, KERNEL_THREAD_PRIORITY_MAIN + 1), 1);
+    EXPECT_EQ(scheduler->budget_group_join(thread1->get_pid(), 0), 1);
+    EXPECT_EQ(scheduler->budget_group_join(thread2->get_pid(), 0), 1);
+    EXPECT_EQ(scheduler->budget_group_join(thread3->get_pid(), 0), 1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] only the threads still in the group are throttled
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->budget_group_join(thread3->get_pid(), THREAD_BUDGET_GROUP_NONE), 1);
+
+    scheduler->terminate(thread2->get_pid());
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    test_helper_set_cpu_timestamp(100);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN + 1);
+    EXPECT_EQ(thread3->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    /* a thread that joins a throttled group runs in its background */
+    EXPECT_EQ(scheduler->budget_group_join(thread3->get_pid(), 0), 1);
+    EXPECT_EQ(thread3->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    test_helper_set_cpu_timestamp(1000);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+    EXPECT_EQ(thread3->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] setting up or joining a group first hands out the budget of
+     * periods that ended before the timer got to them
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_set_cpu_timestamp(1100);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    test_helper_set_cpu_timestamp(2050);
+
+    EXPECT_EQ(scheduler->budget_group_init(1, 50, 500, KERNEL_THREAD_PRIORITY_MAIN + 1), 1);
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+    EXPECT_EQ(test_helper_get_budget_timer(), 100u);
+
+    test_helper_set_cpu_timestamp(2150);
+
+    test_helper_set_cpu_in_isr(1);
+    scheduler->budget_expired();
+    test_helper_set_cpu_in_isr(0);
+
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN + 1);
+
+    test_helper_set_cpu_timestamp(3100);
+
+    EXPECT_EQ(scheduler->budget_group_join(thread3->get_pid(), THREAD_BUDGET_GROUP_NONE), 1);
+    EXPECT_EQ(thread1->get_priority(), (unsigned)KERNEL_THREAD_PRIORITY_MAIN - 1);
+    EXPECT_EQ(test_helper_get_budget_timer(), 100u);
+}
+
+TEST_F(TestThread, pidAllocationTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    static char stacks[KERNEL_MAXTHREADS + 1][128];
+
+    Thread *thread1 = Thread::init(stacks[0], sizeof(stacks[0]), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *thread2 = Thread::init(stacks[1], sizeof(stacks[1]), nullptr, "thread2", KERNEL_THREAD_PRIORITY_MAIN);
+    Thread *thread3 = Thread::init(stacks[2], sizeof(stacks[2]), nullptr, "thread3", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_EQ(thread1->get_pid(), KERNEL_PID_FIRST);
+    EXPECT_EQ(thread2->get_pid(), KERNEL_PID_FIRST + 1);
+    EXPECT_EQ(thread3->get_pid(), KERNEL_PID_FIRST + 2);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a handle resolves while its thread lives
+     * -------------------------------------------------------------------------
+     **/
+
+    thread_handle_t handle = scheduler->get_handle(thread2->get_pid());
+
+    EXPECT_NE(handle, THREAD_HANDLE_INVALID);
+    EXPECT_EQ(scheduler->get_pid_from_handle(handle), thread2->get_pid());
+    EXPECT_EQ(scheduler->get_handle(KERNEL_PID_LAST), THREAD_HANDLE_INVALID);
+    EXPECT_EQ(scheduler->get_pid_from_handle(THREAD_HANDLE_INVALID), KERNEL_PID_UNDEF);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] an exited pid goes stale and is reused last
+     * -------------------------------------------------------------------------
+     **/
+
+    kernel_pid_t pid = thread2->get_pid();
+
+    scheduler->terminate(pid);
+
+    EXPECT_EQ(scheduler->get_pid_from_handle(handle), KERNEL_PID_UNDEF);
+
+    Thread *thread4 = Thread::init(stacks[3], sizeof(stacks[3]), nullptr, "thread4", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_EQ(thread4->get_pid(), KERNEL_PID_FIRST + 3);
+
+    Thread *last = nullptr;
+    int created = 4;
+
+    for (int i = 4; i <= KERNEL_MAXTHREADS; i++)
+    {
+        Thread *thread = Thread::init(stacks[i], sizeof(stacks[i]), nullptr, "filler", KERNEL_THREAD_PRIORITY_MAIN);
+
+        if (thread == nullptr)
+            break;
+
+        last = thread;
+        created++;
+    }
+
+    EXPECT_EQ(created, KERNEL_MAXTHREADS + 1);
+    EXPECT_EQ(scheduler->numof_threads(), KERNEL_MAXTHREADS);
+
+    /* the slot is back, under a new generation */
+    ASSERT_NE(last, nullptr);
+    EXPECT_EQ(last->get_pid(), pid);
+    EXPECT_EQ(scheduler->get_pid_from_handle(handle), KERNEL_PID_UNDEF);
+    EXPECT_NE(scheduler->get_handle(pid), handle);
+    EXPECT_EQ(scheduler->get_pid_from_handle(scheduler->get_handle(pid)), pid);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] creating fails once every pid is taken
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(Thread::init(stacks[KERNEL_MAXTHREADS], sizeof(stacks[KERNEL_MAXTHREADS]), nullptr, "extra",
+                           KERNEL_THREAD_PRIORITY_MAIN), nullptr);
+}
+
+static void *spawn_handler(void *arg)
+{
+    return arg;
+}
+
+TEST_F(TestThread, spawnTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *parent = Thread::init(stack2, sizeof(stack2), nullptr, "parent", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->run();
+
+    EXPECT_EQ(parent->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] spawned threads take their stacks from the class pool
+     * -------------------------------------------------------------------------
+     **/
+
+    kernel_pid_t pids[VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF];
+
+    for (int i = 0; i < VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF; i++)
+    {
+        pids[i] = scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_SMALL, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                   THREAD_FLAGS_CREATE_WOUT_YIELD);
+
+        ASSERT_NE(pids[i], KERNEL_PID_UNDEF);
+
+        Thread *thread = scheduler->get_thread_from_container(pids[i]);
+
+        EXPECT_EQ(thread->get_status(), THREAD_STATUS_PENDING);
+        EXPECT_EQ(thread->stack_size, VCRTOS_CONFIG_THREAD_SPAWN_SMALL_STACKSIZE);
+    }
+
+    EXPECT_EQ(scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_SMALL, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                               THREAD_FLAGS_CREATE_WOUT_YIELD), KERNEL_PID_UNDEF);
+    EXPECT_EQ(scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_NUMOF, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                               THREAD_FLAGS_CREATE_WOUT_YIELD), KERNEL_PID_UNDEF);
+
+    /* the other classes are separate */
+    kernel_pid_t large = scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_LARGE, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                          THREAD_FLAGS_CREATE_WOUT_YIELD | THREAD_FLAGS_CREATE_DETACHED);
+
+    EXPECT_NE(large, KERNEL_PID_UNDEF);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] an exited thread keeps its pid and stack until joined
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->run();
+
+    Thread *first = scheduler->get_thread_from_container(pids[0]);
+
+    EXPECT_EQ(first->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->exit();
+
+    EXPECT_EQ(scheduler->get_thread_from_container(pids[0]), nullptr);
+
+    scheduler->run();
+
+    EXPECT_EQ(scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_SMALL, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                               THREAD_FLAGS_CREATE_WOUT_YIELD), KERNEL_PID_UNDEF);
+
+    /* only spawned threads can be joined */
+    void *result = &result;
+
+    EXPECT_EQ(scheduler->join(parent->get_pid(), &result), -1);
+
+    /* join from the parent */
+    for (int i = 1; i < VCRTOS_CONFIG_THREAD_SPAWN_SMALL_NUMOF; i++)
+    {
+        scheduler->set_thread_status(scheduler->get_thread_from_container(pids[i]), THREAD_STATUS_SLEEPING);
+    }
+    scheduler->set_thread_status(scheduler->get_thread_from_container(large), THREAD_STATUS_SLEEPING);
+    scheduler->run();
+
+    EXPECT_EQ(parent->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(scheduler->join(pids[0], &result), 1);
+    EXPECT_EQ(result, nullptr);
+    EXPECT_EQ(scheduler->join(pids[0], &result), -1);
+
+    kernel_pid_t again = scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_SMALL, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                          THREAD_FLAGS_CREATE_SLEEPING);
+
+    EXPECT_NE(again, KERNEL_PID_UNDEF);
+    EXPECT_EQ(scheduler->get_thread_from_container(again)->get_status(), THREAD_STATUS_SLEEPING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a detached thread hands its stack back on exit
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->join(large, &result), -1);
+    EXPECT_EQ(scheduler->wakeup_thread(large), 1);
+
+    scheduler->run();
+
+    EXPECT_EQ(scheduler->get_thread_from_container(large)->get_status(), THREAD_STATUS_RUNNING);
+
+    scheduler->exit();
+    scheduler->run();
+
+    kernel_pid_t large2 = scheduler->spawn(spawn_handler, nullptr, THREAD_STACK_LARGE, KERNEL_THREAD_PRIORITY_MAIN - 1,
+                                           THREAD_FLAGS_CREATE_SLEEPING);
+
+    EXPECT_NE(large2, KERNEL_PID_UNDEF);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] detaching an exited thread releases it, a terminated
+     * thread can still be joined
+     * -------------------------------------------------------------------------
+     **/
+
+    scheduler->terminate(pids[1]);
+
+    EXPECT_EQ(scheduler->detach(pids[1]), 1);
+    EXPECT_EQ(scheduler->detach(pids[1]), -1);
+
+    scheduler->terminate(pids[2]);
+
+    EXPECT_EQ(scheduler->join(pids[2], nullptr), 1);
+    EXPECT_EQ(scheduler->detach(idle_thread->get_pid()), -1);
+}
+
+TEST_F(TestThread, stackMonitorTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    alignas(8) char stack1[512];
+    alignas(8) char stack2[512];
+    alignas(8) char stack3[512];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread = Thread::init(stack2, sizeof(stack2), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] a painted stack is free up to the thread control block
+     * -------------------------------------------------------------------------
+     **/
+
+    char *stack_end = reinterpret_cast<char *>(main_thread);
+    int usable = stack_end - main_thread->stack_start;
+
+    EXPECT_EQ(main_thread->get_stack_free(), usable);
+    EXPECT_EQ(scheduler->measure_stack_free(main_thread->stack_start), static_cast<uintptr_t>(usable));
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] used stack is found by bisection, a used word that still
+     * holds the pattern does not hide the words below it
+     * -------------------------------------------------------------------------
+     **/
+
+    memset(stack_end - 96, 0, 96);
+
+    EXPECT_EQ(main_thread->get_stack_free(), usable - 96);
+    EXPECT_EQ(scheduler->measure_stack_free(main_thread->stack_start), static_cast<uintptr_t>(usable - 96));
+
+    uintptr_t words[64];
+
+    StackMonitor::paint(reinterpret_cast<char *>(words), sizeof(words));
+    memset(&words[20], 0, sizeof(words) - 20 * sizeof(uintptr_t));
+    /* first word probed by the bisection */
+    words[32] = StackMonitor::paint_word;
+
+    EXPECT_EQ(StackMonitor::measure_free(reinterpret_cast<char *>(words), sizeof(words)), 20 * sizeof(uintptr_t));
+    EXPECT_EQ(StackMonitor::measure_free_linear(reinterpret_cast<char *>(words)), 20 * sizeof(uintptr_t));
+
+    /* a stack that is not owned by a thread needs its size */
+    EXPECT_EQ(scheduler->measure_stack_free(reinterpret_cast<char *>(words)), 0u);
+    EXPECT_EQ(scheduler->measure_stack_free(reinterpret_cast<char *>(words), sizeof(words)), 20 * sizeof(uintptr_t));
+
+    /* a frame that left a painted hole far wider than a few words above a
+     * deeper write, the bisection lands in the hole */
+    StackMonitor::paint(reinterpret_cast<char *>(words), sizeof(words));
+    memset(&words[41], 0, sizeof(words) - 41 * sizeof(uintptr_t));
+    words[10] = 0;
+
+    EXPECT_EQ(StackMonitor::measure_free(reinterpret_cast<char *>(words), sizeof(words)), 10 * sizeof(uintptr_t));
+    EXPECT_EQ(StackMonitor::measure_free_linear(reinterpret_cast<char *>(words)), 10 * sizeof(uintptr_t));
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the sampler keeps the peak usage of every thread
+     * -------------------------------------------------------------------------
+     **/
+
+    EXPECT_EQ(scheduler->get_stack_peak(main_thread->get_pid()), 0);
+
+    scheduler->stack_monitor_sample();
+
+    EXPECT_EQ(scheduler->get_stack_peak(main_thread->get_pid()), 96);
+    EXPECT_EQ(scheduler->get_stack_peak(idle_thread->get_pid()), 0);
+
+    StackMonitor::paint(main_thread->stack_start, usable);
+    memset(stack_end - 32, 0, 32);
+
+    scheduler->stack_monitor_sample();
+
+    EXPECT_EQ(scheduler->get_stack_peak(main_thread->get_pid()), 96);
+
+    memset(stack_end - 128, 0, 128);
+
+    scheduler->stack_monitor_sample();
+
+    EXPECT_EQ(scheduler->get_stack_peak(main_thread->get_pid()), 128);
+    EXPECT_EQ(scheduler->get_stack_peak(KERNEL_PID_LAST), -1);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] an overwritten canary is reported on the next switch
+     * -------------------------------------------------------------------------
+     **/
+
+    test_helper_reset_stack_overflow();
+
+    Thread *thread3 = Thread::init(stack3, sizeof(stack3), nullptr, "thread3", KERNEL_THREAD_PRIORITY_MAIN - 1);
+
+    /* the whole stack is used */
+    memset(main_thread->stack_start, 0, sizeof(uintptr_t));
+
+    EXPECT_EQ(main_thread->get_stack_free(), 0);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread3->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_stack_overflow(), main_thread);
+
+    test_helper_reset_stack_overflow();
+    StackMonitor::set_canary(main_thread->stack_start);
+    scheduler->sleep();
+    scheduler->run();
+
+    EXPECT_EQ(main_thread->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_stack_overflow(), nullptr);
+}
+
+TEST_F(TestThread, multiInstanceTest)
+{
+    kernel_instance_t *default_instance = kernel_instance_get_current();
+
+    EXPECT_NE(default_instance, nullptr);
+
+    kernel_instance_t *node1 = kernel_instance_create();
+    kernel_instance_t *node2 = kernel_instance_create();
+
+    EXPECT_NE(node1, nullptr);
+    EXPECT_NE(node2, nullptr);
+    EXPECT_NE(node1, node2);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] each instance has its own scheduler and active thread
+     * -------------------------------------------------------------------------
+     **/
+
+    kernel_instance_set_current(node1);
+
+    EXPECT_EQ(kernel_instance_get_current(), node1);
+    EXPECT_EQ(ThreadScheduler::is_initialized(), 0);
+
+    ThreadScheduler *scheduler1 = &ThreadScheduler::init();
+
+    EXPECT_EQ(ThreadScheduler::is_initialized(), 1);
+
+    char idle_stack1[128];
+    char main_stack1[128];
+
+    Thread *idle_thread1 = Thread::init(idle_stack1, sizeof(idle_stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread1 = Thread::init(main_stack1, sizeof(main_stack1), nullptr, "main");
+
+    scheduler1->run();
+
+    EXPECT_EQ(sched_active_thread, main_thread1);
+    EXPECT_EQ(sched_active_pid, main_thread1->get_pid());
+    EXPECT_EQ(node1->active_thread, main_thread1);
+
+    kernel_instance_set_current(node2);
+
+    EXPECT_EQ(ThreadScheduler::is_initialized(), 0);
+    EXPECT_EQ(sched_active_thread, nullptr);
+    EXPECT_EQ(sched_active_pid, KERNEL_PID_UNDEF);
+
+    ThreadScheduler *scheduler2 = &ThreadScheduler::init();
+
+    EXPECT_NE(scheduler1, scheduler2);
+
+    char idle_stack2[128];
+
+    Thread *idle_thread2 = Thread::init(idle_stack2, sizeof(idle_stack2), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+
+    scheduler2->run();
+
+    // same pid in both instances, different threads
+
+    EXPECT_EQ(idle_thread2->get_pid(), idle_thread1->get_pid());
+    EXPECT_EQ(sched_active_thread, idle_thread2);
+    EXPECT_EQ(scheduler2->numof_threads(), 1);
+
+    kernel_instance_set_current(node1);
+
+    EXPECT_EQ(&ThreadScheduler::get(), scheduler1);
+    EXPECT_EQ(scheduler1->numof_threads(), 2);
+    EXPECT_EQ(sched_active_thread, main_thread1);
+
+    scheduler1->sleep();
+    scheduler1->run();
+
+    EXPECT_EQ(sched_active_thread, idle_thread1);
+    EXPECT_EQ(node2->active_thread, idle_thread2);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] the current instance is per host thread
+     * -------------------------------------------------------------------------
+     **/
+
+    kernel_instance_t *worker_instance = nullptr;
+    ThreadScheduler *worker_scheduler = nullptr;
+    void *worker_active_thread = nullptr;
+
+    std::thread worker([&]() {
+        worker_instance = kernel_instance_get_current();
+
+        kernel_instance_set_current(node2);
+
+        worker_scheduler = &ThreadScheduler::get();
+        worker_active_thread = sched_active_thread;
+    });
+
+    worker.join();
+
+    // a new host thread starts on the default instance
+
+    EXPECT_EQ(worker_instance, default_instance);
+    EXPECT_EQ(worker_scheduler, scheduler2);
+    EXPECT_EQ(worker_active_thread, idle_thread2);
+
+    // selecting node2 in the worker did not change this host thread
+
+    EXPECT_EQ(kernel_instance_get_current(), node1);
+    EXPECT_EQ(sched_active_thread, idle_thread1);
+
+    kernel_instance_set_current(nullptr);
+
+    EXPECT_EQ(kernel_instance_get_current(), default_instance);
+
+    kernel_instance_destroy(node1);
+    kernel_instance_destroy(node2);
+}
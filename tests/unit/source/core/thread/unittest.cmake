@@ -4,6 +4,8 @@ set(unittest-includes ${unittest-includes}
 set(unittest-sources
     ../../source/core/thread.cpp
     ../../source/core/api/event_api.cpp
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
     ../../source/core/assert_failure.c
     stubs/cpu_stub.c
     stubs/thread_arch_stub.c
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/trace.h>
+
+#include "core/mutex.hpp"
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+
+class TestTrace : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        trace_start();
+        trace_clear();
+        test_helper_set_cpu_timestamp(0);
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestTrace, kernelEventsTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char stack1[128];
+    char stack2[128];
+
+    Thread *idle_thread = Thread::init(stack1, sizeof(stack1), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+    Thread *main_thread = Thread::init(stack2, sizeof(stack2), nullptr, "main", KERNEL_THREAD_PRIORITY_MAIN);
+
+    trace_clear();
+
+    test_helper_set_cpu_timestamp(10);
+
+    scheduler->run();
+
+    trace_event_t events[8];
+
+    EXPECT_EQ(trace_read(0, events, 8), 1u);
+    EXPECT_EQ(events[0].type, TRACE_EVENT_SWITCH);
+    EXPECT_EQ(events[0].timestamp, 10u);
+    EXPECT_EQ(events[0].pid, main_thread->get_pid());
+    EXPECT_EQ(events[0].arg, static_cast<uint32_t>(KERNEL_PID_UNDEF));
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] block on a mutex, switch to idle, wake up
+     * -------------------------------------------------------------------------
+     **/
+
+    trace_clear();
+
+    Mutex mutex;
+
+    test_helper_set_cpu_timestamp(20);
+
+    mutex.lock();
+
+    scheduler->run();
+
+    test_helper_set_cpu_timestamp(30);
+
+    mutex.unlock();
+
+    scheduler->run();
+
+    EXPECT_EQ(trace_read(0, events, 8), 5u);
+
+    EXPECT_EQ(events[0].type, TRACE_EVENT_MUTEX_CONTENDED);
+    EXPECT_EQ(events[0].pid, main_thread->get_pid());
+    EXPECT_EQ(events[0].arg, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&mutex)));
+
+    EXPECT_EQ(events[1].type, TRACE_EVENT_BLOCK);
+    EXPECT_EQ(events[1].arg, static_cast<uint32_t>(THREAD_STATUS_MUTEX_BLOCKED));
+
+    EXPECT_EQ(events[2].type, TRACE_EVENT_SWITCH);
+    EXPECT_EQ(events[2].pid, idle_thread->get_pid());
+    EXPECT_EQ(events[2].arg, static_cast<uint32_t>(main_thread->get_pid()));
+    EXPECT_EQ(events[2].timestamp, 20u);
+
+    EXPECT_EQ(events[3].type, TRACE_EVENT_WAKE);
+    EXPECT_EQ(events[3].pid, main_thread->get_pid());
+    EXPECT_EQ(events[3].timestamp, 30u);
+
+    EXPECT_EQ(events[4].type, TRACE_EVENT_SWITCH);
+    EXPECT_EQ(events[4].pid, main_thread->get_pid());
+
+    // isr hooks for the port
+
+    trace_clear();
+
+    trace_isr_enter(7);
+    trace_isr_exit();
+
+    EXPECT_EQ(trace_read(0, events, 8), 2u);
+    EXPECT_EQ(events[0].type, TRACE_EVENT_ISR_ENTER);
+    EXPECT_EQ(events[0].pid, main_thread->get_pid());
+    EXPECT_EQ(events[0].arg, 7u);
+    EXPECT_EQ(events[1].type, TRACE_EVENT_ISR_EXIT);
+}
+
+TEST_F(TestTrace, ringTest)
+{
+    trace_event_t events[VCRTOS_CONFIG_TRACE_BUFFER_SIZE];
+
+    EXPECT_EQ(trace_read(0, events, VCRTOS_CONFIG_TRACE_BUFFER_SIZE), 0u);
+    EXPECT_EQ(trace_get_dropped(), 0u);
+
+    for (uint32_t i = 0; i < VCRTOS_CONFIG_TRACE_BUFFER_SIZE + 10; i++)
+    {
+        trace_record(TRACE_EVENT_USER, 1, i);
+    }
+
+    // oldest events are overwritten
+
+    EXPECT_EQ(trace_get_dropped(), 10u);
+    EXPECT_EQ(trace_read(0, events, VCRTOS_CONFIG_TRACE_BUFFER_SIZE), static_cast<size_t>(VCRTOS_CONFIG_TRACE_BUFFER_SIZE));
+    EXPECT_EQ(events[0].arg, 10u);
+    EXPECT_EQ(events[VCRTOS_CONFIG_TRACE_BUFFER_SIZE - 1].arg, static_cast<uint32_t>(VCRTOS_CONFIG_TRACE_BUFFER_SIZE + 9));
+
+    // partial reads walk the retained events from the oldest one
+
+    EXPECT_EQ(trace_read(0, events, 2), 2u);
+    EXPECT_EQ(events[0].arg, 10u);
+    EXPECT_EQ(events[1].arg, 11u);
+
+    EXPECT_EQ(trace_read(VCRTOS_CONFIG_TRACE_BUFFER_SIZE - 1, events, 2), 1u);
+    EXPECT_EQ(events[0].arg, static_cast<uint32_t>(VCRTOS_CONFIG_TRACE_BUFFER_SIZE + 9));
+
+    EXPECT_EQ(trace_read(VCRTOS_CONFIG_TRACE_BUFFER_SIZE, events, 2), 0u);
+
+    // stopped tracer does not record
+
+    trace_clear();
+    trace_stop();
+
+    trace_record(TRACE_EVENT_USER, 1, 0);
+
+    EXPECT_EQ(trace_read(0, events, 1), 0u);
+
+    trace_start();
+
+    trace_record(TRACE_EVENT_USER, 1, 0);
+
+    EXPECT_EQ(trace_read(0, events, 1), 1u);
+}
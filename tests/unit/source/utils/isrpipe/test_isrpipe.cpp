@@ -139,6 +139,31 @@ TEST_F(TestUtilsTsrb, tsrbFunctionTest)
     EXPECT_EQ(result[3], (char)0xfd);
 }
 
+TEST_F(TestUtilsTsrb, tsrbWrapAroundTest)
+{
+    char data[6] = {0x1, 0x2, 0x3, 0x4, 0x5, 0x6};
+    char result[8];
+
+    EXPECT_EQ(tsrb->add(data, sizeof(data)), 6);
+    EXPECT_EQ(tsrb->get(result, 4), 4);
+
+    // write index wraps, data is copied in two segments
+
+    EXPECT_EQ(tsrb->add(data, sizeof(data)), 6);
+    EXPECT_TRUE(tsrb->is_full());
+    EXPECT_EQ(tsrb->add(data, sizeof(data)), 0);
+
+    EXPECT_EQ(tsrb->get(result, sizeof(result)), 8);
+
+    EXPECT_EQ(result[0], 0x5);
+    EXPECT_EQ(result[1], 0x6);
+    EXPECT_EQ(result[2], 0x1);
+    EXPECT_EQ(result[7], 0x6);
+
+    EXPECT_TRUE(tsrb->is_empty());
+    EXPECT_EQ(tsrb->get(result, sizeof(result)), 0);
+}
+
 TEST_F(TestUtilsUartIsrpipe, uartIsrpipeFunctionsTest)
 {
     ThreadScheduler *scheduler = &ThreadScheduler::init();
@@ -4,6 +4,8 @@ set(unittest-includes ${unittest-includes}
 set(unittest-sources
     ../../source/core/thread.cpp
     ../../source/core/mutex.cpp
+    ../../source/core/irq_profile.cpp
+    ../../source/core/trace.cpp
     ../../source/core/assert_failure.c
     ../../source/utils/isrpipe.cpp
     stubs/cpu_stub.c
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include <vcrtos/vcstdio.h>
+
+#include "core/thread.hpp"
+
+#include "test-helper.h"
+
+using namespace vc;
+
+class TestUtilsVcstdio : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        vcstdio_init();
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(TestUtilsVcstdio, readTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char idle_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+
+    EXPECT_NE(idle_thread, nullptr);
+
+    char stack1[128];
+
+    Thread *thread1 = Thread::init(stack1, sizeof(stack1), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_NE(thread1, nullptr);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    const char rx_data[] = "help\r\n";
+
+    EXPECT_EQ(vcstdio_isr_rx(rx_data, 6), 6);
+
+    char buf[16];
+
+    // all pending bytes are returned by a single read
+
+    EXPECT_EQ(vcstdio_read(buf, sizeof(buf)), 6);
+    EXPECT_EQ(memcmp(buf, rx_data, 6), 0);
+
+    EXPECT_EQ(vcstdio_read(buf, sizeof(buf)), 0);
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(vcstdio_read(buf, sizeof(buf)), 0);
+
+    // no data available, reader is blocked until the next rx interrupt
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_MUTEX_BLOCKED);
+
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(vcstdio_isr_rx("a", 1), 1);
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_PENDING);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(vcstdio_read(buf, 1), 1);
+    EXPECT_EQ(buf[0], 'a');
+}
+
+TEST_F(TestUtilsVcstdio, writeTest)
+{
+    ThreadScheduler *scheduler = &ThreadScheduler::init();
+
+    char idle_stack[128];
+
+    Thread *idle_thread = Thread::init(idle_stack, sizeof(idle_stack), nullptr, "idle", KERNEL_THREAD_PRIORITY_IDLE);
+
+    EXPECT_NE(idle_thread, nullptr);
+
+    char stack1[128];
+
+    Thread *thread1 = Thread::init(stack1, sizeof(stack1), nullptr, "thread1", KERNEL_THREAD_PRIORITY_MAIN);
+
+    EXPECT_NE(thread1, nullptr);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(test_helper_get_vcstdio_tx_start_count(), 0);
+
+    EXPECT_EQ(vcstdio_write("hello", 5), 5);
+
+    // one write call starts the transmitter only once
+
+    EXPECT_EQ(test_helper_get_vcstdio_tx_start_count(), 1);
+
+    char buf[VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE];
+
+    EXPECT_EQ(vcstdio_isr_tx(buf, sizeof(buf)), 5);
+    EXPECT_EQ(memcmp(buf, "hello", 5), 0);
+    EXPECT_EQ(vcstdio_isr_tx(buf, sizeof(buf)), 0);
+
+    /**
+     * -------------------------------------------------------------------------
+     * [TEST CASE] write more than the tx ring can hold
+     * -------------------------------------------------------------------------
+     **/
+
+    char data[VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE + 16];
+
+    for (unsigned i = 0; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<char>(i);
+    }
+
+    EXPECT_EQ(vcstdio_write(data, sizeof(data)), VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE);
+
+    // the previous tx interrupt already released the writer once, so it goes
+    // another round before it has to wait
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+    EXPECT_EQ(test_helper_get_vcstdio_tx_start_count(), 2);
+
+    EXPECT_EQ(vcstdio_write(data + VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE, 16), 0);
+
+    // tx ring is full, writer waits for the tx interrupt to drain it
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_MUTEX_BLOCKED);
+    EXPECT_EQ(test_helper_get_vcstdio_tx_start_count(), 3);
+
+    scheduler->run();
+
+    EXPECT_EQ(idle_thread->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(vcstdio_isr_tx(buf, 16), 16);
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_PENDING);
+
+    scheduler->run();
+
+    EXPECT_EQ(thread1->get_status(), THREAD_STATUS_RUNNING);
+
+    EXPECT_EQ(vcstdio_write(data + VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE, 16), 16);
+
+    EXPECT_EQ(vcstdio_isr_tx(buf, sizeof(buf)), VCRTOS_CONFIG_VCSTDIO_TX_BUFFER_SIZE);
+    EXPECT_EQ(memcmp(buf, data + 16, sizeof(buf)), 0);
+}
@@ -15,10 +15,28 @@
  * Authors: Darko Pancev <darko.pancev@vertexcom.com>
  */
 
+#include <stddef.h>
+
 #include "test-helper.h"
 
 static int is_cpu_in_isr = 0;
 static int is_pendsv_interrupt_triggered = 0;
+static uint32_t cpu_timestamp = 0;
+static uint32_t time_slice_ticks = 0;
+static int time_slice_starts = 0;
+static uint32_t budget_timer_ticks = 0;
+static uint32_t msg_timer_ticks = 0;
+static void *stack_overflow_thread = NULL;
+
+void test_helper_set_cpu_timestamp(uint32_t timestamp)
+{
+    cpu_timestamp = timestamp;
+}
+
+uint32_t cpu_get_timestamp(void)
+{
+    return cpu_timestamp;
+}
 
 void test_helper_set_cpu_in_isr(int val)
 {
@@ -65,6 +83,72 @@ void thread_arch_yield_higher(void)
     cpu_trigger_pendsv_interrupt();
 }
 
+void cpu_time_slice_start(uint32_t ticks)
+{
+    time_slice_ticks = ticks;
+    time_slice_starts++;
+}
+
+void cpu_time_slice_stop(void)
+{
+    time_slice_ticks = 0;
+}
+
+uint32_t test_helper_get_time_slice(void)
+{
+    return time_slice_ticks;
+}
+
+int test_helper_get_time_slice_starts(void)
+{
+    return time_slice_starts;
+}
+
+void cpu_budget_timer_start(uint32_t ticks)
+{
+    budget_timer_ticks = ticks;
+}
+
+void cpu_budget_timer_stop(void)
+{
+    budget_timer_ticks = 0;
+}
+
+uint32_t test_helper_get_budget_timer(void)
+{
+    return budget_timer_ticks;
+}
+
+void cpu_msg_timer_start(uint32_t ticks)
+{
+    msg_timer_ticks = ticks;
+}
+
+void cpu_msg_timer_stop(void)
+{
+    msg_timer_ticks = 0;
+}
+
+uint32_t test_helper_get_msg_timer(void)
+{
+    return msg_timer_ticks;
+}
+
+void cpu_stack_overflow(void *thread)
+{
+    stack_overflow_thread = thread;
+}
+
+void *test_helper_get_stack_overflow(void)
+{
+    return stack_overflow_thread;
+}
+
+void test_helper_reset_stack_overflow(void)
+{
+    stack_overflow_thread = NULL;
+}
+
 void cpu_switch_context_exit(void)
 {
 }
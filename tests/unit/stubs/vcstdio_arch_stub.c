@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2020, Vertexcom Technologies, Inc.
+ * All rights reserved.
+ *
+ * NOTICE: All information contained herein is, and remains
+ * the property of Vertexcom Technologies, Inc. and its suppliers,
+ * if any. The intellectual and technical concepts contained
+ * herein are proprietary to Vertexcom Technologies, Inc.
+ * and may be covered by U.S. and Foreign Patents, patents in process,
+ * and protected by trade secret or copyright law.
+ * Dissemination of this information or reproduction of this material
+ * is strictly forbidden unless prior written permission is obtained
+ * from Vertexcom Technologies, Inc.
+ *
+ * Authors: Darko Pancev <darko.pancev@vertexcom.com>
+ */
+
+#include "test-helper.h"
+
+#include <vcrtos/vcstdio.h>
+
+static int vcstdio_tx_start_count = 0;
+
+int test_helper_get_vcstdio_tx_start_count(void)
+{
+    return vcstdio_tx_start_count;
+}
+
+void vcstdio_arch_init(void)
+{
+    vcstdio_tx_start_count = 0;
+}
+
+void vcstdio_arch_tx_start(void)
+{
+    vcstdio_tx_start_count++;
+}
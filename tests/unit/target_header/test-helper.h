@@ -32,6 +32,26 @@ int test_helper_is_pendsv_interrupt_triggered(void);
 
 void test_helper_reset_pendsv_trigger(void);
 
+void test_helper_set_cpu_timestamp(uint32_t timestamp);
+
+/* ticks of the armed time slice timer, 0 when stopped */
+uint32_t test_helper_get_time_slice(void);
+
+int test_helper_get_time_slice_starts(void);
+
+/* ticks of the armed budget timer, 0 when stopped */
+uint32_t test_helper_get_budget_timer(void);
+
+/* ticks of the armed message timeout timer, 0 when stopped */
+uint32_t test_helper_get_msg_timer(void);
+
+/* thread passed to the last cpu_stack_overflow() call, NULL if none */
+void *test_helper_get_stack_overflow(void);
+
+void test_helper_reset_stack_overflow(void);
+
+int test_helper_get_vcstdio_tx_start_count(void);
+
 #ifdef __cplusplus
 }
 #endif
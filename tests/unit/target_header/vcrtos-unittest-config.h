@@ -18,7 +18,21 @@
 #ifndef VCRTOS_UNITTEST_CONFIG_H
 #define VCRTOS_UNITTEST_CONFIG_H
 
+#define VCRTOS_CONFIG_MULTI_INSTANCE_ENABLE 1
 #define VCRTOS_CONFIG_THREAD_FLAGS_ENABLE 1
 #define VCRTOS_CONFIG_THREAD_EVENT_ENABLE 1
+#define VCRTOS_CONFIG_CLI_ASYNC_ENABLE 1
+#define VCRTOS_CONFIG_THREAD_RUNTIME_STATS_ENABLE 1
+#define VCRTOS_CONFIG_TRACE_ENABLE 1
+#define VCRTOS_CONFIG_IRQ_PROFILE_ENABLE 1
+#define VCRTOS_CONFIG_TIME_SLICE_ENABLE 1
+#define VCRTOS_CONFIG_EDF_ENABLE 1
+#define VCRTOS_CONFIG_CPU_BUDGET_ENABLE 1
+#define VCRTOS_CONFIG_THREAD_SPAWN_ENABLE 1
+#define VCRTOS_CONFIG_STACK_CHECK_ENABLE 1
+#define VCRTOS_CONFIG_STACK_MONITOR_ENABLE 1
+#define VCRTOS_CONFIG_MSG_PRIORITY_INHERITANCE_ENABLE 1
+#define VCRTOS_CONFIG_MSGBUF_ENABLE 1
+#define VCRTOS_CONFIG_MSG_TIMEOUT_ENABLE 1
 
 #endif /* VCRTOS_UNITTEST_CONFIG_H */
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020, Vertexcom Technologies, Inc.
+# All rights reserved.
+#
+# NOTICE: All information contained herein is, and remains
+# the property of Vertexcom Technologies, Inc. and its suppliers,
+# if any. The intellectual and technical concepts contained
+# herein are proprietary to Vertexcom Technologies, Inc.
+# and may be covered by U.S. and Foreign Patents, patents in process,
+# and protected by trade secret or copyright law.
+# Dissemination of this information or reproduction of this material
+# is strictly forbidden unless prior written permission is obtained
+# from Vertexcom Technologies, Inc.
+#
+
+"""Convert a vcrtos trace dump into Chrome trace event JSON.
+
+The input is either a console capture of the cli `trace` command, which prints
+one hex encoded trace_event_t per line, or a raw binary dump of trace_event_t
+records (--binary). Thread names are taken from a `ps` listing in the same
+capture when there is one. Every core becomes its own process track. The
+output opens directly in ui.perfetto.dev or chrome://tracing.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+EVENT_FORMAT = '<IBBhI'
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+
+TRACE_EVENT_SWITCH = 1
+TRACE_EVENT_WAKE = 2
+TRACE_EVENT_BLOCK = 3
+TRACE_EVENT_MSG_SEND = 4
+TRACE_EVENT_MSG_RECV = 5
+TRACE_EVENT_MUTEX_CONTENDED = 6
+TRACE_EVENT_ISR_ENTER = 7
+TRACE_EVENT_ISR_EXIT = 8
+TRACE_EVENT_HEAP_ALLOC = 9
+TRACE_EVENT_HEAP_FREE = 10
+TRACE_EVENT_DEADLINE_MISS = 11
+TRACE_EVENT_STACK_OVERFLOW = 12
+TRACE_EVENT_USER = 0x80
+
+THREAD_STATUS = [
+    'stopped', 'sleeping', 'bl mutex', 'bl rx', 'bl send', 'bl reply',
+    'bl flag', 'bl flags', 'bl mbox', 'bl cond', 'bl join', 'running', 'pending',
+]
+
+INSTANT_NAMES = {
+    TRACE_EVENT_WAKE: 'wake',
+    TRACE_EVENT_BLOCK: 'block',
+    TRACE_EVENT_MSG_SEND: 'msg send',
+    TRACE_EVENT_MSG_RECV: 'msg recv',
+    TRACE_EVENT_MUTEX_CONTENDED: 'mutex contended',
+    TRACE_EVENT_HEAP_ALLOC: 'heap alloc',
+    TRACE_EVENT_HEAP_FREE: 'heap free',
+    TRACE_EVENT_DEADLINE_MISS: 'deadline miss',
+    TRACE_EVENT_STACK_OVERFLOW: 'stack overflow',
+}
+
+ISR_TID = -1
+
+
+def parse_capture(text):
+    records = []
+    names = {}
+    in_ps = False
+
+    for line in text.splitlines():
+        line = line.strip()
+
+        if line.startswith('>'):
+            line = line[1:].strip()
+
+        if re.fullmatch(r'[0-9a-fA-F]{%d}' % (EVENT_SIZE * 2), line):
+            records.append(bytes.fromhex(line))
+            in_ps = False
+            continue
+
+        if line.startswith('pid name'):
+            in_ps = True
+            continue
+
+        match = re.match(r'^(\d+)\s+(\S+)\s', line)
+        if in_ps and match:
+            names[int(match.group(1))] = match.group(2)
+        else:
+            in_ps = False
+
+    return records, names
+
+
+def parse_binary(data):
+    return [data[i:i + EVENT_SIZE] for i in range(0, len(data) - EVENT_SIZE + 1, EVENT_SIZE)]
+
+
+def unwrap(timestamps):
+    """Turn the free running 32-bit counter into a monotonic one."""
+    offset = 0
+    previous = None
+    for timestamp in timestamps:
+        if previous is not None and timestamp < previous:
+            offset += 1 << 32
+        previous = timestamp
+        yield timestamp + offset
+
+
+def convert(records, names, hz):
+    events = []
+    decoded = [struct.unpack(EVENT_FORMAT, record) for record in records]
+    scale = 1e6 / hz
+
+    def thread_name(pid):
+        return names.get(pid, 'pid %d' % pid)
+
+    # every core has its own ring and counter, each becomes one process track
+    cores = sorted({d[2] for d in decoded})
+
+    for core in cores:
+        core_events = [d for d in decoded if d[2] == core]
+        running = None
+
+        for (timestamp, kind, _, pid, arg), ticks in zip(core_events, unwrap(d[0] for d in core_events)):
+            ts = ticks * scale
+
+            if kind == TRACE_EVENT_SWITCH:
+                if running is not None:
+                    events.append({'ph': 'E', 'pid': core, 'tid': running, 'ts': ts})
+                events.append({'ph': 'B', 'pid': core, 'tid': pid, 'ts': ts, 'name': thread_name(pid)})
+                running = pid
+            elif kind == TRACE_EVENT_ISR_ENTER:
+                events.append({'ph': 'B', 'pid': core, 'tid': ISR_TID, 'ts': ts, 'name': 'irq %d' % arg})
+            elif kind == TRACE_EVENT_ISR_EXIT:
+                events.append({'ph': 'E', 'pid': core, 'tid': ISR_TID, 'ts': ts})
+            else:
+                if kind >= TRACE_EVENT_USER:
+                    name = 'user %d' % (kind - TRACE_EVENT_USER)
+                else:
+                    name = INSTANT_NAMES.get(kind, 'event %d' % kind)
+
+                args = {'arg': '0x%08x' % arg}
+                if kind in (TRACE_EVENT_WAKE, TRACE_EVENT_BLOCK) and arg < len(THREAD_STATUS):
+                    args = {'status': THREAD_STATUS[arg]}
+                elif kind in (TRACE_EVENT_MSG_SEND, TRACE_EVENT_MSG_RECV):
+                    args = {'peer': arg}
+
+                events.append({'ph': 'i', 's': 't', 'pid': core, 'tid': pid, 'ts': ts, 'name': name, 'args': args})
+
+    tracks = {(e['pid'], e['tid']) for e in events}
+    for core, tid in sorted(tracks):
+        name = 'isr' if tid == ISR_TID else thread_name(tid)
+        events.append({'ph': 'M', 'pid': core, 'tid': tid, 'name': 'thread_name', 'args': {'name': name}})
+
+    for core in cores:
+        events.append({'ph': 'M', 'pid': core, 'name': 'process_name', 'args': {'name': 'vcrtos cpu %d' % core}})
+
+    return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', help='console capture or binary dump, - for stdin')
+    parser.add_argument('-o', '--output', default='-', help='json output file, default stdout')
+    parser.add_argument('--binary', action='store_true', help='input is a raw trace_event_t array')
+    parser.add_argument('--hz', type=float, default=1e6, help='cpu_get_timestamp() frequency, default 1 MHz')
+    parser.add_argument('--name', action='append', default=[], metavar='PID=NAME', help='thread name override')
+    args = parser.parse_args()
+
+    if args.binary:
+        data = sys.stdin.buffer.read() if args.input == '-' else open(args.input, 'rb').read()
+        records, names = parse_binary(data), {}
+    else:
+        text = sys.stdin.read() if args.input == '-' else open(args.input, errors='replace').read()
+        records, names = parse_capture(text)
+
+    for override in args.name:
+        pid, _, name = override.partition('=')
+        names[int(pid)] = name
+
+    trace = convert(records, names, args.hz)
+
+    if args.output == '-':
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, 'w') as output:
+            json.dump(trace, output)
+
+
+if __name__ == '__main__':
+    main()